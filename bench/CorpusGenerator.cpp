@@ -0,0 +1,549 @@
+#include "CorpusGenerator.h"
+#include <algorithm>
+#include <fstream>
+#include <vector>
+#include <zlib.h>
+
+namespace {
+
+// DOS date of every entry: 2024-01-01 00:00
+constexpr uint16_t kDosDate = ((2024 - 1980) << 9) | (1 << 5) | 1;
+
+const char* const kWords[] = {
+    "inspector", "archive", "document", "quarterly", "report", "revenue", "table",
+    "paragraph", "style", "meta", "open", "format", "office", "value", "cell",
+    "zip", "entry", "content", "presentation", "slide", "image", "frame", "the",
+    "and", "of", "with", "for", "a", "in", "to", "&amp;", "&lt;draft&gt;"
+};
+constexpr size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+/**
+ * @brief SplitMix64; small, fast and identical on every platform
+ */
+class Random {
+public:
+    explicit Random(uint64_t seed)
+        : state_(seed) {
+    }
+
+    uint64_t next() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    size_t below(size_t bound) {
+        return static_cast<size_t>(next() % bound);
+    }
+
+private:
+    uint64_t state_;
+};
+
+void putLE(std::string& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+// Sizes and offsets at or above this go into a Zip64 extra field
+constexpr uint64_t kZip64Limit = 0xFFFFFFFF;
+constexpr size_t kZip64EntryLimit = 0xFFFF;
+
+/**
+ * @brief CRC-32 of a run of zero bytes, built from 1 MiB pieces
+ */
+uint32_t zeroCrc(uint64_t length) {
+    constexpr size_t kPiece = 1 << 20;
+    static const std::vector<Bytef> zeros(kPiece, 0);
+    uLong piece = ::crc32(0L, zeros.data(), static_cast<uInt>(kPiece));
+
+    uLong crc = 0;
+    for (; length >= kPiece; length -= kPiece) {
+        crc = crc32_combine(crc, piece, static_cast<z_off_t>(kPiece));
+    }
+    uLong tail = ::crc32(0L, zeros.data(), static_cast<uInt>(length));
+    return static_cast<uint32_t>(crc32_combine(crc, tail, static_cast<z_off_t>(length)));
+}
+
+/**
+ * @brief Minimal streaming ZIP writer (no data descriptors)
+ *
+ * Entries are written as they are added. Zip64 fields appear only where a
+ * size, offset or the entry count needs them, so small archives stay
+ * plain ZIP.
+ */
+class ZipBuilder {
+public:
+    explicit ZipBuilder(const std::string& path)
+        : path_(path),
+          file_(path, std::ios::binary | std::ios::trunc) {
+    }
+
+    bool add(const std::string& name, const std::string& data, CorpusGenerator::Method method,
+             std::string& error) {
+        std::string stored;
+        const std::string* payload = &data;
+        uint16_t methodId = 0;
+
+        if (method == CorpusGenerator::Method::Deflated) {
+            if (!deflateRaw(data, stored)) {
+                error = "deflate failed for " + name;
+                return false;
+            }
+            payload = &stored;
+            methodId = 8;
+        }
+
+        uint32_t crc = static_cast<uint32_t>(
+            ::crc32(0L, reinterpret_cast<const Bytef*>(data.data()), static_cast<uInt>(data.size())));
+
+        writeHeader(name, methodId, crc, payload->size(), data.size());
+        file_.write(payload->data(), static_cast<std::streamsize>(payload->size()));
+        offset_ += payload->size();
+        return check(error);
+    }
+
+    /**
+     * @brief Add a stored entry of zero bytes without writing them
+     *
+     * The data is skipped with a seek, which leaves a hole in the file on
+     * filesystems that support sparse files.
+     */
+    bool addZeros(const std::string& name, uint64_t size, std::string& error) {
+        writeHeader(name, 0, zeroCrc(size), size, size);
+        offset_ += size;
+        file_.seekp(static_cast<std::streamoff>(offset_));
+        return check(error);
+    }
+
+    bool finish(std::string& error) {
+        uint64_t dirOffset = offset_;
+        std::string directory;
+        for (const auto& record : records_) {
+            std::string extra;
+            if (record.size >= kZip64Limit) {
+                putLE(extra, record.size, 8);
+            }
+            if (record.compressedSize >= kZip64Limit) {
+                putLE(extra, record.compressedSize, 8);
+            }
+            if (record.offset >= kZip64Limit) {
+                putLE(extra, record.offset, 8);
+            }
+            if (!extra.empty()) {
+                extra = zip64Extra(extra);
+            }
+
+            uint16_t version = extra.empty() ? 20 : 45;
+            putLE(directory, 0x02014b50, 4);
+            putLE(directory, version, 2);   // Version made by
+            putLE(directory, version, 2);   // Version needed
+            putLE(directory, 0, 2);         // Flags
+            putLE(directory, record.method, 2);
+            putLE(directory, 0, 2);         // Time
+            putLE(directory, kDosDate, 2);
+            putLE(directory, record.crc, 4);
+            putLE(directory, std::min(record.compressedSize, kZip64Limit), 4);
+            putLE(directory, std::min(record.size, kZip64Limit), 4);
+            putLE(directory, record.name.size(), 2);
+            putLE(directory, extra.size(), 2);
+            putLE(directory, 0, 2);         // Comment length
+            putLE(directory, 0, 2);         // Disk number
+            putLE(directory, 0, 2);         // Internal attributes
+            putLE(directory, 0, 4);         // External attributes
+            putLE(directory, std::min(record.offset, kZip64Limit), 4);
+            directory += record.name;
+            directory += extra;
+        }
+        uint64_t dirSize = directory.size();
+        uint64_t count = records_.size();
+
+        if (count > kZip64EntryLimit || dirOffset >= kZip64Limit || dirSize >= kZip64Limit) {
+            uint64_t recordOffset = dirOffset + dirSize;
+            putLE(directory, 0x06064b50, 4);
+            putLE(directory, 44, 8);        // Size of the rest of the record
+            putLE(directory, 45, 2);        // Version made by
+            putLE(directory, 45, 2);        // Version needed
+            putLE(directory, 0, 4);         // Disk number
+            putLE(directory, 0, 4);         // Disk with the directory
+            putLE(directory, count, 8);
+            putLE(directory, count, 8);
+            putLE(directory, dirSize, 8);
+            putLE(directory, dirOffset, 8);
+
+            putLE(directory, 0x07064b50, 4);
+            putLE(directory, 0, 4);         // Disk with the Zip64 record
+            putLE(directory, recordOffset, 8);
+            putLE(directory, 1, 4);         // Total disks
+        }
+
+        putLE(directory, 0x06054b50, 4);
+        putLE(directory, 0, 2);
+        putLE(directory, 0, 2);
+        putLE(directory, std::min<uint64_t>(count, kZip64EntryLimit), 2);
+        putLE(directory, std::min<uint64_t>(count, kZip64EntryLimit), 2);
+        putLE(directory, std::min(dirSize, kZip64Limit), 4);
+        putLE(directory, std::min(dirOffset, kZip64Limit), 4);
+        putLE(directory, 0, 2);             // Comment length
+
+        file_.write(directory.data(), static_cast<std::streamsize>(directory.size()));
+        file_.close();
+        return check(error);
+    }
+
+private:
+    struct Record {
+        std::string name;
+        uint16_t method;
+        uint32_t crc;
+        uint64_t compressedSize;
+        uint64_t size;
+        uint64_t offset;
+    };
+
+    std::string path_;
+    std::ofstream file_;
+    uint64_t offset_ = 0;
+    std::vector<Record> records_;
+
+    void writeHeader(const std::string& name, uint16_t methodId, uint32_t crc,
+                     uint64_t compressedSize, uint64_t size) {
+        // Local headers carry both sizes in the extra field when either
+        // overflows; the offset only lives in the central directory
+        std::string extra;
+        if (size >= kZip64Limit || compressedSize >= kZip64Limit) {
+            std::string fields;
+            putLE(fields, size, 8);
+            putLE(fields, compressedSize, 8);
+            extra = zip64Extra(fields);
+        }
+
+        std::string header;
+        putLE(header, 0x04034b50, 4);
+        putLE(header, extra.empty() ? 20 : 45, 2);  // Version needed
+        putLE(header, 0, 2);            // Flags
+        putLE(header, methodId, 2);
+        putLE(header, 0, 2);            // Time
+        putLE(header, kDosDate, 2);
+        putLE(header, crc, 4);
+        putLE(header, extra.empty() ? compressedSize : kZip64Limit, 4);
+        putLE(header, extra.empty() ? size : kZip64Limit, 4);
+        putLE(header, name.size(), 2);
+        putLE(header, extra.size(), 2);
+        header += name;
+        header += extra;
+
+        records_.push_back({ name, methodId, crc, compressedSize, size, offset_ });
+        file_.write(header.data(), static_cast<std::streamsize>(header.size()));
+        offset_ += header.size();
+    }
+
+    bool check(std::string& error) {
+        if (!file_.good()) {
+            error = "Failed to write " + path_;
+            return false;
+        }
+        return true;
+    }
+
+    static std::string zip64Extra(const std::string& fields) {
+        std::string extra;
+        putLE(extra, 0x0001, 2);
+        putLE(extra, fields.size(), 2);
+        return extra + fields;
+    }
+
+    static bool deflateRaw(const std::string& data, std::string& out) {
+        z_stream stream = {};
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                         Z_DEFAULT_STRATEGY) != Z_OK) {
+            return false;
+        }
+        out.resize(deflateBound(&stream, static_cast<uLong>(data.size())));
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = static_cast<uInt>(data.size());
+        stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+        stream.avail_out = static_cast<uInt>(out.size());
+        int status = deflate(&stream, Z_FINISH);
+        out.resize(stream.total_out);
+        deflateEnd(&stream);
+        return status == Z_STREAM_END;
+    }
+};
+
+void appendWords(std::string& out, Random& random, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            out += ' ';
+        }
+        out += kWords[random.below(kWordCount)];
+    }
+}
+
+std::string contentXml(const CorpusGenerator::Params& params, Random& random) {
+    std::string xml =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<office:document-content xmlns:office=\"urn:oasis:names:tc:opendocument:xmlns:office:1.0\" "
+        "xmlns:text=\"urn:oasis:names:tc:opendocument:xmlns:text:1.0\" "
+        "xmlns:table=\"urn:oasis:names:tc:opendocument:xmlns:table:1.0\" "
+        "xmlns:draw=\"urn:oasis:names:tc:opendocument:xmlns:drawing:1.0\" "
+        "xmlns:presentation=\"urn:oasis:names:tc:opendocument:xmlns:presentation:1.0\" "
+        "office:version=\"1.3\"><office:body>";
+    xml.reserve(params.contentBytes + 1024);
+
+    size_t counter = 0;
+    switch (params.kind) {
+        case CorpusGenerator::DocumentKind::Text:
+            xml += "<office:text>";
+            if (params.singleParagraph) {
+                xml += "<text:p text:style-name=\"P1\">";
+                while (xml.size() < params.contentBytes) {
+                    appendWords(xml, random, 64);
+                }
+                xml += "</text:p>";
+            }
+            while (xml.size() < params.contentBytes) {
+                if (counter++ % 12 == 0) {
+                    xml += "<text:h text:outline-level=\"1\">";
+                    appendWords(xml, random, 4);
+                    xml += "</text:h>";
+                }
+                xml += "<text:p text:style-name=\"P1\">";
+                appendWords(xml, random, 20 + random.below(40));
+                xml += "<text:s text:c=\"2\"/>";
+                appendWords(xml, random, 5);
+                xml += "</text:p>";
+            }
+            xml += "</office:text>";
+            break;
+
+        case CorpusGenerator::DocumentKind::Spreadsheet:
+            xml += "<office:spreadsheet><table:table table:name=\"Sheet1\">";
+            while (xml.size() < params.contentBytes) {
+                xml += "<table:table-row>";
+                for (size_t column = 0; column < 8; ++column) {
+                    if (column % 2 == 0) {
+                        std::string value = std::to_string(random.below(1000000));
+                        xml += "<table:table-cell office:value-type=\"float\" office:value=\"" +
+                               value + "\"><text:p>" + value + "</text:p></table:table-cell>";
+                    } else {
+                        xml += "<table:table-cell office:value-type=\"string\"><text:p>";
+                        appendWords(xml, random, 2);
+                        xml += "</text:p></table:table-cell>";
+                    }
+                }
+                xml += "</table:table-row>";
+                if (random.below(10) == 0) {
+                    xml += "<table:table-row table:number-rows-repeated=\"3\">"
+                           "<table:table-cell table:number-columns-repeated=\"8\"/></table:table-row>";
+                }
+            }
+            xml += "</table:table></office:spreadsheet>";
+            break;
+
+        case CorpusGenerator::DocumentKind::Presentation:
+            xml += "<office:presentation>";
+            while (xml.size() < params.contentBytes) {
+                xml += "<draw:page draw:name=\"page" + std::to_string(++counter) + "\">";
+                for (size_t frame = 0; frame < 3; ++frame) {
+                    xml += "<draw:frame presentation:class=\"outline\"><draw:text-box><text:p>";
+                    appendWords(xml, random, 12 + random.below(20));
+                    xml += "</text:p></draw:text-box></draw:frame>";
+                }
+                xml += "</draw:page>";
+            }
+            xml += "</office:presentation>";
+            break;
+    }
+
+    xml += "</office:body></office:document-content>\n";
+    return xml;
+}
+
+std::string metaXml(Random& random) {
+    std::string xml =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<office:document-meta xmlns:office=\"urn:oasis:names:tc:opendocument:xmlns:office:1.0\" "
+        "xmlns:meta=\"urn:oasis:names:tc:opendocument:xmlns:meta:1.0\" "
+        "xmlns:dc=\"http://purl.org/dc/elements/1.1/\" office:version=\"1.3\"><office:meta>"
+        "<meta:generator>odf-bench/1.0</meta:generator><dc:title>";
+    appendWords(xml, random, 5);
+    xml += "</dc:title><dc:description>";
+    appendWords(xml, random, 30);
+    xml += "</dc:description><dc:creator>Bench Writer</dc:creator>"
+           "<meta:initial-creator>Bench Writer</meta:initial-creator>"
+           "<meta:creation-date>2024-01-01T00:00:00</meta:creation-date>"
+           "<dc:date>2024-01-02T03:04:05</dc:date><dc:language>en-US</dc:language>"
+           "<meta:editing-cycles>" + std::to_string(random.below(100)) + "</meta:editing-cycles>"
+           "<meta:editing-duration>PT" + std::to_string(random.below(10)) + "H" +
+           std::to_string(random.below(60)) + "M0S</meta:editing-duration>";
+    for (size_t i = 0; i < 4; ++i) {
+        xml += "<meta:keyword>";
+        appendWords(xml, random, 1);
+        xml += "</meta:keyword>";
+    }
+    xml += "<meta:document-statistic meta:page-count=\"" + std::to_string(1 + random.below(50)) +
+           "\" meta:paragraph-count=\"" + std::to_string(random.below(5000)) +
+           "\" meta:word-count=\"" + std::to_string(random.below(100000)) +
+           "\" meta:character-count=\"" + std::to_string(random.below(600000)) + "\"/>"
+           "<meta:user-defined meta:name=\"Project\" meta:value-type=\"string\">Bench</meta:user-defined>"
+           "</office:meta></office:document-meta>\n";
+    return xml;
+}
+
+std::string stylesXml(Random& random) {
+    std::string xml =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<office:document-styles xmlns:office=\"urn:oasis:names:tc:opendocument:xmlns:office:1.0\" "
+        "xmlns:style=\"urn:oasis:names:tc:opendocument:xmlns:style:1.0\" "
+        "xmlns:fo=\"urn:oasis:names:tc:opendocument:xmlns:xsl-fo-compatible:1.0\" "
+        "office:version=\"1.3\"><office:styles>";
+    for (size_t i = 0; i < 40; ++i) {
+        xml += "<style:style style:name=\"S" + std::to_string(i) + "\" style:family=\"paragraph\">"
+               "<style:text-properties fo:font-size=\"" + std::to_string(8 + random.below(20)) +
+               "pt\"/></style:style>";
+    }
+    xml += "</office:styles></office:document-styles>\n";
+    return xml;
+}
+
+// Cut one element out of a generated part, for nesting it in a flat document
+std::string element(const std::string& xml, const std::string& name) {
+    size_t begin = xml.find("<" + name + ">");
+    size_t end = xml.rfind("</" + name + ">") + name.size() + 3;
+    return xml.substr(begin, end - begin);
+}
+
+const char* const kMimeTypes[] = {
+    "application/vnd.oasis.opendocument.text",
+    "application/vnd.oasis.opendocument.spreadsheet",
+    "application/vnd.oasis.opendocument.presentation"
+};
+
+} // namespace
+
+bool CorpusGenerator::write(const Params& params, const std::string& path) {
+    if (params.flat) {
+        return writeFlat(params, path);
+    }
+
+    Random random(params.seed);
+    ZipBuilder zip(path);
+    std::string manifest =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<manifest:manifest xmlns:manifest=\"urn:oasis:names:tc:opendocument:xmlns:manifest:1.0\" "
+        "manifest:version=\"1.3\">";
+    const char* mimeType = kMimeTypes[static_cast<size_t>(params.kind)];
+    manifest += "<manifest:file-entry manifest:full-path=\"/\" manifest:version=\"1.3\" "
+                "manifest:media-type=\"" + std::string(mimeType) + "\"/>";
+
+    auto add = [&](const std::string& name, const std::string& data, Method method,
+                   const char* mediaType) {
+        if (mediaType != nullptr) {
+            manifest += "<manifest:file-entry manifest:full-path=\"" + name +
+                        "\" manifest:media-type=\"" + mediaType + "\"/>";
+        }
+        return zip.add(name, data, method, lastError_);
+    };
+
+    // The mimetype must come first and stay uncompressed
+    if (!add("mimetype", mimeType, Method::Stored, nullptr)) {
+        return false;
+    }
+
+    // Ahead of content.xml, which then starts beyond the 32-bit offset range
+    if (params.sparseBytes > 0) {
+        manifest += "<manifest:file-entry manifest:full-path=\"Data/sparse.bin\" "
+                    "manifest:media-type=\"application/octet-stream\"/>";
+        if (!zip.addZeros("Data/sparse.bin", params.sparseBytes, lastError_)) {
+            return false;
+        }
+    }
+
+    if (!add("content.xml", contentXml(params, random), params.method, "text/xml") ||
+        !add("styles.xml", stylesXml(random), params.method, "text/xml") ||
+        !add("meta.xml", metaXml(random), params.method, "text/xml")) {
+        return false;
+    }
+
+    for (size_t i = 0; i < params.extraEntries; ++i) {
+        std::string object = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<object id=\"" +
+                             std::to_string(i) + "\">";
+        appendWords(object, random, 10 + random.below(30));
+        object += "</object>\n";
+
+        std::string name = "Objects/obj" + std::to_string(i);
+        if (name.size() + 4 < params.nameLength) {
+            name.append(params.nameLength - name.size() - 4, '_');
+        }
+        if (!add(name + ".xml", object, params.method, "text/xml")) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < params.imageCount; ++i) {
+        // PNG signature followed by noise, which like real image data
+        // barely compresses
+        std::string image("\x89PNG\r\n\x1a\n", 8);
+        image.reserve(params.imageBytes);
+        while (image.size() < params.imageBytes) {
+            image += static_cast<char>(random.next() & 0xFF);
+        }
+        if (!add("Pictures/img" + std::to_string(i) + ".png", image, params.method, "image/png")) {
+            return false;
+        }
+    }
+
+    manifest += "</manifest:manifest>\n";
+    if (!add("META-INF/manifest.xml", manifest, params.method, nullptr) ||
+        !zip.finish(lastError_)) {
+        return false;
+    }
+    return true;
+}
+
+bool CorpusGenerator::writeFlat(const Params& params, const std::string& path) {
+    // Same parts in the same order as the package, so the random content
+    // matches a package written with the same seed
+    Random random(params.seed);
+    std::string content = contentXml(params, random);
+    std::string styles = stylesXml(random);
+    std::string meta = metaXml(random);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<office:document xmlns:office=\"urn:oasis:names:tc:opendocument:xmlns:office:1.0\" "
+            "xmlns:meta=\"urn:oasis:names:tc:opendocument:xmlns:meta:1.0\" "
+            "xmlns:dc=\"http://purl.org/dc/elements/1.1/\" "
+            "xmlns:style=\"urn:oasis:names:tc:opendocument:xmlns:style:1.0\" "
+            "xmlns:fo=\"urn:oasis:names:tc:opendocument:xmlns:xsl-fo-compatible:1.0\" "
+            "xmlns:text=\"urn:oasis:names:tc:opendocument:xmlns:text:1.0\" "
+            "xmlns:table=\"urn:oasis:names:tc:opendocument:xmlns:table:1.0\" "
+            "xmlns:draw=\"urn:oasis:names:tc:opendocument:xmlns:drawing:1.0\" "
+            "xmlns:presentation=\"urn:oasis:names:tc:opendocument:xmlns:presentation:1.0\" "
+            "office:version=\"1.3\" office:mimetype=\"" << kMimeTypes[static_cast<size_t>(params.kind)] << "\">\n"
+         << element(meta, "office:meta") << "\n"
+         << element(styles, "office:styles") << "\n"
+         << element(content, "office:body") << "\n"
+         << "</office:document>\n";
+    if (!file) {
+        lastError_ = "Failed to write " + path;
+        return false;
+    }
+    return true;
+}
+
+const char* CorpusGenerator::extension(DocumentKind kind, bool flat) {
+    switch (kind) {
+        case DocumentKind::Text:         return flat ? ".fodt" : ".odt";
+        case DocumentKind::Spreadsheet:  return flat ? ".fods" : ".ods";
+        case DocumentKind::Presentation: return flat ? ".fodp" : ".odp";
+    }
+    return ".odt";
+}
+
+std::string CorpusGenerator::getLastError() const {
+    return lastError_;
+}
@@ -0,0 +1,73 @@
+#ifndef CORPUSGENERATOR_H
+#define CORPUSGENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Writes deterministic synthetic ODF packages for benchmarking
+ *
+ * The same parameters and seed always produce byte-identical archives, so
+ * timings from different runs and machines refer to the same inputs.
+ */
+class CorpusGenerator {
+public:
+    enum class DocumentKind {
+        Text,           // .odt, paragraphs and headings
+        Spreadsheet,    // .ods, rows of numeric and string cells
+        Presentation    // .odp, pages of text frames
+    };
+
+    enum class Method {
+        Stored,
+        Deflated
+    };
+
+    /**
+     * @brief Shape of one generated document
+     */
+    struct Params {
+        DocumentKind kind = DocumentKind::Text;
+        size_t contentBytes = 64 * 1024;    // Approximate content.xml size
+        size_t extraEntries = 0;            // Additional small XML entries
+        size_t nameLength = 0;              // Minimum name length of extra entries
+        size_t imageCount = 0;
+        size_t imageBytes = 16 * 1024;      // Size of each image
+        Method method = Method::Deflated;   // Used for everything but mimetype
+        uint64_t sparseBytes = 0;           // Stored all-zero entry, written as a file hole
+        bool singleParagraph = false;       // Text only: all content in one text node
+        bool flat = false;                  // Single XML file (.fodt, ...); only the
+                                            // kind, content size and seed apply
+        uint64_t seed = 1;
+    };
+
+    /**
+     * @brief Generate a document and write it to disk
+     * @param params Document shape
+     * @param path Output file path
+     * @return true if the file was written
+     */
+    bool write(const Params& params, const std::string& path);
+
+    /**
+     * @brief Get the file extension for a document kind
+     * @param kind Document kind
+     * @param flat Flat XML rather than a package
+     * @return Extension including the dot
+     */
+    static const char* extension(DocumentKind kind, bool flat = false);
+
+    /**
+     * @brief Get the last error message
+     * @return Error message string
+     */
+    std::string getLastError() const;
+
+private:
+    std::string lastError_;
+
+    bool writeFlat(const Params& params, const std::string& path);
+};
+
+#endif // CORPUSGENERATOR_H
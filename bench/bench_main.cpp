@@ -0,0 +1,920 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "CorpusGenerator.h"
+#include "Crc32.h"
+#include "FlatODF.h"
+#include "Inflater.h"
+#include "ODFInspector.h"
+#include "ODFMetadata.h"
+#include "TableScanner.h"
+#include "TextExtractor.h"
+#include "XmlFormatter.h"
+#include "XmlTree.h"
+#include "ZipReader.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#endif
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    double minTime = 0.5;           // Seconds spent on each benchmark
+    size_t minIterations = 5;
+    bool quick = false;
+    bool zip64 = false;             // Run the Zip64 checks instead of benchmarks
+    double tolerance = 0.0;         // Allowed slowdown in percent; 0 = 50 with --quick, else 10
+    size_t repeat = 0;              // Timed passes per benchmark; 0 = 3 with --baseline, else 1
+    std::string filter;
+    std::string outputFile;
+    std::string baselineFile;
+    std::string corpusDir;
+    std::vector<std::string> documents;  // Real documents benchmarked as well
+};
+
+/**
+ * @brief One document of the corpus, generated or given by --documents
+ */
+struct CorpusDocument {
+    std::string name;
+    std::string path;
+    uint64_t fileSize = 0;
+};
+
+/**
+ * @brief Timing summary of one benchmark
+ */
+struct Result {
+    std::string name;
+    size_t iterations = 0;
+    double medianNs = 0;
+    double p90Ns = 0;
+    double p99Ns = 0;
+    double megabytesPerSecond = 0;
+};
+
+/**
+ * @brief What a set of timings was measured on
+ *
+ * Saved with a baseline; timings from another CPU, compiler or build type
+ * say nothing about regressions.
+ */
+struct HostInfo {
+    std::string cpu = "unknown";
+    std::string compiler = "unknown";
+    std::string build = "unknown";
+
+    bool operator==(const HostInfo& other) const {
+        return cpu == other.cpu && compiler == other.compiler && build == other.build;
+    }
+};
+
+void printUsage(const char* programName) {
+    std::cout << "\nODF Inspector benchmarks\n";
+    std::cout << "========================\n\n";
+    std::cout << "Usage: " << programName << " [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --quick             Small corpus and short runs (smoke test)\n";
+    std::cout << "  --min-time <sec>    Time spent on each benchmark (default: 0.5)\n";
+    std::cout << "  --filter <text>     Only run benchmarks whose name contains text\n";
+    std::cout << "  --corpus <dir>      Where to write the corpus (default: temp dir)\n";
+    std::cout << "  --documents <path>  Also benchmark real ODF files (a file or directory;\n";
+    std::cout << "                      may be repeated)\n";
+    std::cout << "  --output <file>     Save results as a baseline\n";
+    std::cout << "  --baseline <file>   Compare against a saved baseline; exit with 1\n";
+    std::cout << "                      if any median got slower than the tolerance\n";
+    std::cout << "  --tolerance <pct>   Allowed slowdown in percent (default: 10, or 50\n";
+    std::cout << "                      with --quick, whose short runs are noisier)\n";
+    std::cout << "  --repeat <n>        Time each benchmark n times and keep the median\n";
+    std::cout << "                      pass (default: 3 with --baseline, otherwise 1)\n";
+    std::cout << "  --zip64             Check Zip64 support instead: writes a 70000-entry\n";
+    std::cout << "                      archive and a sparse archive over 4 GiB\n";
+    std::cout << "  --help              Show this help message\n\n";
+}
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--quick") {
+            options.quick = true;
+            options.minTime = 0.05;
+        } else if (arg == "--min-time" && hasValue) {
+            options.minTime = std::atof(argv[++i]);
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--corpus" && hasValue) {
+            options.corpusDir = argv[++i];
+        } else if (arg == "--documents" && hasValue) {
+            options.documents.push_back(argv[++i]);
+        } else if (arg == "--output" && hasValue) {
+            options.outputFile = argv[++i];
+        } else if (arg == "--baseline" && hasValue) {
+            options.baselineFile = argv[++i];
+        } else if (arg == "--tolerance" && hasValue) {
+            options.tolerance = std::atof(argv[++i]);
+        } else if (arg == "--repeat" && hasValue) {
+            options.repeat = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--zip64") {
+            options.zip64 = true;
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            std::exit(0);
+        } else {
+            std::cerr << "Error: Unknown or incomplete option " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Peak resident set size of this process in KiB
+ */
+uint64_t peakRssKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize / 1024;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss) / 1024;   // Bytes on macOS
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+/**
+ * @brief Describe the CPU, compiler and build type of this binary
+ */
+HostInfo hostInfo() {
+    HostInfo host;
+#if defined(_WIN32)
+    if (const char* identifier = std::getenv("PROCESSOR_IDENTIFIER")) {
+        host.cpu = identifier;
+    }
+#elif defined(__APPLE__)
+    char brand[256];
+    size_t size = sizeof(brand);
+    if (sysctlbyname("machdep.cpu.brand_string", brand, &size, nullptr, 0) == 0) {
+        host.cpu = brand;
+    }
+#else
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            size_t colon = line.find(':');
+            if (colon != std::string::npos && colon + 2 <= line.size()) {
+                host.cpu = line.substr(colon + 2);
+            }
+            break;
+        }
+    }
+#endif
+
+#if defined(__clang__)
+    host.compiler = "Clang " __clang_version__;
+#elif defined(__GNUC__)
+    host.compiler = "GCC " __VERSION__;
+#elif defined(_MSC_VER)
+    host.compiler = "MSVC " + std::to_string(_MSC_FULL_VER);
+#endif
+    while (!host.compiler.empty() && host.compiler.back() == ' ') {
+        host.compiler.pop_back();
+    }
+
+#ifdef ODF_BENCH_BUILD_TYPE
+    if (ODF_BENCH_BUILD_TYPE[0] != '\0') {
+        host.build = ODF_BENCH_BUILD_TYPE;
+    }
+#endif
+    return host;
+}
+
+std::string sizeLabel(size_t bytes) {
+    if (bytes >= 1024 * 1024) {
+        return std::to_string(bytes / (1024 * 1024)) + "m";
+    }
+    return std::to_string(bytes / 1024) + "k";
+}
+
+/**
+ * @brief Build the document matrix
+ *
+ * Each axis (content size, entry count, image count, compression) is
+ * varied on its own around a 256 KiB deflated document, for all three
+ * document kinds; a full cross product would take far too long to run.
+ * Flat XML versions cover the content sizes.
+ */
+std::vector<CorpusGenerator::Params> corpusMatrix(bool quick) {
+    using Kind = CorpusGenerator::DocumentKind;
+    using Method = CorpusGenerator::Method;
+
+    std::vector<size_t> contentSizes = { 16 * 1024, 256 * 1024, 4 * 1024 * 1024 };
+    std::vector<size_t> entryCounts = { 100, 1000 };
+    std::vector<size_t> imageCounts = { 16, 128 };
+    if (quick) {
+        contentSizes = { 16 * 1024, 256 * 1024 };
+        entryCounts = { 100 };
+        imageCounts = { 16 };
+    }
+
+    std::vector<CorpusGenerator::Params> matrix;
+    for (Kind kind : { Kind::Text, Kind::Spreadsheet, Kind::Presentation }) {
+        CorpusGenerator::Params base;
+        base.kind = kind;
+        base.contentBytes = 256 * 1024;
+        base.extraEntries = 10;
+
+        for (size_t size : contentSizes) {
+            CorpusGenerator::Params params = base;
+            params.contentBytes = size;
+            matrix.push_back(params);
+        }
+        for (size_t count : entryCounts) {
+            CorpusGenerator::Params params = base;
+            params.extraEntries = count;
+            matrix.push_back(params);
+        }
+        for (size_t count : imageCounts) {
+            CorpusGenerator::Params params = base;
+            params.imageCount = count;
+            matrix.push_back(params);
+        }
+        CorpusGenerator::Params stored = base;
+        stored.method = Method::Stored;
+        matrix.push_back(stored);
+
+        // One long text node, which previews must not have to buffer
+        if (kind == Kind::Text) {
+            CorpusGenerator::Params paragraph = base;
+            paragraph.contentBytes = 4 * 1024 * 1024;
+            paragraph.singleParagraph = true;
+            matrix.push_back(paragraph);
+        }
+
+        for (size_t size : contentSizes) {
+            CorpusGenerator::Params params = base;
+            params.contentBytes = size;
+            params.extraEntries = 0;
+            params.flat = true;
+            matrix.push_back(params);
+        }
+    }
+    return matrix;
+}
+
+std::string documentName(const CorpusGenerator::Params& params) {
+    std::string name = CorpusGenerator::extension(params.kind, params.flat) + 1;
+    name += "-c" + sizeLabel(params.contentBytes);
+    if (params.flat) {
+        return name;
+    }
+    name += "-e" + std::to_string(params.extraEntries);
+    name += "-i" + std::to_string(params.imageCount);
+    name += params.method == CorpusGenerator::Method::Stored ? "-stored" : "-deflated";
+    if (params.singleParagraph) {
+        name += "-paragraph";
+    }
+    return name;
+}
+
+bool writeCorpus(const BenchOptions& options, const fs::path& dir,
+                 std::vector<CorpusDocument>& corpus) {
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) {
+        std::cerr << "Error: Cannot create " << dir.string() << ": " << ec.message() << "\n";
+        return false;
+    }
+
+    CorpusGenerator generator;
+    for (const auto& params : corpusMatrix(options.quick)) {
+        CorpusDocument document;
+        document.name = documentName(params);
+        document.path = (dir / (document.name + CorpusGenerator::extension(params.kind, params.flat))).string();
+        if (!generator.write(params, document.path)) {
+            std::cerr << "Error: " << generator.getLastError() << "\n";
+            return false;
+        }
+        document.fileSize = fs::file_size(document.path);
+        corpus.push_back(std::move(document));
+    }
+    return true;
+}
+
+/**
+ * @brief Add the real documents named by --documents
+ *
+ * They are named after their file, so results are only comparable
+ * between runs over the same files.
+ */
+bool addDocuments(const BenchOptions& options, std::vector<CorpusDocument>& corpus) {
+    for (const auto& input : options.documents) {
+        std::vector<fs::path> paths;
+        std::error_code ec;
+        if (fs::is_directory(input, ec)) {
+            for (const auto& entry : fs::recursive_directory_iterator(input, ec)) {
+                if (entry.is_regular_file(ec)) {
+                    paths.push_back(entry.path());
+                }
+            }
+            std::sort(paths.begin(), paths.end());
+        } else {
+            paths.push_back(input);
+        }
+
+        for (const auto& path : paths) {
+            ZipReader zip(path.string(), ZipReader::Backend::Mapped);
+            FlatODF flat;
+            bool package = zip.open() && zip.fileExists("content.xml") && zip.fileExists("meta.xml");
+            bool flatDocument = !package && flat.open(path.string()) &&
+                                !flat.section(FlatODF::Section::Body).empty() &&
+                                !flat.section(FlatODF::Section::Meta).empty();
+            if (!package && !flatDocument) {
+                // Other files found in directories are skipped quietly
+                if (paths.size() == 1 && !fs::is_directory(input, ec)) {
+                    std::cerr << "Skipping " << path.string() << ": not a complete ODF document\n";
+                }
+                continue;
+            }
+            CorpusDocument document;
+            document.name = "real-" + path.filename().string();
+            document.path = path.string();
+            document.fileSize = fs::file_size(path, ec);
+            corpus.push_back(std::move(document));
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Time repeated calls of a function
+ * @param body Work for one iteration; returns false on failure
+ * @param bytes Bytes processed per iteration, for the throughput column
+ */
+bool measure(const std::string& name, const BenchOptions& options, uint64_t bytes,
+             const std::function<bool()>& body, Result& result) {
+    // One untimed call to warm caches and catch failures early
+    if (!body()) {
+        std::cerr << "Error: " << name << " failed\n";
+        return false;
+    }
+
+    std::vector<double> samples;
+    auto start = Clock::now();
+    auto deadline = start + std::chrono::duration<double>(options.minTime);
+    while (samples.size() < options.minIterations || Clock::now() < deadline) {
+        auto before = Clock::now();
+        if (!body()) {
+            std::cerr << "Error: " << name << " failed\n";
+            return false;
+        }
+        samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+        if (samples.size() >= 1000000) {
+            break;
+        }
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        size_t index = static_cast<size_t>(std::ceil(p * samples.size())) - 1;
+        return samples[std::min(index, samples.size() - 1)];
+    };
+
+    result.name = name;
+    result.iterations = samples.size();
+    result.medianNs = percentile(0.50);
+    result.p90Ns = percentile(0.90);
+    result.p99Ns = percentile(0.99);
+    result.megabytesPerSecond = bytes > 0 ? (bytes / 1e6) / (result.medianNs / 1e9) : 0;
+    return true;
+}
+
+struct Bench {
+    std::string name;
+    uint64_t bytes;
+    std::function<bool()> body;
+};
+
+/**
+ * @brief Register the archive benchmarks of a package
+ * @param content Receives content.xml for the format benchmark
+ * @param meta Receives meta.xml for the parse benchmark
+ */
+bool addArchiveBenches(const CorpusDocument& document, std::vector<Bench>& benches,
+                       std::string& content, std::string& meta) {
+    for (auto backend : { ZipReader::Backend::Minizip, ZipReader::Backend::Mapped }) {
+        std::string suffix = backend == ZipReader::Backend::Mapped ? ".mapped/" : ".minizip/";
+        auto reader = std::make_shared<ZipReader>(document.path, backend);
+        if (!reader->open()) {
+            std::cerr << "Error: " << reader->getLastError() << "\n";
+            return false;
+        }
+        auto content = std::make_shared<std::string>();
+        uint64_t contentSize = reader->getFileSize("content.xml");
+
+        benches.push_back({ "zip.open" + suffix + document.name, document.fileSize,
+            [path = document.path, backend]() {
+                ZipReader zip(path, backend);
+                return zip.open();
+            } });
+        benches.push_back({ "zip.list" + suffix + document.name, 0,
+            [reader]() {
+                return !reader->listFiles().empty();
+            } });
+        benches.push_back({ "zip.extract" + suffix + document.name, contentSize,
+            [reader, content]() {
+                return reader->extractFileTo("content.xml", *content);
+            } });
+        benches.push_back({ "zip.prefix" + suffix + document.name, std::min<uint64_t>(contentSize, 2048),
+            [reader, content]() {
+                return reader->extractPrefix("content.xml", 2048, *content);
+            } });
+    }
+
+    // The same whole-entry read with every inflate backend built in
+    for (size_t i = 0; i < Inflater::kBackendCount; ++i) {
+        auto backend = static_cast<Inflater::Backend>(i);
+        if (!Inflater::isAvailable(backend)) {
+            continue;
+        }
+        auto reader = std::make_shared<ZipReader>(document.path, ZipReader::Backend::Mapped);
+        reader->setInflateBackend(backend);
+        if (!reader->open()) {
+            std::cerr << "Error: " << reader->getLastError() << "\n";
+            return false;
+        }
+        auto content = std::make_shared<std::string>();
+        benches.push_back({ std::string("inflate.") + Inflater::name(backend) + "/" + document.name,
+            reader->getFileSize("content.xml"),
+            [reader, content]() {
+                return reader->extractFileTo("content.xml", *content);
+            } });
+    }
+
+    auto verified = std::make_shared<ZipReader>(document.path, ZipReader::Backend::Mapped);
+    if (!verified->open()) {
+        std::cerr << "Error: " << verified->getLastError() << "\n";
+        return false;
+    }
+    uint64_t archiveBytes = 0;
+    for (const ZipEntry& entry : verified->entries()) {
+        archiveBytes += entry.uncompressedSize;
+    }
+    benches.push_back({ "zip.verify/" + document.name, archiveBytes,
+        [verified]() {
+            std::string problem;
+            for (const ZipEntry& entry : verified->entries()) {
+                if (!verified->verifyEntry(entry, problem)) {
+                    return false;
+                }
+            }
+            return true;
+        } });
+
+    ZipReader zip(document.path, ZipReader::Backend::Mapped);
+    if (!zip.open()) {
+        std::cerr << "Error: " << zip.getLastError() << "\n";
+        return false;
+    }
+    content = zip.extractFile("content.xml");
+    meta = zip.extractFile("meta.xml");
+    return true;
+}
+
+/**
+ * @brief Register and run every benchmark over one document
+ */
+bool benchDocument(const CorpusDocument& document, const BenchOptions& options,
+                   std::vector<Result>& results) {
+    std::vector<Bench> benches;
+    auto content = std::make_shared<std::string>();
+    auto meta = std::make_shared<std::string>();
+
+    // Flat documents are parsed in place, so format and parse their sections
+    FlatODF flat;
+    if (flat.open(document.path)) {
+        benches.push_back({ "flat.open/" + document.name, document.fileSize,
+            [path = document.path]() {
+                FlatODF probe;
+                return probe.open(path);
+            } });
+        content->assign(flat.section(FlatODF::Section::Body));
+        meta->assign(flat.section(FlatODF::Section::Meta));
+    } else if (!addArchiveBenches(document, benches, *content, *meta)) {
+        return false;
+    }
+
+    benches.push_back({ "format/" + document.name, content->size(),
+        [content]() {
+            XmlFormatter formatter;
+            formatter.feed(*content);
+            formatter.finish();
+            return !formatter.output().empty();
+        } });
+    // Fed in the chunks streamFile() would deliver
+    benches.push_back({ "text/" + document.name, content->size(),
+        [content]() {
+            size_t size = 0;
+            TextExtractor extractor([&size](std::string_view text) { size += text.size(); });
+            std::string_view xml = *content;
+            for (size_t offset = 0; offset < xml.size(); offset += ZipReader::kDefaultChunkSize) {
+                extractor.feed(xml.substr(offset, ZipReader::kDefaultChunkSize));
+            }
+            extractor.finish();
+            return size > 0;
+        } });
+    benches.push_back({ "tables/" + document.name, content->size(),
+        [content]() {
+            TableScanner scanner;
+            std::string_view xml = *content;
+            for (size_t offset = 0; offset < xml.size(); offset += ZipReader::kDefaultChunkSize) {
+                scanner.feed(xml.substr(offset, ZipReader::kDefaultChunkSize));
+            }
+            scanner.finish();
+            return scanner.bytesConsumed() == xml.size();
+        } });
+    benches.push_back({ "crc32/" + document.name, content->size(),
+        [content]() {
+            return Crc32::update(0, content->data(), content->size()) != 0;
+        } });
+    benches.push_back({ "tree.build/" + document.name, content->size(),
+        [content]() {
+            XmlTree tree;
+            return tree.build(*content);
+        } });
+    benches.push_back({ "meta.parse/" + document.name, meta->size(),
+        [meta]() {
+            ODFMetadata metadata;
+            return ODFMetadata::parse(*meta, metadata);
+        } });
+    benches.push_back({ "inspector.load/" + document.name, document.fileSize,
+        [path = document.path]() {
+            ODFInspector inspector(path);
+            return inspector.load();
+        } });
+    // Should cost the same whatever the size and shape of content.xml
+    auto inspector = std::make_shared<ODFInspector>(document.path);
+    if (!inspector->load()) {
+        std::cerr << "Error: " << inspector->getLastError() << "\n";
+        return false;
+    }
+    benches.push_back({ "inspector.preview/" + document.name, 0,
+        [inspector]() {
+            std::ostringstream out;
+            inspector->displayContent(out);
+            return out.tellp() > 0;
+        } });
+
+    for (const auto& bench : benches) {
+        if (!options.filter.empty() && bench.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        // A single pass can land on a burst of noise; the median of a few
+        // is what gets compared against a baseline
+        std::vector<Result> passes(options.repeat);
+        for (Result& pass : passes) {
+            if (!measure(bench.name, options, bench.bytes, bench.body, pass)) {
+                return false;
+            }
+        }
+        std::sort(passes.begin(), passes.end(), [](const Result& a, const Result& b) {
+            return a.medianNs < b.medianNs;
+        });
+        Result result = passes[passes.size() / 2];
+
+        std::cout << std::left << std::setw(52) << result.name << std::right
+                  << std::setw(9) << result.iterations
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(12) << result.medianNs / 1000.0
+                  << std::setw(12) << result.p90Ns / 1000.0
+                  << std::setw(12) << result.p99Ns / 1000.0;
+        if (bench.bytes > 0) {
+            std::cout << std::setw(11) << result.megabytesPerSecond;
+        } else {
+            std::cout << std::setw(11) << "-";
+        }
+        std::cout << "\n" << std::flush;
+        results.push_back(std::move(result));
+    }
+    return true;
+}
+
+/**
+ * @brief Write results in the baseline format
+ *
+ * One line per benchmark: name, median, p90 and p99 in nanoseconds, and
+ * MB/s. Lines starting with '#' are comments, except that "# cpu",
+ * "# compiler" and "# build" record the host the timings came from.
+ */
+bool writeBaseline(const std::string& path, const std::vector<Result>& results, uint64_t rssKb,
+                   const HostInfo& host) {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Error: Cannot write " << path << "\n";
+        return false;
+    }
+    file << "# odf-bench baseline: name median_ns p90_ns p99_ns mb_per_s\n";
+    file << "# cpu " << host.cpu << "\n";
+    file << "# compiler " << host.compiler << "\n";
+    file << "# build " << host.build << "\n";
+    file << "# peak-rss-kb " << rssKb << "\n";
+    file << std::fixed << std::setprecision(0);
+    for (const auto& result : results) {
+        file << result.name << ' ' << result.medianNs << ' ' << result.p90Ns << ' '
+             << result.p99Ns << ' ' << std::setprecision(1) << result.megabytesPerSecond
+             << std::setprecision(0) << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+bool readBaseline(const std::string& path, std::map<std::string, Result>& baseline, HostInfo& host) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Error: Cannot read " << path << "\n";
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            for (auto field : { std::make_pair("# cpu ", &host.cpu),
+                                std::make_pair("# compiler ", &host.compiler),
+                                std::make_pair("# build ", &host.build) }) {
+                size_t length = std::char_traits<char>::length(field.first);
+                if (line.compare(0, length, field.first) == 0) {
+                    *field.second = line.substr(length);
+                }
+            }
+            continue;
+        }
+        std::istringstream fields(line);
+        Result result;
+        if (fields >> result.name >> result.medianNs >> result.p90Ns >> result.p99Ns
+                   >> result.megabytesPerSecond) {
+            baseline[result.name] = result;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Compare medians against a baseline
+ * @return Number of regressions
+ */
+size_t compareBaseline(const std::map<std::string, Result>& baseline,
+                       const std::vector<Result>& results, double tolerance) {
+    size_t regressions = 0;
+    size_t compared = 0;
+
+    std::cout << "\nComparison against baseline (tolerance " << tolerance << "%):\n";
+    std::cout << std::fixed << std::setprecision(1);
+    for (const auto& result : results) {
+        auto it = baseline.find(result.name);
+        if (it == baseline.end() || it->second.medianNs <= 0) {
+            continue;
+        }
+        ++compared;
+        double change = (result.medianNs / it->second.medianNs - 1.0) * 100.0;
+        if (change > tolerance) {
+            ++regressions;
+            std::cout << "  REGRESSION " << std::left << std::setw(52) << result.name << std::right
+                      << " +" << change << "%\n";
+        } else if (change < -tolerance) {
+            std::cout << "  improved   " << std::left << std::setw(52) << result.name << std::right
+                      << " " << change << "%\n";
+        }
+    }
+    std::cout << "  " << compared << " compared, " << regressions << " regressed\n";
+    return regressions;
+}
+
+/**
+ * @brief Read one Zip64 archive with both backends and check its contents
+ * @param path Archive path
+ * @param params Parameters it was generated with
+ * @return true if every check passed
+ */
+bool checkZip64Archive(const std::string& path, const CorpusGenerator::Params& params) {
+    // mimetype, content, styles, meta, manifest, plus the optional entries
+    size_t expectedEntries = 5 + params.extraEntries + params.imageCount + (params.sparseBytes > 0 ? 1 : 0);
+    bool ok = true;
+    auto fail = [&](const std::string& backendName, const std::string& message) {
+        std::cout << "  FAIL " << backendName << ": " << message << "\n";
+        ok = false;
+    };
+
+    for (auto backend : { ZipReader::Backend::Minizip, ZipReader::Backend::Mapped }) {
+        std::string backendName = backend == ZipReader::Backend::Mapped ? "mapped" : "minizip";
+        auto start = Clock::now();
+        ZipReader zip(path, backend);
+        if (!zip.open()) {
+            fail(backendName, zip.getLastError());
+            continue;
+        }
+        if (zip.entries().size() != expectedEntries) {
+            fail(backendName, std::to_string(zip.entries().size()) + " entries, expected " +
+                                  std::to_string(expectedEntries));
+        }
+        if (params.nameLength > 0) {
+            const ZipEntry& last = zip.entries()[zip.entries().size() - 2];
+            if (last.name.size() < params.nameLength) {
+                fail(backendName, "name truncated to " + std::to_string(last.name.size()) + " bytes");
+            }
+        }
+
+        std::string content;
+        if (!zip.extractFileTo("content.xml", content) || content.compare(0, 5, "<?xml") != 0) {
+            fail(backendName, "content.xml unreadable: " + zip.getLastError());
+        }
+
+        if (params.sparseBytes > 0) {
+            if (zip.getFileSize("Data/sparse.bin") != params.sparseBytes) {
+                fail(backendName, "sparse entry size " + std::to_string(zip.getFileSize("Data/sparse.bin")));
+            }
+            // Only the head of the big entry; the full read is I/O bound
+            constexpr uint64_t kStreamLimit = 64ull << 20;
+            uint64_t streamed = 0;
+            bool zeros = true;
+            bool streamOk = zip.streamFile("Data/sparse.bin", [&](const char* data, size_t size) {
+                zeros = zeros && std::all_of(data, data + size, [](char c) { return c == 0; });
+                streamed += size;
+                return streamed < kStreamLimit;
+            });
+            if (!streamOk || !zeros || streamed < kStreamLimit) {
+                fail(backendName, "streaming the sparse entry failed: " + zip.getLastError());
+            }
+        }
+
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        std::cout << "  " << std::left << std::setw(10) << backendName << std::right
+                  << zip.entries().size() << " entries, " << std::fixed << std::setprecision(1)
+                  << ms << " ms\n";
+    }
+    return ok;
+}
+
+/**
+ * @brief Generate archives that need Zip64 and read them back
+ *
+ * One exceeds the 65535-entry limit with names longer than 255 bytes, the
+ * other places content.xml beyond 4 GiB behind a sparse entry, so it takes
+ * little real disk space where the filesystem supports holes.
+ */
+bool checkZip64(const fs::path& dir) {
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) {
+        std::cerr << "Error: Cannot create " << dir.string() << ": " << ec.message() << "\n";
+        return false;
+    }
+
+    CorpusGenerator::Params manyEntries;
+    manyEntries.contentBytes = 16 * 1024;
+    manyEntries.extraEntries = 70000;
+    manyEntries.nameLength = 300;
+
+    CorpusGenerator::Params largeOffsets;
+    largeOffsets.contentBytes = 16 * 1024;
+    largeOffsets.sparseBytes = 4608ull << 20;   // 4.5 GiB
+
+    CorpusGenerator generator;
+    bool ok = true;
+    for (const auto& [name, params] : { std::make_pair("zip64-entries.odt", manyEntries),
+                                        std::make_pair("zip64-offsets.odt", largeOffsets) }) {
+        std::string path = (dir / name).string();
+        std::cout << name << "\n";
+        if (!generator.write(params, path)) {
+            std::cerr << "Error: " << generator.getLastError() << "\n";
+            ok = false;
+        } else {
+            ok = checkZip64Archive(path, params) && ok;
+        }
+        fs::remove(path, ec);
+    }
+
+    std::cout << (ok ? "\nZip64 checks passed\n" : "\nZip64 checks FAILED\n");
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (options.repeat == 0) {
+        options.repeat = options.baselineFile.empty() ? 1 : 3;
+    }
+    if (options.tolerance <= 0.0) {
+        // Some benchmarks settle at one of two speeds for the life of the
+        // process, about a third apart, which more passes don't smooth out
+        options.tolerance = options.quick ? 50.0 : 10.0;
+    }
+
+    bool ownCorpus = options.corpusDir.empty();
+    fs::path corpusDir = ownCorpus ? fs::temp_directory_path() / "odf-bench-corpus"
+                                   : fs::path(options.corpusDir);
+
+    if (options.zip64) {
+        bool ok = checkZip64(corpusDir);
+        if (ownCorpus) {
+            std::error_code ec;
+            fs::remove_all(corpusDir, ec);
+        }
+        return ok ? 0 : 1;
+    }
+
+    std::vector<CorpusDocument> corpus;
+    if (!writeCorpus(options, corpusDir, corpus) || !addDocuments(options, corpus)) {
+        return 1;
+    }
+    std::cout << "Corpus: " << corpus.size() << " documents in " << corpusDir.string() << "\n\n";
+
+    std::cout << std::left << std::setw(52) << "benchmark" << std::right
+              << std::setw(9) << "iters" << std::setw(12) << "median us"
+              << std::setw(12) << "p90 us" << std::setw(12) << "p99 us"
+              << std::setw(11) << "MB/s" << "\n";
+
+    std::vector<Result> results;
+    bool ok = true;
+    for (const auto& document : corpus) {
+        if (!benchDocument(document, options, results)) {
+            ok = false;
+            break;
+        }
+    }
+
+    if (ownCorpus) {
+        std::error_code ec;
+        fs::remove_all(corpusDir, ec);
+    }
+    if (!ok) {
+        return 1;
+    }
+
+    uint64_t rssKb = peakRssKb();
+    std::cout << "\nPeak RSS: " << rssKb << " KiB\n";
+
+    HostInfo host = hostInfo();
+    if (!options.outputFile.empty() && !writeBaseline(options.outputFile, results, rssKb, host)) {
+        return 1;
+    }
+    if (!options.baselineFile.empty()) {
+        std::map<std::string, Result> baseline;
+        HostInfo baselineHost;
+        if (!readBaseline(options.baselineFile, baseline, baselineHost)) {
+            return 1;
+        }
+        size_t regressions = compareBaseline(baseline, results, options.tolerance);
+        if (!(baselineHost == host)) {
+            // Show the comparison, but don't fail on timings from elsewhere
+            std::cout << "\nWarning: the baseline comes from a different host or build, so\n"
+                      << "regressions are not counted. Save a baseline here with --output.\n"
+                      << "  baseline: " << baselineHost.cpu << "; " << baselineHost.compiler
+                      << "; " << baselineHost.build << "\n"
+                      << "  this run: " << host.cpu << "; " << host.compiler << "; " << host.build << "\n";
+            regressions = 0;
+        }
+        if (regressions > 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
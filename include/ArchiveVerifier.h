@@ -0,0 +1,79 @@
+#ifndef ARCHIVEVERIFIER_H
+#define ARCHIVEVERIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Checks the integrity of many ODF archives in parallel
+ *
+ * Every entry of every archive is decompressed and its CRC-32 compared
+ * with the central directory, and every local header is cross-checked
+ * against its central directory record (see ZipReader::verifyEntry()).
+ * Entries, not documents, are the unit of work, so a single large
+ * archive is spread across all cores as well as a directory of small
+ * ones. Archives are mapped rather than read, and each entry streams
+ * through one fixed-size buffer, so memory use does not depend on entry
+ * or archive sizes.
+ */
+class ArchiveVerifier {
+public:
+    /**
+     * @brief Something wrong with one entry
+     */
+    struct Problem {
+        std::string entry;
+        std::string message;
+    };
+
+    /**
+     * @brief Outcome for one document
+     */
+    struct Report {
+        std::string path;
+        size_t entries = 0;
+        uint64_t bytes = 0;         // Uncompressed bytes checked
+        uint64_t storedBytes = 0;   // Compressed bytes read
+        bool skipped = false;       // Flat XML document, nothing to verify
+        std::string error;          // Set if the archive could not be opened
+        std::vector<Problem> problems;  // Sorted by entry name
+
+        bool ok() const { return error.empty() && problems.empty(); }
+    };
+
+    /**
+     * @brief Receives each document's report when its last entry is done
+     *
+     * Called from worker threads, one call at a time.
+     */
+    using Callback = std::function<void(const Report& report)>;
+
+    /**
+     * @brief Construct a new Archive Verifier object
+     * @param threadCount Number of worker threads (0 = hardware concurrency)
+     */
+    explicit ArchiveVerifier(size_t threadCount = 0);
+
+    /**
+     * @brief Verify every document matched by the inputs
+     * @param inputs Files, directories, patterns or "-" (see BatchRunner)
+     * @param onReport Callback receiving each document's report
+     */
+    void run(const std::vector<std::string>& inputs, const Callback& onReport);
+
+    /**
+     * @brief Write one document's report
+     * @param report Report to write
+     * @param out Stream to write to
+     */
+    static void write(const Report& report, std::ostream& out);
+
+private:
+    size_t threadCount_;
+};
+
+#endif // ARCHIVEVERIFIER_H
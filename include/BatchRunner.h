@@ -0,0 +1,84 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Runs a per-document job over many ODF files in parallel
+ *
+ * Inputs may be files, directories (searched recursively for ODF
+ * extensions), wildcard patterns using '*', '?' and '**' or "-" to read
+ * one path per line from standard input. Paths are handed to a
+ * work-stealing thread pool while they are still being discovered, and
+ * each job writes into its own buffer, which is written out in one piece
+ * when the job finishes so output from different documents never
+ * interleaves.
+ */
+class BatchRunner {
+public:
+    /**
+     * @brief Work done for a single document
+     * @param path Path of the document
+     * @param out Buffer for the document's output
+     * @return true on success; output of failed documents goes to the
+     *         failure stream (stderr unless setFailureStream() changed it)
+     */
+    using Job = std::function<bool(const std::string& path, std::ostream& out)>;
+
+    /**
+     * @brief Summary of a finished batch
+     */
+    struct Result {
+        size_t processed = 0;
+        size_t failed = 0;
+    };
+
+    /**
+     * @brief Construct a new Batch Runner object
+     * @param threadCount Number of worker threads (0 = hardware concurrency)
+     */
+    explicit BatchRunner(size_t threadCount = 0);
+
+    /**
+     * @brief Set where the output of failed documents goes
+     *
+     * Structured formats such as NDJSON keep failures in the same stream
+     * as the other records.
+     * @param out Stream for failed documents (default: std::cerr)
+     */
+    void setFailureStream(std::ostream& out);
+
+    /**
+     * @brief Run a job over every document matched by the inputs
+     * @param inputs Files, directories, patterns or "-"
+     * @param job Job to run for each document
+     * @return Processed and failed counts
+     */
+    Result run(const std::vector<std::string>& inputs, const Job& job);
+
+    /**
+     * @brief Expand inputs into document paths
+     *
+     * Calls onPath for each document as soon as it is found.
+     * @param inputs Files, directories, patterns or "-"
+     * @param onPath Callback receiving each path
+     */
+    static void forEachPath(const std::vector<std::string>& inputs,
+                            const std::function<void(const std::string&)>& onPath);
+
+    /**
+     * @brief Check whether a file name has a known ODF extension
+     * @param path File path
+     * @return true for .odt, .ods, .odp, .odg and friends, flat ones included
+     */
+    static bool hasODFExtension(const std::string& path);
+
+private:
+    size_t threadCount_;
+    std::ostream* failureStream_;
+};
+
+#endif // BATCHRUNNER_H
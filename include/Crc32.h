@@ -0,0 +1,38 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief CRC-32 as used by ZIP archives (the zlib polynomial)
+ *
+ * The implementation is chosen once, at run time: carry-less multiply
+ * folding (PCLMULQDQ) on x86-64 CPUs that have it, the ARMv8 CRC32
+ * instructions on 64-bit ARM, and zlib's crc32() everywhere else. All of
+ * them give the same result, so checksums can be verified against the
+ * ones stored in the central directory.
+ */
+namespace Crc32 {
+
+/**
+ * @brief Extend a CRC with more input
+ *
+ * Same convention as zlib's crc32(): start from 0, and feeding the input
+ * in pieces gives the same result as feeding it at once.
+ * @param crc CRC of the preceding input (0 to start)
+ * @param data Input bytes
+ * @param size Number of bytes
+ * @return CRC of the input so far
+ */
+uint32_t update(uint32_t crc, const void* data, size_t size);
+
+/**
+ * @brief Name of the implementation in use
+ * @return "PCLMULQDQ", "ARMv8 CRC32" or "zlib"
+ */
+const char* instructionSet();
+
+} // namespace Crc32
+
+#endif // CRC32_H
@@ -0,0 +1,89 @@
+#ifndef DOCUMENTCACHE_H
+#define DOCUMENTCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "ODFInspector.h"
+
+/**
+ * @brief In-memory LRU of loaded documents for long-running processes
+ *
+ * Keeps up to a fixed number of ODFInspectors open, with a private copy of
+ * their file, central directory index and whatever core parts they have
+ * already decompressed. The copies are bounded by a byte budget as well
+ * as by the number of documents; least recently used documents go first,
+ * and one larger than the whole budget is served without being kept.
+ * A document is reused only while its file size and
+ * modification time are unchanged; otherwise it is loaded again. Copies
+ * rather than mappings mean a file truncated or rewritten while a request
+ * reads it can't crash the process; the request sees the old version.
+ * This is the in-process counterpart of InspectionCache, which persists
+ * results between runs instead of keeping archives open.
+ *
+ * get() may be called from several threads. Inspectors are handed out as
+ * shared pointers, so one that is evicted or replaced stays valid until
+ * its last user lets go of it.
+ */
+class DocumentCache {
+public:
+    /**
+     * @brief Hit and miss counts since construction
+     */
+    struct Counters {
+        uint64_t hits = 0;
+        uint64_t misses = 0;          // Not cached, or changed on disk
+        uint64_t invalidations = 0;   // Misses because the file changed
+        uint64_t evictions = 0;
+        size_t documents = 0;         // Currently cached
+        uint64_t bytes = 0;           // File bytes held by cached documents
+    };
+
+    /**
+     * @brief Construct a new Document Cache object
+     * @param capacity Maximum number of documents kept open (at least 1)
+     * @param maxBytes Maximum total file size of the documents kept open
+     */
+    DocumentCache(size_t capacity, uint64_t maxBytes);
+
+    /**
+     * @brief Get a loaded inspector for a document
+     *
+     * Loads the document on a miss. Concurrent misses for the same path
+     * may load it twice; only one copy is kept.
+     * @param path Path to the document
+     * @param error Receives the reason if the document can't be loaded
+     * @return Loaded inspector, or nullptr on error
+     */
+    std::shared_ptr<const ODFInspector> get(const std::string& path, std::string& error);
+
+    /**
+     * @brief Get the hit and miss counts
+     * @return Counters
+     */
+    Counters counters() const;
+
+private:
+    struct Slot {
+        std::string path;
+        uint64_t size;
+        int64_t mtime;
+        std::shared_ptr<const ODFInspector> inspector;
+    };
+
+    size_t capacity_;
+    uint64_t maxBytes_;
+    uint64_t bytes_;          // Sum of the cached file sizes
+    mutable std::mutex mutex_;
+    std::list<Slot> slots_;   // Most recently used first
+    std::unordered_map<std::string, std::list<Slot>::iterator> index_;
+    Counters counters_;
+
+    void insert(Slot slot);
+};
+
+#endif // DOCUMENTCACHE_H
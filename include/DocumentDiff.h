@@ -0,0 +1,102 @@
+#ifndef DOCUMENTDIFF_H
+#define DOCUMENTDIFF_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ODFInspector.h"
+#include "XmlDiff.h"
+
+/**
+ * @brief Compares two revisions of a document
+ *
+ * Entries are matched by name and compared by the CRC-32 and size in the
+ * central directories, so nothing is decompressed to find out what
+ * changed. Only XML entries that differ are inflated, built into
+ * XmlTrees and diffed structurally with XmlDiff. Flat documents have no
+ * checksums; their sections are compared byte for byte instead.
+ */
+class DocumentDiff {
+public:
+    enum class EntryState {
+        Identical,
+        Modified,
+        Added,
+        Removed
+    };
+
+    /**
+     * @brief An entry of either document
+     */
+    struct Entry {
+        std::string name;
+        EntryState state = EntryState::Identical;
+        const ZipEntry* before = nullptr;   // nullptr if added
+        const ZipEntry* after = nullptr;    // nullptr if removed
+    };
+
+    /**
+     * @brief Prepare a diff; both inspectors must be loaded and outlive it
+     * @param before Old revision
+     * @param after New revision
+     */
+    DocumentDiff(const ODFInspector& before, const ODFInspector& after);
+
+    /**
+     * @brief Match and compare the entries of both documents
+     * @return false if a flat section could not be read
+     */
+    bool compareEntries();
+
+    /**
+     * @brief Get the entries in the order of the old document, then added ones
+     * @return Entries found by compareEntries()
+     */
+    const std::vector<Entry>& entries() const;
+
+    /**
+     * @brief Check whether the documents differ
+     * @return true if any entry is not identical
+     */
+    bool hasChanges() const;
+
+    /**
+     * @brief Diff the XML of a modified entry
+     * @param entry Modified entry
+     * @param callback Receives each change in document order
+     * @param changes Receives the number of changes found
+     * @return false if either side could not be read or parsed
+     */
+    bool diffEntry(const Entry& entry, const XmlDiff::Callback& callback, size_t& changes) const;
+
+    /**
+     * @brief Write the entry comparison and the diff of every modified XML entry
+     * @param out Stream to write to
+     * @return false if any entry could not be diffed
+     */
+    bool write(std::ostream& out) const;
+
+    /**
+     * @brief Get the last error message
+     * @return Error message string
+     */
+    std::string getLastError() const;
+
+    /**
+     * @brief Check whether an entry holds XML that can be diffed
+     * @param name Entry name
+     * @return true for *.xml entries and flat document sections
+     */
+    static bool isXml(const std::string& name);
+
+private:
+    const ODFInspector& before_;
+    const ODFInspector& after_;
+    std::vector<Entry> entries_;
+    mutable std::string lastError_;
+
+    bool sameContent(const std::string& name) const;
+};
+
+#endif // DOCUMENTDIFF_H
@@ -0,0 +1,106 @@
+#ifndef FLATODF_H
+#define FLATODF_H
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "MappedFile.h"
+
+/**
+ * @brief Section index of a flat XML ODF document (.fodt, .fods, .fodp, ...)
+ *
+ * A flat ODF file is one XML document whose office:document root holds
+ * what a package spreads over meta.xml, styles.xml and content.xml. The
+ * file is mapped and scanned once for the top-level office:meta,
+ * office:styles and office:body elements, which are then handed out as
+ * views into the mapping; nothing is copied.
+ *
+ * office:body is the last child of the root, so the scan stops at its
+ * start tag and takes the end from the tail of the file. Load time
+ * therefore depends on the size of the sections before the body, not on
+ * the body itself. Only files that don't end in the usual way are
+ * scanned to the end.
+ */
+class FlatODF {
+public:
+    enum class Section {
+        Meta,       // office:meta
+        Styles,     // office:styles
+        Body        // office:body
+    };
+
+    static constexpr size_t kSectionCount = 3;
+
+    FlatODF();
+
+    FlatODF(const FlatODF&) = delete;
+    FlatODF& operator=(const FlatODF&) = delete;
+
+    /**
+     * @brief Map a flat ODF file and locate its sections
+     * @param path Path to the file
+     * @param privateCopy Read the file into memory instead of mapping it,
+     *                    see MappedFile::openCopy()
+     * @return true if the file is XML with an office:document root
+     */
+    bool open(const std::string& path, bool privateCopy = false);
+
+    /**
+     * @brief Unmap the file and forget the sections
+     */
+    void close();
+
+    /**
+     * @brief Check if a document is open
+     * @return true if open() succeeded
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Check whether the last file opened looked like XML at all
+     *
+     * Tells a malformed flat document apart from a file of another kind
+     * after open() failed.
+     * @return true if the file starts with markup
+     */
+    bool isXml() const;
+
+    /**
+     * @brief Get the office:mimetype attribute of the root element
+     * @return MIME type, or an empty string if the root has none
+     */
+    const std::string& getMimeType() const;
+
+    /**
+     * @brief Get a section, from its start tag to its end tag inclusive
+     * @param section Section
+     * @return View into the mapping; empty if the document lacks it
+     */
+    std::string_view section(Section section) const;
+
+    /**
+     * @brief Get the element name of a section
+     * @param section Section
+     * @return "office:meta", "office:styles" or "office:body"
+     */
+    static const char* name(Section section);
+
+    /**
+     * @brief Get the last error message
+     * @return Error message string
+     */
+    std::string getLastError() const;
+
+private:
+    MappedFile mapping_;
+    std::string mimeType_;
+    std::array<std::string_view, kSectionCount> sections_;
+    std::string lastError_;
+    bool isOpen_;
+    bool isXml_;
+
+    bool scan();
+};
+
+#endif // FLATODF_H
@@ -0,0 +1,96 @@
+#ifndef INFLATER_H
+#define INFLATER_H
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+/**
+ * @brief One-shot decompressor for raw deflate data of known size
+ *
+ * ZIP central directories record every entry's uncompressed size, so a
+ * whole entry can be inflated in one call straight into its final buffer.
+ * That is the case one-shot inflaters such as libdeflate are built for.
+ * Which backends exist is decided at configure time (ODF_WITH_LIBDEFLATE,
+ * ODF_WITH_ZLIB_NG); zlib is always available. The process-wide default
+ * can be changed at run time, and each ZipReader can override it.
+ *
+ * An Inflater keeps its decompression state between calls and is not
+ * thread-safe; forThread() hands out one instance per thread and backend.
+ */
+class Inflater {
+public:
+    enum class Backend {
+        Zlib,
+        ZlibNg,
+        Libdeflate
+    };
+
+    static constexpr size_t kBackendCount = 3;
+
+    virtual ~Inflater() = default;
+
+    /**
+     * @brief Inflate a complete raw deflate stream
+     * @param in Compressed data
+     * @param inSize Size of the compressed data
+     * @param out Destination buffer
+     * @param outSize Exact uncompressed size
+     * @return true if the stream decoded to exactly outSize bytes
+     */
+    virtual bool inflate(const char* in, size_t inSize, char* out, size_t outSize) = 0;
+
+    /**
+     * @brief Create an inflater
+     * @param backend Backend to use
+     * @return The inflater, or nullptr if the backend was not built in
+     */
+    static std::unique_ptr<Inflater> create(Backend backend);
+
+    /**
+     * @brief Get the calling thread's inflater for a backend
+     *
+     * Created on first use and reused afterwards. The backend must be
+     * available.
+     * @param backend Backend to use
+     * @return Inflater owned by the calling thread
+     */
+    static Inflater& forThread(Backend backend);
+
+    /**
+     * @brief Check whether a backend was built in
+     * @param backend Backend
+     * @return true if create() can return it
+     */
+    static bool isAvailable(Backend backend);
+
+    /**
+     * @brief Get the backend new ZipReaders use
+     * @return Default backend (configured by ODF_DEFAULT_INFLATE)
+     */
+    static Backend getDefault();
+
+    /**
+     * @brief Change the backend new ZipReaders use
+     * @param backend Backend
+     * @return false if the backend is not available
+     */
+    static bool setDefault(Backend backend);
+
+    /**
+     * @brief Get the name of a backend
+     * @param backend Backend
+     * @return "zlib", "zlib-ng" or "libdeflate"
+     */
+    static const char* name(Backend backend);
+
+    /**
+     * @brief Look up a backend by name
+     * @param name Name as returned by name()
+     * @param backend Receives the backend
+     * @return false if the name is unknown
+     */
+    static bool fromName(std::string_view name, Backend& backend);
+};
+
+#endif // INFLATER_H
@@ -0,0 +1,145 @@
+#ifndef INSPECTSTATS_H
+#define INSPECTSTATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Phase timers and counters for the inspection of one document
+ *
+ * ZipReader and ODFInspector take an optional pointer to a stats object
+ * and only touch it when one was set, so disabled instrumentation costs a
+ * null check per event. Updates are relaxed atomic adds, which lets parts
+ * that are inflated in parallel report into the same object.
+ *
+ * Phases are wall-clock times measured with a monotonic clock. They may
+ * nest (Open includes Directory, Output includes anything a view loads
+ * lazily), so they do not add up to Total.
+ */
+class InspectStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Phase {
+        Total,          // Whole document, load to last view
+        Open,           // Opening the archive
+        Directory,      // Parsing the central directory
+        Locate,         // Seeking to entries' data
+        Inflate,        // Reading and decompressing entries
+        Format,         // Pretty-printing XML
+        Text,           // Extracting plain text
+        Parse,          // Parsing meta.xml and manifest.xml
+        Output,         // Producing the requested views
+        Count
+    };
+
+    enum class Counter {
+        Entries,        // Central directory records parsed
+        Lookups,        // Entry lookups by name
+        Seeks,          // Entry data located in the archive
+        BytesInflated,  // Output of deflated entries
+        BytesCopied,    // Stored entries copied into buffers
+        Allocations,    // Entry buffers allocated or grown
+        AllocatedBytes, // Size of those allocations
+        BytesFormatted, // XML consumed by the formatter
+        BytesText,      // XML consumed by the text extractor
+        Count
+    };
+
+    static constexpr size_t kPhaseCount = static_cast<size_t>(Phase::Count);
+    static constexpr size_t kCounterCount = static_cast<size_t>(Counter::Count);
+
+    /**
+     * @brief Times a scope into a phase
+     *
+     * Reads no clock at all when constructed with a null stats pointer.
+     */
+    class Timer {
+    public:
+        Timer(InspectStats* stats, Phase phase)
+            : stats_(stats)
+            , phase_(phase) {
+            if (stats_ != nullptr) {
+                start_ = Clock::now();
+            }
+        }
+
+        ~Timer() {
+            if (stats_ != nullptr) {
+                stats_->addTime(phase_, static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_).count()));
+            }
+        }
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+    private:
+        InspectStats* stats_;
+        Phase phase_;
+        Clock::time_point start_;
+    };
+
+    InspectStats() = default;
+    InspectStats(const InspectStats&) = delete;
+    InspectStats& operator=(const InspectStats&) = delete;
+
+    /**
+     * @brief Add elapsed time to a phase
+     * @param phase Phase
+     * @param nanoseconds Elapsed time
+     */
+    void addTime(Phase phase, uint64_t nanoseconds) {
+        times_[static_cast<size_t>(phase)].fetch_add(nanoseconds, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Increment a counter
+     * @param counter Counter
+     * @param amount Amount to add
+     */
+    void add(Counter counter, uint64_t amount = 1) {
+        counts_[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the accumulated time of a phase
+     * @param phase Phase
+     * @return Time in nanoseconds
+     */
+    uint64_t time(Phase phase) const {
+        return times_[static_cast<size_t>(phase)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the value of a counter
+     * @param counter Counter
+     * @return Counter value
+     */
+    uint64_t count(Counter counter) const {
+        return counts_[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Get the short name of a phase, as used in reports
+     * @param phase Phase
+     * @return Name such as "inflate"
+     */
+    static const char* name(Phase phase);
+
+    /**
+     * @brief Get the short name of a counter, as used in reports
+     * @param counter Counter
+     * @return Name such as "bytesInflated"
+     */
+    static const char* name(Counter counter);
+
+private:
+    std::array<std::atomic<uint64_t>, kPhaseCount> times_ = {};
+    std::array<std::atomic<uint64_t>, kCounterCount> counts_ = {};
+};
+
+#endif // INSPECTSTATS_H
@@ -0,0 +1,120 @@
+#ifndef INSPECTIONCACHE_H
+#define INSPECTIONCACHE_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "MappedFile.h"
+#include "ZipReader.h"
+
+/**
+ * @brief Persistent per-document inspection results
+ *
+ * The cache file is a flat sequence of records, one per document, holding
+ * what the cheap views need: the parsed central directory, the mimetype
+ * and the raw meta.xml. It is memory-mapped on load and only the small
+ * path index is built up front; records are decoded on lookup.
+ *
+ * Records are keyed by absolute path and validated by the caller against
+ * file size, modification time and the central directory checksum.
+ * find() and store() may be called from several threads at once.
+ */
+class InspectionCache {
+public:
+    /**
+     * @brief Cached inspection results of one document
+     */
+    struct Document {
+        uint64_t size = 0;          // File size in bytes
+        int64_t mtime = 0;          // Last write time, in file clock ticks
+        uint32_t directoryCrc = 0;  // ZipReader::directoryChecksum()
+        std::string mimeType;
+        std::vector<ZipEntry> entries;  // Names, sizes, CRCs and methods only
+        std::string metaXml;
+    };
+
+    /**
+     * @brief Construct a cache backed by the given file
+     * @param cachePath Path of the cache file (need not exist yet)
+     */
+    explicit InspectionCache(const std::string& cachePath);
+
+    InspectionCache(const InspectionCache&) = delete;
+    InspectionCache& operator=(const InspectionCache&) = delete;
+
+    /**
+     * @brief Map the cache file and index its records
+     *
+     * A missing file is an empty cache. An unreadable or corrupt file is
+     * reported and the cache starts empty; save() then replaces it.
+     * @return true if the file was missing or loaded cleanly
+     */
+    bool load();
+
+    /**
+     * @brief Write all records to the cache file if anything changed
+     *
+     * The file is written under a temporary name and renamed into place.
+     * Must not be called while other threads use the cache.
+     * @return true if successful
+     */
+    bool save();
+
+    /**
+     * @brief Look up the record of a document
+     * @param path Document path (normalised to an absolute path)
+     * @param document Receives the record
+     * @return true if the cache holds a record for the path
+     */
+    bool find(const std::string& path, Document& document) const;
+
+    /**
+     * @brief Add or replace the record of a document
+     * @param path Document path (normalised to an absolute path)
+     * @param document Record to store
+     */
+    void store(const std::string& path, Document document);
+
+    /**
+     * @brief Get the number of records
+     * @return Record count
+     */
+    size_t size() const;
+
+    /**
+     * @brief Read the file size and modification time records are
+     *        validated against
+     * @param path File path
+     * @param size Receives the size in bytes
+     * @param mtime Receives the last write time, in file clock ticks
+     * @return true if the file could be examined
+     */
+    static bool fileStamp(const std::string& path, uint64_t& size, int64_t& mtime);
+
+    /**
+     * @brief Get the last error message
+     * @return Error message string
+     */
+    std::string getLastError() const;
+
+private:
+    std::string cachePath_;
+    MappedFile mapping_;
+    std::string lastError_;
+    mutable std::mutex mutex_;
+    bool dirty_;
+
+    // Record bytes in the mapping, and records added since load()
+    std::unordered_map<std::string, std::string_view> mapped_;
+    std::unordered_map<std::string, Document> updated_;
+
+    bool indexRecords();
+    static std::string keyFor(const std::string& path);
+    static void encode(const std::string& key, const Document& document, std::string& out);
+    static bool decode(std::string_view record, Document& document);
+};
+
+#endif // INSPECTIONCACHE_H
@@ -0,0 +1,90 @@
+#ifndef INSPECTIONSERVER_H
+#define INSPECTIONSERVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "DocumentCache.h"
+
+/**
+ * @brief Answers inspection requests over a Unix domain socket
+ *
+ * Clients send one request per line, with fields separated by tabs:
+ *
+ *     summary<TAB>path       Text summary, as --summary prints it
+ *     structure<TAB>path     Text structure listing
+ *     metadata<TAB>path      Text metadata
+ *     json<TAB>path          JSON record with summary, structure and metadata
+ *     file<TAB>path<TAB>entry  Raw bytes of one entry
+ *     stats                  Document cache counters
+ *
+ * Every response starts with a status line: "OK <length>" followed by
+ * exactly length bytes of payload, or "ERROR <message>". A connection may
+ * carry any number of requests; it is served by one worker of a thread
+ * pool until the client closes it or stays idle too long.
+ *
+ * Documents stay open in a DocumentCache between requests, so a repeated
+ * query costs a stat() and the formatting of the answer rather than
+ * opening the archive and parsing its central directory again.
+ */
+class InspectionServer {
+public:
+    /**
+     * @brief Construct a new Inspection Server object
+     * @param socketPath Path of the socket to create
+     * @param threadCount Number of worker threads (0 = hardware concurrency)
+     * @param cacheCapacity Number of documents kept open
+     * @param cacheBytes Total file size of the documents kept open
+     */
+    InspectionServer(const std::string& socketPath, size_t threadCount, size_t cacheCapacity,
+                     uint64_t cacheBytes);
+
+    /**
+     * @brief Close the socket and remove its file
+     */
+    ~InspectionServer();
+
+    InspectionServer(const InspectionServer&) = delete;
+    InspectionServer& operator=(const InspectionServer&) = delete;
+
+    /**
+     * @brief Create the socket and start listening
+     *
+     * A stale socket file left by a previous run is replaced; one that
+     * another server is still listening on is not.
+     * @return true if successful, false otherwise
+     */
+    bool start();
+
+    /**
+     * @brief Accept and serve connections until stop() is called
+     */
+    void run();
+
+    /**
+     * @brief Make run() return after the connections in progress
+     *
+     * Only sets a flag, so it may be called from a signal handler.
+     */
+    void stop();
+
+    /**
+     * @brief Get the last error message
+     * @return Error message string
+     */
+    std::string getLastError() const;
+
+private:
+    std::string socketPath_;
+    size_t threadCount_;
+    DocumentCache cache_;
+    int listenFd_;
+    std::atomic<bool> stopping_;
+    std::string lastError_;
+
+    void serveConnection(int fd);
+    bool handleRequest(int fd, const std::string& line);
+};
+
+#endif // INSPECTIONSERVER_H
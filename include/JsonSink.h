@@ -0,0 +1,85 @@
+#ifndef JSONSINK_H
+#define JSONSINK_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "OutputSink.h"
+
+/**
+ * @brief Writes one compact JSON object per document (NDJSON)
+ *
+ * Records are serialised straight into a byte buffer that is handed to
+ * the stream in large blocks, so output costs no per-field stream calls,
+ * locale lookups or flushes. A single document is a valid JSON text; a
+ * batch is newline-delimited JSON. Strings are escaped per RFC 8259 and
+ * otherwise passed through as UTF-8.
+ */
+class JsonSink : public OutputSink {
+public:
+    /**
+     * @brief Buffered bytes above which a finished document is written out
+     */
+    static constexpr size_t kFlushThreshold = 1024 * 1024;
+
+    /**
+     * @brief Construct a sink with its own buffer
+     * @param out Stream to write to
+     */
+    explicit JsonSink(std::ostream& out);
+
+    /**
+     * @brief Construct a sink on a caller-owned buffer
+     *
+     * Lets short-lived sinks (one per batch job) reuse one grown buffer
+     * per thread instead of allocating a new one per document.
+     * @param out Stream to write to
+     * @param buffer Scratch buffer; cleared, but its capacity is kept
+     */
+    JsonSink(std::ostream& out, std::string& buffer);
+
+    /**
+     * @brief Destroy the sink, writing out anything still buffered
+     */
+    ~JsonSink() override;
+
+    JsonSink(const JsonSink&) = delete;
+    JsonSink& operator=(const JsonSink&) = delete;
+
+    void beginDocument(std::string_view path) override;
+    void endDocument() override;
+    void summary(const Summary& summary) override;
+    void structure(const std::vector<ZipEntry>& entries) override;
+    void metadata(const ODFMetadata* metadata) override;
+    void images(const std::vector<const ZipEntry*>& images) override;
+    void tables(const std::vector<TableScanner::SheetStats>& sheets) override;
+    void error(std::string_view message) override;
+    void stats(const InspectStats& stats) override;
+
+    /**
+     * @brief Write buffered output to the stream
+     */
+    void flush();
+
+    /**
+     * @brief Drop output not yet written to the stream
+     *
+     * For a document that failed halfway, whose record would otherwise
+     * be written out unfinished.
+     */
+    void discard();
+
+private:
+    std::ostream& out_;
+    std::string ownBuffer_;
+    std::string& buffer_;
+
+    void key(std::string_view name);
+    void string(std::string_view value);
+    void number(uint64_t value);
+    void boolean(bool value);
+    void field(std::string_view name, std::string_view value);
+    void entry(const ZipEntry& entry);
+};
+
+#endif // JSONSINK_H
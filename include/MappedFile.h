@@ -0,0 +1,89 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * Wraps mmap() on POSIX systems and CreateFileMapping/MapViewOfFile on
+ * Windows. The mapping stays valid until close() or destruction, so views
+ * handed out by users of this class must not outlive it.
+ *
+ * openCopy() reads the file into a private buffer instead, behind the same
+ * interface. A mapping faults (SIGBUS on POSIX) when the file is truncated
+ * while it is being read; a copy is unaffected by later changes.
+ */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Map a file into memory for reading
+     * @param path Path to the file
+     * @return true if successful, false otherwise
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Read a file into a private buffer instead of mapping it
+     * @param path Path to the file
+     * @return true if successful, false otherwise
+     */
+    bool openCopy(const std::string& path);
+
+    /**
+     * @brief Unmap the file
+     */
+    void close();
+
+    /**
+     * @brief Check if a file is currently mapped
+     * @return true if mapped, false otherwise
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Get a pointer to the start of the mapping
+     * @return Pointer to the mapped bytes (nullptr for empty files)
+     */
+    const char* data() const;
+
+    /**
+     * @brief Get the size of the mapping
+     * @return Size in bytes
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get the whole mapping as a view
+     * @return View over the mapped bytes
+     */
+    std::string_view view() const;
+
+    /**
+     * @brief Get the last error message
+     * @return Error message string
+     */
+    std::string getLastError() const;
+
+private:
+    const char* data_;
+    size_t size_;
+    bool isOpen_;
+    std::vector<char> copy_;   // Backing store after openCopy()
+    std::string lastError_;
+#ifdef _WIN32
+    void* fileHandle_;     // HANDLE
+    void* mappingHandle_;  // HANDLE
+#endif
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,113 @@
+#ifndef MEDIADEDUP_H
+#define MEDIADEDUP_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ODFInspector.h"
+
+/**
+ * @brief Finds identical embedded images across many documents
+ *
+ * The CRC-32 and size every central directory records serve as a free
+ * prefilter: media whose CRC and size occur once in the corpus are never
+ * decompressed. When a second copy shows up, both are streamed through
+ * XXH64 to confirm they really are identical; the first copy is re-read
+ * from its document once, and later copies only hash themselves.
+ *
+ * Memory grows with the number of distinct media, not with the number of
+ * copies or documents: each distinct CRC and size keeps the location of
+ * its first copy and one counter per confirmed content. add() may be
+ * called from several threads.
+ */
+class MediaDedup {
+public:
+    /**
+     * @brief A set of identical media
+     */
+    struct Group {
+        std::string document;       // Document with the first copy
+        std::string entry;          // Entry name of the first copy
+        uint64_t size = 0;          // Uncompressed size of one copy
+        uint32_t crc32 = 0;
+        uint64_t hash = 0;          // XXH64 of the content
+        uint64_t copies = 0;
+        uint64_t storedBytes = 0;   // Compressed size of all copies
+        uint64_t smallestStored = 0; // Compressed size of the smallest copy
+    };
+
+    /**
+     * @brief Add the images of one loaded document
+     * @param path Path the document was loaded from (used to re-read it)
+     * @param inspector Loaded inspector for the document
+     * @return false if an image, or the earlier copy it is compared with,
+     *         could not be read; the rest are still added
+     */
+    bool add(const std::string& path, const ODFInspector& inspector);
+
+    /**
+     * @brief Get the media that occur more than once
+     * @return Groups of two or more copies, most reclaimable bytes first
+     */
+    std::vector<Group> duplicates() const;
+
+    /**
+     * @brief Write the dedup report
+     * @param out Stream to write to
+     */
+    void write(std::ostream& out) const;
+
+    /**
+     * @brief Get the last error message
+     * @return Error message string
+     */
+    std::string getLastError() const;
+
+private:
+    struct Key {
+        uint32_t crc32;
+        uint64_t size;
+
+        bool operator==(const Key& other) const {
+            return crc32 == other.crc32 && size == other.size;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return static_cast<size_t>(key.size * 0x9E3779B97F4A7C15ull) ^ key.crc32;
+        }
+    };
+
+    // Media with one CRC and size. Contents are only told apart once a
+    // second copy makes it necessary.
+    struct Candidate {
+        std::string document;
+        std::string entry;
+        uint64_t storedBytes = 0;   // Compressed size of the first copy
+        bool hashing = false;       // First copy is being hashed
+        bool hashed = false;        // variants holds the first copy
+        std::vector<Group> variants;
+    };
+
+    mutable std::mutex mutex_;
+    std::condition_variable hashed_;
+    std::unordered_map<Key, Candidate, KeyHash> candidates_;
+    uint64_t documents_ = 0;
+    uint64_t media_ = 0;
+    uint64_t mediaBytes_ = 0;
+    uint64_t hashedEntries_ = 0;
+    uint64_t hashedBytes_ = 0;
+    std::string lastError_;
+
+    bool hashEntry(const ODFInspector& inspector, const std::string& entry, uint64_t& hash);
+    bool hashFirstCopy(const std::string& path, const ODFInspector& inspector,
+                       const std::string& document, const std::string& entry, uint64_t& hash);
+};
+
+#endif // MEDIADEDUP_H
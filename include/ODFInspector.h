@@ -1,12 +1,27 @@
 #ifndef ODFINSPECTOR_H
 #define ODFINSPECTOR_H
 
+#include <array>
+#include <deque>
+#include <functional>
+#include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
 #include <memory>
+#include <mutex>
+#include "FlatODF.h"
+#include "InspectionCache.h"
+#include "InspectStats.h"
+#include "ODFMetadata.h"
+#include "OutputSink.h"
+#include "TableScanner.h"
+#include "TextExtractor.h"
+#include "XmlTree.h"
 #include "ZipReader.h"
 
+class XmlFormatter;
+
 /**
  * @brief Main class for inspecting ODF (Open Document Format) files
  * 
@@ -15,9 +30,47 @@
  * - Extract and display metadata
  * - Show document content
  * - List embedded resources
+ *
+ * Flat XML documents (.fodt, .fods, ...) are read through FlatODF. Their
+ * office:meta, office:styles and office:body sections stand in for
+ * meta.xml, styles.xml and content.xml, and are listed as the entries.
  */
 class ODFInspector {
 public:
+    /**
+     * @brief Core XML parts of an ODF package
+     */
+    enum class Part {
+        Content,    // content.xml
+        Meta,       // meta.xml
+        Styles,     // styles.xml
+        Manifest    // META-INF/manifest.xml
+    };
+
+    static constexpr size_t kPartCount = 4;
+
+    /**
+     * @brief Basic facts about a loaded document
+     */
+    struct Info {
+        std::string_view path;
+        std::string_view mimeType;
+        std::string_view documentType;
+        bool valid = false;
+        bool flat = false;          // Flat XML document rather than a package
+        size_t entryCount = 0;
+    };
+
+    /**
+     * @brief One manifest:file-entry of META-INF/manifest.xml
+     */
+    struct ManifestEntry {
+        std::string_view fullPath;
+        std::string_view mediaType;
+        std::string_view version;
+        bool encrypted = false;     // Has manifest:encryption-data
+    };
+
     /**
      * @brief Construct a new ODF Inspector object
      * @param odfPath Path to the ODF file
@@ -31,56 +84,285 @@ public:
 
     /**
      * @brief Load and validate the ODF file
+     *
+     * Only the archive index and the mimetype are read here. The core XML
+     * parts are decompressed lazily by the views that need them. Files
+     * that are not ZIP archives are tried as flat ODF.
+     *
+     * With a cache set, an unchanged document is answered from its cache
+     * record and the archive is only opened by views that need more than
+     * the directory and meta.xml.
      * @return true if successful, false otherwise
      */
     bool load();
 
+    /**
+     * @brief Consult and update a persistent cache in load()
+     *
+     * A record is used when the file size and modification time match.
+     * Otherwise the archive is opened; if only the timestamp changed (same
+     * directory checksum) the record is reused, and meta.xml is only
+     * re-inflated when its own entry changed. The cache is not owned and
+     * may be shared by inspectors on several threads. Flat documents are
+     * not cached; they have nothing to decompress.
+     * @param cache Cache to use, or nullptr for none
+     */
+    void setCache(InspectionCache* cache);
+
+    /**
+     * @brief Report timings and counters into a stats object
+     *
+     * Passed on to the archive reader; the inspector itself adds XML
+     * formatting, text extraction and parsing. Set it before load(). The stats object is
+     * not owned and must outlive the inspector's use of it.
+     * @param stats Stats to update, or nullptr to disable (the default)
+     */
+    void setStats(InspectStats* stats);
+
+    /**
+     * @brief Read the document into memory instead of mapping it
+     *
+     * For inspectors kept open for long, like those of a DocumentCache:
+     * a file truncated while its mapping is read would crash the process.
+     * Set it before load().
+     * @param copy true to copy, false to map (the default)
+     */
+    void setPrivateCopy(bool copy);
+
+    /**
+     * @brief Free the cached XML parts
+     *
+     * Parts that are needed again afterwards are re-read from the archive.
+     * Must not be called while another thread is using the inspector.
+     */
+    void releaseParts();
+
+    /**
+     * @brief Set how many threads may decompress entries of this document
+     * @param threadCount Thread count (0 = hardware concurrency, 1 = serial)
+     */
+    void setThreadCount(size_t threadCount);
+
+    /**
+     * @brief Decompress several core parts ahead of use, in parallel
+     *
+     * Independent parts are inflated on separate threads when the archive
+     * supports concurrent reads and more than one thread is allowed.
+     * @param parts Parts that are about to be needed
+     */
+    void prefetchParts(const std::vector<Part>& parts) const;
+
+    /**
+     * @brief Extract every entry of the archive into a directory
+     *
+     * Entries are decompressed in parallel and streamed to disk, so memory
+     * use stays bounded regardless of entry size.
+     * @param outputDir Directory to write to (created if needed)
+     * @param out Stream for the progress report
+     * @return true if every entry was written
+     */
+    bool extractAll(const std::string& outputDir, std::ostream& out = std::cout) const;
+
+    /**
+     * @brief Stream the plain text of the document body
+     *
+     * content.xml is fed through a TextExtractor chunk by chunk as it is
+     * inflated, so memory use does not grow with the document. A body
+     * that is already in memory (flat documents, prefetched parts) is
+     * read in place.
+     * @param writer Callback receiving the text in order
+     * @return false if content.xml could not be read
+     */
+    bool extractText(const TextExtractor::Writer& writer) const;
+
+    /**
+     * @brief Stream the tables of the document body through a scanner
+     *
+     * Like extractText(), content.xml is fed as it is inflated. Repeated
+     * rows and cells are never expanded, so a sheet declaring a million
+     * rows costs no more than its XML. The scanner's sheets() and row
+     * callback carry the results.
+     * @param scanner Scanner to feed; finish() is called on it
+     * @return false if content.xml could not be read
+     */
+    bool scanTables(TableScanner& scanner) const;
+
+    /**
+     * @brief Report the document summary to a sink
+     * @param sink Sink receiving the record
+     */
+    void writeSummary(OutputSink& sink) const;
+
+    /**
+     * @brief Report the archive entries to a sink
+     * @param sink Sink receiving the record
+     */
+    void writeStructure(OutputSink& sink) const;
+
+    /**
+     * @brief Report the parsed meta.xml to a sink
+     * @param sink Sink receiving the record
+     */
+    void writeMetadata(OutputSink& sink) const;
+
+    /**
+     * @brief Report the embedded images to a sink
+     * @param sink Sink receiving the record
+     */
+    void writeImages(OutputSink& sink) const;
+
+    /**
+     * @brief Report the per-table statistics of content.xml to a sink
+     * @param sink Sink receiving the record
+     */
+    void writeTables(OutputSink& sink) const;
+
     /**
      * @brief Display a summary of the ODF file
+     * @param out Stream to write to
      */
-    void displaySummary() const;
+    void displaySummary(std::ostream& out = std::cout) const;
 
     /**
      * @brief Display the file structure
+     * @param out Stream to write to
      */
-    void displayStructure() const;
+    void displayStructure(std::ostream& out = std::cout) const;
 
     /**
      * @brief Display metadata from meta.xml
+     * @param out Stream to write to
      */
-    void displayMetadata() const;
+    void displayMetadata(std::ostream& out = std::cout) const;
 
     /**
      * @brief Display content preview from content.xml
+     * @param out Stream to write to
+     */
+    void displayContent(std::ostream& out = std::cout) const;
+
+    /**
+     * @brief Display the plain text of the document body
+     * @param out Stream to write to
+     */
+    void displayText(std::ostream& out = std::cout) const;
+
+    /**
+     * @brief Display the headings, slides and sheets of the document
+     * @param out Stream to write to
      */
-    void displayContent() const;
+    void displayOutline(std::ostream& out = std::cout) const;
+
+    /**
+     * @brief Display the size, used range and cell types of each table
+     * @param out Stream to write to
+     */
+    void displayTables(std::ostream& out = std::cout) const;
 
     /**
      * @brief Display styles information from styles.xml
+     * @param out Stream to write to
      */
-    void displayStyles() const;
+    void displayStyles(std::ostream& out = std::cout) const;
 
     /**
      * @brief Display the manifest file
+     * @param out Stream to write to
      */
-    void displayManifest() const;
+    void displayManifest(std::ostream& out = std::cout) const;
 
     /**
      * @brief Extract a specific file and display its content
      * @param filename Name of the file to extract
+     * @param out Stream to write to
      */
-    void displayFile(const std::string& filename) const;
+    void displayFile(const std::string& filename, std::ostream& out = std::cout) const;
 
     /**
      * @brief List all embedded images
+     * @param out Stream to write to
+     */
+    void listImages(std::ostream& out = std::cout) const;
+
+    // Query API for embedding the inspector. Results are structs,
+    // references and views into buffers the inspector owns, so nothing is
+    // formatted or copied per call. Parts are parsed once on first use
+    // (thread-safe); results stay valid until releaseParts() or destruction.
+
+    /**
+     * @brief Get the basic document facts
+     * @return Info with views into the inspector
+     */
+    Info getInfo() const;
+
+    /**
+     * @brief Get every archive entry in central directory order
+     * @return Entries with names, sizes, CRC-32 and compression method
+     */
+    const std::vector<ZipEntry>& getEntries() const;
+
+    /**
+     * @brief Look up one archive entry
+     * @param name Entry name
+     * @return Pointer to the entry, or nullptr if it doesn't exist
+     */
+    const ZipEntry* findEntry(const std::string& name) const;
+
+    /**
+     * @brief Read the whole content of an entry
+     *
+     * Stored entries of a mapped archive and sections of a flat document
+     * are returned in place; anything else is inflated into the buffer.
+     * @param name Entry name (for flat documents, a section name)
+     * @param buffer Scratch buffer that may receive the content
+     * @param data Receives the content; valid while buffer and the
+     *        inspector are
+     * @return false if the entry doesn't exist or could not be read
+     */
+    bool readEntry(const std::string& name, std::string& buffer, std::string_view& data) const;
+
+    /**
+     * @brief Stream an entry in bounded chunks
+     * @param name Entry name (for flat documents, a section name)
+     * @param onChunk Callback invoked for each chunk, in order
+     * @return false if the entry doesn't exist or could not be read
+     */
+    bool streamEntry(const std::string& name, const ZipReader::ChunkCallback& onChunk) const;
+
+    /**
+     * @brief Get the embedded images (entries under Pictures/ or images/)
+     * @return Pointers into getEntries()
      */
-    void listImages() const;
+    std::vector<const ZipEntry*> getImages() const;
+
+    /**
+     * @brief Get the parsed meta.xml
+     * @return Metadata (empty if the document has no meta.xml)
+     */
+    const ODFMetadata& getMetadata() const;
+
+    /**
+     * @brief Get the parsed META-INF/manifest.xml
+     * @return Manifest entries in document order
+     */
+    const std::vector<ManifestEntry>& getManifest() const;
+
+    /**
+     * @brief Get the element tree of a core part
+     *
+     * Built on first use over the part's buffer (for flat documents, over
+     * the section in the mapping) and freed by releaseParts(). Views into
+     * it stay valid until then.
+     * @param part Part to build the tree of
+     * @return Tree; empty if the part is missing or malformed
+     */
+    const XmlTree& getTree(Part part) const;
 
     /**
      * @brief Get the MIME type of the document
      * @return MIME type string
      */
-    std::string getMimeType() const;
+    const std::string& getMimeType() const;
 
     /**
      * @brief Get the document type (text, spreadsheet, presentation, etc.)
@@ -105,21 +387,62 @@ private:
     std::unique_ptr<ZipReader> zipReader_;
     std::string mimeType_;
     mutable std::string lastError_;
+    mutable std::mutex errorMutex_;   // Failing const calls may run concurrently
     bool isLoaded_;
 
-    // Key ODF file contents
-    std::string contentXml_;
-    std::string metaXml_;
-    std::string stylesXml_;
-    std::string manifestXml_;
+    // Key ODF file contents, decompressed on first use
+    mutable std::string contentXml_;
+    mutable std::string metaXml_;
+    mutable std::string stylesXml_;
+    mutable std::string manifestXml_;
+    mutable unsigned loadedParts_;  // Bit set of Part values already read
+    mutable std::mutex partsMutex_;
+    size_t threadCount_;
+    InspectionCache* cache_;
+    InspectStats* stats_;
+    bool privateCopy_;
+
+    // Directory of a document answered from the cache; the archive itself
+    // is opened on first use
+    bool fromCache_;
+    std::vector<ZipEntry> cachedEntries_;
+    mutable std::mutex archiveMutex_;
+
+    // Flat XML document; parts are views into its mapping and the
+    // sections it found are reported as entries
+    std::unique_ptr<FlatODF> flat_;
+    std::vector<ZipEntry> sectionEntries_;
+
+    // Parsed parts handed out by the query API
+    mutable ODFMetadata metadata_;
+    mutable std::vector<ManifestEntry> manifest_;
+    mutable std::deque<std::string> decodedStrings_;  // Manifest values that had entities
+    mutable std::array<XmlTree, kPartCount> trees_;
+    mutable bool metadataParsed_;
+    mutable bool manifestParsed_;
+    mutable unsigned builtTrees_;   // Bit set of Part values with a tree
+    mutable std::mutex queryMutex_;
 
     // Helper methods
+    void setError(const std::string& message) const;
     bool validateODF();
-    bool extractCoreFiles();
-    std::string formatXML(const std::string& xml) const;
-    std::string extractTextFromXML(const std::string& xml) const;
-    std::map<std::string, std::string> parseMetadata() const;
-    std::string getDocTypeFromMime(const std::string& mime) const;
+    bool loadFlat();
+    bool loadFromCache(InspectionCache::Document& record, bool& haveRecord);
+    void updateCache(const InspectionCache::Document* previous);
+    bool ensureArchive() const;
+    const std::vector<ZipEntry>& archiveEntries() const;
+    const ZipEntry* findArchiveEntry(const std::string& name) const;
+    std::string_view loadPart(Part part) const;
+    bool streamPart(Part part, const std::function<bool(std::string_view)>& feed,
+                    size_t chunkSize = ZipReader::kDefaultChunkSize) const;
+    bool previewPart(Part part, XmlFormatter& formatter) const;
+    uint64_t partSize(Part part) const;
+    std::string& partBuffer(Part part) const;
+    bool hasPart(Part part) const;
+    static const char* partPath(Part part);
+    std::string formatXML(std::string_view xml) const;
+    void runFormatter(XmlFormatter& formatter, std::string_view xml) const;
+    static const char* getDocTypeFromMime(std::string_view mime);
 };
 
 #endif // ODFINSPECTOR_H
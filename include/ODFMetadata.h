@@ -0,0 +1,104 @@
+#ifndef ODFMETADATA_H
+#define ODFMETADATA_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Typed contents of an ODF meta.xml (office:meta)
+ *
+ * Covers the Dublin Core elements and every element of the ODF 1.3 meta
+ * vocabulary. Text is stored with entities decoded; optional numbers are
+ * empty when the document doesn't carry them.
+ */
+struct ODFMetadata {
+    // Dublin Core
+    std::string title;          // dc:title
+    std::string description;    // dc:description
+    std::string subject;        // dc:subject
+    std::string creator;        // dc:creator
+    std::string date;           // dc:date (last modification)
+    std::string language;       // dc:language
+
+    // ODF meta elements
+    std::string generator;      // meta:generator
+    std::string initialCreator; // meta:initial-creator
+    std::string creationDate;   // meta:creation-date
+    std::string printedBy;      // meta:printed-by
+    std::string printDate;      // meta:print-date
+    std::vector<std::string> keywords;          // meta:keyword, in order
+    std::optional<uint64_t> editingCycles;      // meta:editing-cycles
+    std::string editingDuration;                // meta:editing-duration (ISO 8601)
+    std::optional<uint64_t> editingSeconds;     // editingDuration in seconds
+
+    struct Template {           // meta:template
+        std::string href;
+        std::string title;
+        std::string date;
+    } templateInfo;
+
+    struct AutoReload {         // meta:auto-reload
+        std::string href;
+        std::string delay;
+    } autoReload;
+
+    struct HyperlinkBehaviour { // meta:hyperlink-behaviour
+        std::string targetFrameName;
+        std::string show;
+    } hyperlinkBehaviour;
+
+    struct DocumentStatistic {  // meta:document-statistic attributes
+        std::optional<uint64_t> pageCount;
+        std::optional<uint64_t> tableCount;
+        std::optional<uint64_t> drawCount;
+        std::optional<uint64_t> imageCount;
+        std::optional<uint64_t> oleObjectCount;
+        std::optional<uint64_t> objectCount;
+        std::optional<uint64_t> paragraphCount;
+        std::optional<uint64_t> wordCount;
+        std::optional<uint64_t> characterCount;
+        std::optional<uint64_t> nonWhitespaceCharacterCount;
+        std::optional<uint64_t> rowCount;
+        std::optional<uint64_t> frameCount;
+        std::optional<uint64_t> sentenceCount;
+        std::optional<uint64_t> syllableCount;
+        std::optional<uint64_t> cellCount;
+    } statistics;
+
+    struct UserDefined {        // meta:user-defined
+        std::string name;
+        std::string valueType;
+        std::string value;
+    };
+    std::vector<UserDefined> userDefined;
+
+    /**
+     * @brief Parse meta.xml (or an office:meta fragment) in a single pass
+     * @param xml Raw XML
+     * @param metadata Receives the fields; reset first
+     * @return true if the XML was well-formed up to the end
+     */
+    static bool parse(std::string_view xml, ODFMetadata& metadata);
+
+    /**
+     * @brief Convert an ISO 8601 duration (PnYnMnDTnHnMnS) to seconds
+     *
+     * Years and months are counted as 365 and 30 days.
+     * @param duration Duration text
+     * @param seconds Receives the whole seconds
+     * @return true if the text was a valid duration of at most 2^64 - 1
+     *         seconds
+     */
+    static bool parseDuration(std::string_view duration, uint64_t& seconds);
+
+    /**
+     * @brief Check whether no field was found
+     * @return true if nothing is set
+     */
+    bool empty() const;
+};
+
+#endif // ODFMETADATA_H
@@ -0,0 +1,94 @@
+#ifndef OUTPUTSINK_H
+#define OUTPUTSINK_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include "InspectStats.h"
+#include "ODFMetadata.h"
+#include "TableScanner.h"
+#include "ZipReader.h"
+
+/**
+ * @brief Receives inspection results as structured records
+ *
+ * ODFInspector reports each view to a sink instead of formatting it
+ * itself; the sink decides on the representation (human-readable text,
+ * JSON, ...). A document's records arrive between beginDocument() and
+ * endDocument(), in the order the views were requested.
+ */
+class OutputSink {
+public:
+    /**
+     * @brief Document overview reported by the summary view
+     */
+    struct Summary {
+        std::string_view path;
+        std::string_view mimeType;
+        std::string_view documentType;
+        bool valid = false;
+        bool flat = false;          // Flat XML; fileCount counts sections
+        size_t fileCount = 0;
+        bool hasContent = false;
+        bool hasMeta = false;
+        bool hasStyles = false;
+        bool hasManifest = false;
+    };
+
+    virtual ~OutputSink() = default;
+
+    /**
+     * @brief Start the records of a document
+     * @param path Path of the document
+     */
+    virtual void beginDocument(std::string_view path) = 0;
+
+    /**
+     * @brief Finish the records of the current document
+     */
+    virtual void endDocument() = 0;
+
+    /**
+     * @brief Report the document summary
+     * @param summary Summary record
+     */
+    virtual void summary(const Summary& summary) = 0;
+
+    /**
+     * @brief Report the archive entries in directory order
+     * @param entries Archive entries
+     */
+    virtual void structure(const std::vector<ZipEntry>& entries) = 0;
+
+    /**
+     * @brief Report the document metadata
+     * @param metadata Parsed meta.xml, or nullptr if the document has none
+     */
+    virtual void metadata(const ODFMetadata* metadata) = 0;
+
+    /**
+     * @brief Report the embedded images
+     * @param images Image entries (may be empty)
+     */
+    virtual void images(const std::vector<const ZipEntry*>& images) = 0;
+
+    /**
+     * @brief Report the tables (spreadsheet sheets) of the document body
+     * @param sheets Statistics per table in document order (may be empty)
+     */
+    virtual void tables(const std::vector<TableScanner::SheetStats>& sheets) = 0;
+
+    /**
+     * @brief Report a problem with the current document or view
+     * @param message Error message
+     */
+    virtual void error(std::string_view message) = 0;
+
+    /**
+     * @brief Report the phase timings and counters of the document
+     * @param stats Stats gathered while inspecting it
+     */
+    virtual void stats(const InspectStats& stats) = 0;
+};
+
+#endif // OUTPUTSINK_H
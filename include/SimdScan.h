@@ -0,0 +1,52 @@
+#ifndef SIMDSCAN_H
+#define SIMDSCAN_H
+
+#include <cstddef>
+
+/**
+ * @brief Vectorised byte scanners for the XML hot loops
+ *
+ * Each function returns a pointer to the first matching byte in
+ * [begin, end), or end if there is none. The implementation is chosen at
+ * compile time: AVX2 when the compiler targets it (see ODF_ENABLE_AVX2 in
+ * CMakeLists.txt), SSE2 on any x86-64 build, and a portable scalar loop
+ * everywhere else.
+ */
+namespace SimdScan {
+
+/**
+ * @brief Find the first occurrence of a byte
+ */
+const char* findByte(const char* begin, const char* end, char c);
+
+/**
+ * @brief Find the first occurrence of either of two bytes
+ */
+const char* findEither(const char* begin, const char* end, char a, char b);
+
+/**
+ * @brief Find the first occurrence of any of three bytes
+ */
+const char* findAnyOf3(const char* begin, const char* end, char a, char b, char c);
+
+/**
+ * @brief Count the occurrences of a byte
+ * @return Number of bytes in [begin, end) equal to c
+ */
+size_t countByte(const char* begin, const char* end, char c);
+
+/**
+ * @brief Find the first whitespace that XML text collapsing would change:
+ *        a tab, CR or LF, or a space followed by another space
+ */
+const char* findSpaceRun(const char* begin, const char* end);
+
+/**
+ * @brief Name of the instruction set compiled in
+ * @return "AVX2", "SSE2" or "scalar"
+ */
+const char* instructionSet();
+
+} // namespace SimdScan
+
+#endif // SIMDSCAN_H
@@ -0,0 +1,56 @@
+#ifndef STATSAGGREGATE_H
+#define STATSAGGREGATE_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include "InspectStats.h"
+
+/**
+ * @brief Combines the stats of many documents into latency histograms
+ *
+ * Each phase keeps a histogram of per-document times in power-of-two
+ * microsecond buckets, so percentiles are approximate (reported as the
+ * upper bound of their bucket) but memory stays constant however many
+ * documents a batch holds. add() may be called from several threads.
+ */
+class StatsAggregate {
+public:
+    /**
+     * @brief Number of histogram buckets; the last one is open-ended
+     */
+    static constexpr size_t kBucketCount = 32;
+
+    /**
+     * @brief Add the stats of one finished document
+     * @param stats Document stats
+     */
+    void add(const InspectStats& stats);
+
+    /**
+     * @brief Write totals, percentiles and histograms as text
+     * @param out Stream to write to
+     */
+    void write(std::ostream& out) const;
+
+private:
+    struct PhaseHistogram {
+        std::array<uint64_t, kBucketCount> buckets = {};
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+    };
+
+    mutable std::mutex mutex_;
+    uint64_t documents_ = 0;
+    std::array<PhaseHistogram, InspectStats::kPhaseCount> phases_;
+    std::array<uint64_t, InspectStats::kCounterCount> counters_ = {};
+
+    static size_t bucketFor(uint64_t nanoseconds);
+    static uint64_t bucketLimitUs(size_t bucket);
+    static std::string bucketLabel(size_t bucket);
+    uint64_t percentileUs(const PhaseHistogram& histogram, double fraction) const;
+};
+
+#endif // STATSAGGREGATE_H
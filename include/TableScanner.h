@@ -0,0 +1,175 @@
+#ifndef TABLESCANNER_H
+#define TABLESCANNER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class XmlTokenizer;
+
+/**
+ * @brief Streaming reader of the tables in content.xml
+ *
+ * Walks the top-level table:table elements of a document and reports
+ * their rows run-length encoded, exactly as the XML stores them: a row
+ * with table:number-rows-repeated="1048000" is one Row with that repeat
+ * count, and its cells are CellRuns carrying table:number-columns-repeated.
+ * Nothing is ever expanded, so time and memory depend on the size of the
+ * XML, not on the number of logical cells. Per-sheet statistics (extent,
+ * used range, cell types) are gathered along the way.
+ *
+ * Input is fed in arbitrary chunks, like XmlFormatter; only markup cut by
+ * a chunk boundary is carried over, up to XmlTokenizer::kMaxCarryOver
+ * bytes. Tables nested inside cells count as content of the outer cell.
+ */
+class TableScanner {
+public:
+    enum class CellType {
+        Empty,      // No value type and no text
+        Float,
+        Percentage,
+        Currency,
+        Date,
+        Time,
+        Boolean,
+        String,     // office:value-type="string", or text without a type
+        Count
+    };
+
+    static constexpr size_t kCellTypeCount = static_cast<size_t>(CellType::Count);
+
+    /**
+     * @brief A cell, or a run of identical cells
+     */
+    struct CellRun {
+        uint64_t column = 0;        // Zero-based column of the first cell
+        uint64_t repeat = 1;        // table:number-columns-repeated
+        CellType type = CellType::Empty;
+        bool covered = false;       // table:covered-table-cell
+        bool formula = false;       // Has table:formula
+    };
+
+    /**
+     * @brief A row, or a run of identical rows
+     */
+    struct Row {
+        uint64_t row = 0;           // Zero-based row of the first row
+        uint64_t repeat = 1;        // table:number-rows-repeated
+        const CellRun* cells = nullptr;
+        size_t cellCount = 0;
+    };
+
+    /**
+     * @brief Statistics of one sheet (top-level table)
+     */
+    struct SheetStats {
+        std::string name;
+        uint64_t rows = 0;          // Logical rows, repeats included
+        uint64_t columns = 0;       // Widest row or column declaration
+        bool used = false;          // Has at least one non-empty cell
+        uint64_t firstUsedRow = 0;
+        uint64_t lastUsedRow = 0;
+        uint64_t firstUsedColumn = 0;
+        uint64_t lastUsedColumn = 0;
+        std::array<uint64_t, kCellTypeCount> cells{};  // Logical cells per type
+        uint64_t formulas = 0;      // Logical cells with a formula
+        uint64_t coveredCells = 0;  // Logical cells hidden by merges
+    };
+
+    /**
+     * @brief Receives each row run once its end tag has been read
+     *
+     * The row and its cells are only valid during the call.
+     */
+    using RowCallback = std::function<void(size_t sheet, const Row& row)>;
+
+    TableScanner();
+
+    /**
+     * @brief Set a callback for the rows of every sheet
+     * @param callback Row callback, or an empty function for none
+     */
+    void setRowCallback(RowCallback callback);
+
+    /**
+     * @brief Scan the next chunk of content.xml
+     * @param chunk Next bytes of the document
+     */
+    void feed(std::string_view chunk);
+
+    /**
+     * @brief Scan input held back at the end of the last chunk
+     */
+    void finish();
+
+    /**
+     * @brief Get the statistics of the sheets found so far
+     * @return Sheets in document order
+     */
+    const std::vector<SheetStats>& sheets() const;
+
+    /**
+     * @brief Get the number of input bytes that were scanned
+     * @return Input bytes consumed
+     */
+    size_t bytesConsumed() const;
+
+    /**
+     * @brief Get the name of a cell type
+     * @param type Cell type
+     * @return "empty", "float", "percentage", ...
+     */
+    static const char* name(CellType type);
+
+    /**
+     * @brief Format a zero-based column index as a spreadsheet letter
+     * @param column Column index (0 = "A", 26 = "AA")
+     * @return Column letters
+     */
+    static std::string columnName(uint64_t column);
+
+    /**
+     * @brief Format the used range of a sheet in A1 notation
+     * @param sheet Sheet statistics
+     * @return Range such as "A1:D20", or an empty string for an unused sheet
+     */
+    static std::string usedRange(const SheetStats& sheet);
+
+private:
+    enum class Element {
+        Other,
+        Table,
+        Column,
+        Row,
+        Cell
+    };
+
+    RowCallback rowCallback_;
+    std::vector<SheetStats> sheets_;
+    std::vector<CellRun> cells_;    // Cells of the current row
+    std::string pending_;           // Incomplete token carried between chunks
+    size_t consumed_;
+    size_t tableDepth_;             // Open table:table elements
+    Element element_;               // Element whose attributes are being read
+    uint64_t row_;                  // Next row of the current sheet
+    uint64_t rowRepeat_;
+    uint64_t declaredColumns_;      // Sum of table:table-column repeats
+    CellRun cell_;                  // Cell being read
+    bool inRow_;
+    bool inCell_;
+    bool cellHasText_;
+    bool cellTyped_;
+
+    size_t process(std::string_view data, bool final);
+    void startElement(std::string_view name, XmlTokenizer& tokenizer);
+    void attribute(std::string_view name, std::string_view value);
+    void endElement(std::string_view name);
+    void endCell();
+    void endRow();
+};
+
+#endif // TABLESCANNER_H
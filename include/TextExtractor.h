@@ -0,0 +1,83 @@
+#ifndef TEXTEXTRACTOR_H
+#define TEXTEXTRACTOR_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+class XmlTokenizer;
+
+/**
+ * @brief Streaming plain-text extractor for ODF body XML
+ *
+ * Turns the office:body of content.xml (or of a flat document) into
+ * readable text: paragraphs and headings end in a newline, table cells are
+ * separated by tabs and rows by newlines, text:s, text:tab and
+ * text:line-break become spaces, tabs and newlines, and runs of whitespace
+ * in character data collapse to one space as ODF renders them. Footnote
+ * and endnote citations are dropped and each note body starts a new line.
+ *
+ * Input may be fed in arbitrary chunks as it is inflated. Only markup cut
+ * by a chunk boundary (up to XmlTokenizer::kMaxCarryOver bytes) and the
+ * tail of a possible entity are carried over, and text is handed to the
+ * writer whenever kBlockSize bytes have collected, so memory use does not
+ * depend on the size of the document.
+ */
+class TextExtractor {
+public:
+    /**
+     * @brief Receives the extracted text in order
+     */
+    using Writer = std::function<void(std::string_view text)>;
+
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    /**
+     * @brief Construct a new Text Extractor object
+     * @param writer Callback receiving the text
+     */
+    explicit TextExtractor(Writer writer);
+
+    /**
+     * @brief Extract text from the next chunk of XML
+     * @param chunk Next bytes of the document
+     */
+    void feed(std::string_view chunk);
+
+    /**
+     * @brief Process input held back at the end of the last chunk and hand
+     *        the remaining text to the writer
+     */
+    void finish();
+
+    /**
+     * @brief Get the number of input bytes that were processed
+     * @return Input bytes consumed
+     */
+    size_t bytesConsumed() const;
+
+private:
+    Writer writer_;
+    std::string text_;      // Output not yet handed to the writer
+    std::string pending_;   // Incomplete token carried between chunks
+    std::string decoded_;   // Scratch buffer for entity decoding
+    size_t consumed_;
+    size_t spaces_;         // Count of the text:s element being read
+    bool inBody_;
+    bool inSpace_;          // Between the start and end of a text:s
+    bool inCitation_;       // Inside a text:note-citation
+    bool afterNote_;        // A note body ended and nothing has started since
+
+    size_t process(std::string_view data, bool final);
+    void startElement(std::string_view name, XmlTokenizer& tokenizer);
+    void endElement(std::string_view name);
+    void appendText(std::string_view raw);
+    void appendCollapsed(std::string_view text);
+    void append(char c);
+    void appendRepeated(size_t count, char c);
+    char last() const;
+    void flush(bool all);
+};
+
+#endif // TEXTEXTRACTOR_H
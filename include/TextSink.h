@@ -0,0 +1,32 @@
+#ifndef TEXTSINK_H
+#define TEXTSINK_H
+
+#include <ostream>
+#include "OutputSink.h"
+
+/**
+ * @brief Writes records as the banner-decorated text of the CLI and GUI
+ */
+class TextSink : public OutputSink {
+public:
+    /**
+     * @brief Construct a text sink
+     * @param out Stream to write to
+     */
+    explicit TextSink(std::ostream& out);
+
+    void beginDocument(std::string_view path) override;
+    void endDocument() override;
+    void summary(const Summary& summary) override;
+    void structure(const std::vector<ZipEntry>& entries) override;
+    void metadata(const ODFMetadata* metadata) override;
+    void images(const std::vector<const ZipEntry*>& images) override;
+    void tables(const std::vector<TableScanner::SheetStats>& sheets) override;
+    void error(std::string_view message) override;
+    void stats(const InspectStats& stats) override;
+
+private:
+    std::ostream& out_;
+};
+
+#endif // TEXTSINK_H
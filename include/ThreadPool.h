@@ -0,0 +1,87 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed-size work-stealing thread pool
+ *
+ * Every worker owns a task deque. Workers take their own newest task first
+ * and, when their deque is empty, steal the oldest task from another
+ * worker. Tasks submitted from a worker thread go to that worker's deque.
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Start the worker threads
+     * @param threadCount Number of workers (0 = hardware concurrency)
+     * @param maxQueued Maximum number of queued tasks before submit() blocks
+     *                  (0 = unbounded)
+     */
+    explicit ThreadPool(size_t threadCount = 0, size_t maxQueued = 0);
+
+    /**
+     * @brief Run the remaining tasks and join the workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queue a task for execution
+     *
+     * Blocks while the queue is full, unless called from a worker thread.
+     * @param task Task to run
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Block until every submitted task has finished
+     *
+     * A task that throws doesn't stop the pool or the other tasks; the
+     * first exception thrown since the last wait() is rethrown here.
+     */
+    void wait();
+
+    /**
+     * @brief Get the number of worker threads
+     * @return Worker count
+     */
+    size_t size() const;
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex stateMutex_;
+    std::condition_variable taskAvailable_;
+    std::condition_variable allDone_;
+    std::condition_variable spaceAvailable_;
+    size_t queued_;      // Tasks waiting in a deque
+    size_t pending_;     // Tasks queued or running
+    size_t maxQueued_;
+    size_t nextQueue_;   // Round-robin target for external submissions
+    bool stopping_;
+    std::exception_ptr firstError_;   // First exception a task let escape
+
+    void waitIdle();
+    void workerLoop(size_t index);
+    Task takeTask(size_t index);
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,138 @@
+#ifndef XMLDIFF_H
+#define XMLDIFF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "XmlTree.h"
+
+/**
+ * @brief Structural diff of two XmlTrees
+ *
+ * Every node first gets a hash of its whole subtree (name, attributes,
+ * text and children, in order) in one backwards pass over each tree.
+ * Walking down from the roots, subtrees with equal hashes are skipped
+ * without being looked at, so the cost of a diff is dominated by the two
+ * hashing passes and a small edit touches little beyond its ancestors.
+ *
+ * Children are aligned like a patience diff: common prefix and suffix
+ * first, then subtrees that occur exactly once on both sides serve as
+ * anchors. What remains between anchors is paired by element name, and
+ * paired elements are compared in turn; anything left over is
+ * reported as added or removed.
+ *
+ * Changes are reported in document order as they are found. Paths are
+ * XPath-like, with [n] wherever an element name repeats among siblings
+ * (text and CDATA nodes are numbered together as text());
+ * they count positions in the new document, except that the last step
+ * of a removed node counts in the old one.
+ */
+class XmlDiff {
+public:
+    enum class ChangeType {
+        Added,
+        Removed,
+        Changed
+    };
+
+    /**
+     * @brief One difference between the trees
+     *
+     * Views are only valid during the callback. Text and attribute values
+     * have their entities decoded; CDATA is given as written.
+     */
+    struct Change {
+        ChangeType type;
+        std::string_view path;      // Element, ".../@attribute" or ".../text()"
+        std::string_view before;    // Old attribute value or text, if any
+        std::string_view after;     // New attribute value or text, if any
+    };
+
+    using Callback = std::function<void(const Change& change)>;
+
+    /**
+     * @brief Prepare a diff; both trees must outlive it
+     * @param before Old tree
+     * @param after New tree
+     */
+    XmlDiff(const XmlTree& before, const XmlTree& after);
+
+    /**
+     * @brief Compare the trees
+     * @param callback Receives each change in document order
+     * @return Number of changes reported
+     */
+    size_t run(const Callback& callback);
+
+private:
+    enum class OpType {
+        Pair,       // Same kind of node, different content
+        Remove,
+        Insert
+    };
+
+    struct Op {
+        OpType type;
+        uint32_t before;    // Index into the old child list
+        uint32_t after;     // Index into the new child list
+    };
+
+    struct Side {
+        const XmlTree* tree;
+        std::vector<uint64_t> hashes;       // Subtree hash per node
+        std::vector<uint64_t> nameHashes;   // Per NameId, filled on demand
+    };
+
+    // Position of the last reported child with a given key, so that
+    // ordinals cost one forward scan per key however many are reported
+    struct Cursor {
+        uint64_t key;
+        size_t index;
+        uint32_t ordinal;
+        bool repeated;      // Key occurs more than once among the siblings
+    };
+
+    struct Children {
+        Side* side;
+        std::vector<XmlTree::NodeId> ids;
+        std::vector<uint64_t> keys;         // Element name, or text/CDATA
+        std::vector<Cursor> cursors;
+    };
+
+    // A pair of elements being compared, with the ops still to apply
+    struct Frame {
+        Children oldChildren;
+        Children newChildren;
+        std::vector<Op> ops;
+        size_t next = 0;
+        size_t length = 0;      // Path length of the element itself
+    };
+
+    Side before_;
+    Side after_;
+    const Callback* callback_;
+    std::string path_;
+    std::string beforeText_;    // Decoded values being reported
+    std::string afterText_;
+    size_t changes_;
+
+    static void hashTree(Side& side);
+    static uint64_t nameHash(Side& side, XmlTree::NameId name);
+    static uint64_t key(Side& side, XmlTree::NodeId id);
+    static void collectChildren(Side& side, XmlTree::NodeId parent, Children& children);
+    static std::string_view decode(std::string_view raw, std::string& scratch);
+    static std::string_view nodeText(const Side& side, XmlTree::NodeId id, std::string& scratch);
+    void report(ChangeType type, std::string_view before, std::string_view after);
+    void diffElement(XmlTree::NodeId before, XmlTree::NodeId after);
+    void diffAttributes(XmlTree::NodeId before, XmlTree::NodeId after);
+    void align(const Children& before, const Children& after, size_t b0, size_t b1,
+               size_t a0, size_t a1, int depth, std::vector<Op>& ops) const;
+    void pairByName(const Children& before, const Children& after, size_t b0, size_t b1,
+                    size_t a0, size_t a1, std::vector<Op>& ops) const;
+    void appendStep(Children& children, size_t index);
+};
+
+#endif // XMLDIFF_H
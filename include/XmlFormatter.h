@@ -0,0 +1,88 @@
+#ifndef XMLFORMATTER_H
+#define XMLFORMATTER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Streaming XML pretty-printer with an optional output limit
+ *
+ * Input may be fed in arbitrary chunks. Text is formatted as it arrives;
+ * only markup split across chunks is carried over to the next feed(), up
+ * to XmlTokenizer::kMaxCarryOver bytes. Once the formatted output reaches
+ * the limit, formatting stops and feed() returns false, so a short preview
+ * of a huge document costs only the bytes needed to produce it.
+ */
+class XmlFormatter {
+public:
+    static constexpr size_t kUnlimited = static_cast<size_t>(-1);
+
+    /**
+     * @brief Construct a new XML Formatter object
+     * @param outputLimit Maximum number of output characters
+     */
+    explicit XmlFormatter(size_t outputLimit = kUnlimited);
+
+    /**
+     * @brief Format the next chunk of input
+     * @param chunk Next bytes of the document
+     * @return false once the output limit has been reached
+     */
+    bool feed(std::string_view chunk);
+
+    /**
+     * @brief Flush input held back at the end of the last chunk
+     */
+    void finish();
+
+    /**
+     * @brief Get the formatted output
+     * @return Formatted text (at most outputLimit characters)
+     */
+    const std::string& output() const;
+
+    /**
+     * @brief Check whether formatting stopped at the output limit
+     *
+     * Also set when a single token exceeds the carry-over limit.
+     * @return true if the output was cut off
+     */
+    bool isTruncated() const;
+
+    /**
+     * @brief Get the number of input bytes that were formatted
+     *
+     * Subtracting this from the document size gives the size of the part
+     * that was never looked at.
+     * @return Input bytes consumed
+     */
+    size_t bytesConsumed() const;
+
+private:
+    enum class Last {
+        Nothing,
+        StartTag,
+        Text,
+        Other
+    };
+
+    size_t limit_;
+    std::string output_;
+    std::string pending_;   // Incomplete token carried between chunks
+    std::string heldSpace_; // Whitespace that may turn out to end a text run
+    size_t consumed_;
+    size_t indent_;
+    Last last_;
+    bool truncated_;
+    bool inText_;           // The last chunk ended inside a text run
+    bool textStarted_;      // The current text run has non-whitespace
+
+    size_t process(std::string_view data, bool final);
+    void appendText(std::string_view text, bool open);
+    void holdSpace(std::string_view space);
+    void newLine();
+    bool append(std::string_view text);
+};
+
+#endif // XMLFORMATTER_H
@@ -0,0 +1,133 @@
+#ifndef XMLTOKENIZER_H
+#define XMLTOKENIZER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Single-pass pull tokenizer over an XML byte span
+ *
+ * The tokenizer never allocates: every token is a set of views into the
+ * input, which must outlive it. Entities are left encoded in names, text
+ * and attribute values; use decodeEntities() where decoded text is needed.
+ *
+ * For each element the tokenizer reports a StartElement, one Attribute
+ * token per attribute, the element content, and an EndElement. Empty
+ * elements ("<a/>") get a synthesised EndElement with selfClosing set.
+ */
+class XmlTokenizer {
+public:
+    enum class TokenType {
+        StartElement,           // name = QName, raw = whole start tag
+        Attribute,              // name = QName, value = raw attribute value
+        EndElement,             // name = QName
+        Text,                   // value = raw character data
+        CData,                  // value = section content
+        Comment,                // value = comment body
+        ProcessingInstruction,  // name = target, value = instruction body
+        Doctype                 // value = declaration body
+    };
+
+    /**
+     * @brief Longest incomplete token a streaming reader carries over
+     *
+     * Readers fed in chunks keep markup cut by a chunk boundary until the
+     * next chunk completes it. A token that grows past this without ending
+     * is malformed or hostile, and is given up on instead of buffered.
+     */
+    static constexpr size_t kMaxCarryOver = 1024 * 1024;
+
+    struct Token {
+        TokenType type = TokenType::Text;
+        std::string_view name;
+        std::string_view value;
+        std::string_view raw;       // Exact source bytes of the token
+        bool selfClosing = false;   // StartElement/EndElement of "<a/>"
+    };
+
+    /**
+     * @brief Construct a tokenizer over a complete document or fragment
+     * @param input XML bytes; must stay valid while tokenizing
+     */
+    explicit XmlTokenizer(std::string_view input);
+
+    /**
+     * @brief Advance to the next token
+     * @param token Receives the token
+     * @return true if a token was produced, false at end of input or error
+     */
+    bool next(Token& token);
+
+    /**
+     * @brief Skip the remaining Attribute tokens of the current start tag
+     */
+    void skipAttributes();
+
+    /**
+     * @brief Check whether tokenizing stopped on malformed input
+     * @return true if an error occurred
+     */
+    bool hasError() const;
+
+    /**
+     * @brief Get the current byte offset into the input
+     * @return Offset of the next unread byte
+     */
+    size_t offset() const;
+
+    /**
+     * @brief Get the current element nesting depth
+     * @return Number of open elements
+     */
+    size_t depth() const;
+
+    /**
+     * @brief Get the local part of a QName ("text:p" -> "p")
+     * @param qname Qualified name
+     * @return Local name view
+     */
+    static std::string_view localName(std::string_view qname);
+
+    /**
+     * @brief Append text with XML entities and character references decoded
+     * @param raw Raw text or attribute value
+     * @param out String to append to
+     */
+    static void decodeEntities(std::string_view raw, std::string& out);
+
+    /**
+     * @brief Check whether carried-over markup may be complete now
+     *
+     * Lets a streaming reader wait for the terminator of a long comment or
+     * tag instead of tokenizing it again after every chunk.
+     * @param data Incomplete markup followed by newly arrived input
+     * @param scanned Length of the part already known to be incomplete
+     * @return false if the markup certainly still ends beyond data
+     */
+    static bool mayCompleteMarkup(std::string_view data, size_t scanned);
+
+private:
+    enum class State {
+        Content,
+        Attributes
+    };
+
+    const char* begin_;
+    const char* pos_;
+    const char* end_;
+    const char* tagEnd_;        // End of the current start tag ('>' or "/>")
+    std::string_view element_;  // Name of the current start tag
+    State state_;
+    size_t depth_;
+    bool selfClosing_;
+    bool error_;
+
+    bool readMarkup(Token& token);
+    bool readStartTag(Token& token);
+    bool readAttribute(Token& token);
+    bool readUntil(const char* terminator, size_t length, const char* from, const char*& found);
+    bool fail();
+};
+
+#endif // XMLTOKENIZER_H
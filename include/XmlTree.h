@@ -0,0 +1,172 @@
+#ifndef XMLTREE_H
+#define XMLTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Compact read-only DOM over an XML buffer
+ *
+ * Nodes live in one contiguous array in document order and refer to each
+ * other by index, so a subtree is a contiguous range and walking the tree
+ * touches memory sequentially. Attributes sit in a second array. Element
+ * and attribute names are interned: each distinct QName is stored once,
+ * as a view into the source, and nodes carry its NameId, so comparing
+ * names is an integer compare.
+ *
+ * Both arrays are sized up front from a vectorised count of '<' and '='
+ * in the input, so a build takes a handful of allocations however large
+ * the document is, and clear() gives everything back at once. Text and
+ * attribute values are views into the source with entities left encoded;
+ * the source must outlive the tree. Comments, processing instructions and
+ * the DOCTYPE are not kept.
+ */
+class XmlTree {
+public:
+    using NodeId = uint32_t;
+    using NameId = uint32_t;
+
+    static constexpr NodeId kNoNode = UINT32_MAX;
+    static constexpr NameId kNoName = UINT32_MAX;
+
+    enum class NodeType : uint8_t {
+        Element,
+        Text,       // Character data, entities encoded
+        CData       // CDATA section content
+    };
+
+    struct Node {
+        std::string_view text;      // Text and CDATA nodes only
+        NodeId parent;
+        NodeId nextSibling;
+        NodeId end;                 // One past the last node of the subtree
+        NameId name;                // Elements only
+        uint32_t firstAttribute;    // Index into the attribute array
+        uint16_t attributeCount;
+        NodeType type;
+    };
+
+    struct Attribute {
+        NameId name;
+        std::string_view value;     // Raw value, entities encoded
+    };
+
+    XmlTree();
+
+    /**
+     * @brief Build the tree, replacing any previous one
+     * @param xml Complete document; must outlive the tree
+     * @return false if the document is malformed
+     */
+    bool build(std::string_view xml);
+
+    /**
+     * @brief Free all nodes, attributes and names
+     */
+    void clear();
+
+    /**
+     * @brief Check whether the tree holds no nodes
+     * @return true before build() or after clear()
+     */
+    bool empty() const;
+
+    /**
+     * @brief Get the number of nodes
+     * @return Node count; ids run from 0 to size() - 1
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get the document element
+     * @return Id of the root, or kNoNode for an empty tree
+     */
+    NodeId root() const;
+
+    /**
+     * @brief Get a node
+     * @param id Node id
+     * @return Node record
+     */
+    const Node& node(NodeId id) const;
+
+    /**
+     * @brief Get the first child of a node
+     * @param id Node id
+     * @return Child id, or kNoNode for a leaf
+     */
+    NodeId firstChild(NodeId id) const;
+
+    /**
+     * @brief Look up the id of a QName
+     * @param qname Name such as "text:p"
+     * @return Name id, or kNoName if no element or attribute has it
+     */
+    NameId nameId(std::string_view qname) const;
+
+    /**
+     * @brief Get the QName for a name id
+     * @param id Name id
+     * @return Name view into the source
+     */
+    std::string_view name(NameId id) const;
+
+    /**
+     * @brief Get the attributes of an element
+     * @param id Element id
+     * @return Pointer to the first of node(id).attributeCount attributes
+     */
+    const Attribute* attributes(NodeId id) const;
+
+    /**
+     * @brief Get the raw value of an attribute
+     * @param id Element id
+     * @param attribute Attribute name id
+     * @return Value, or an empty view if the element lacks the attribute
+     */
+    std::string_view attribute(NodeId id, NameId attribute) const;
+
+    /**
+     * @brief Find the next element with a given name in document order
+     * @param from Node to start at (inclusive)
+     * @param name Element name id
+     * @param end Node id to stop before (default: end of the document)
+     * @return Element id, or kNoNode if there is none
+     */
+    NodeId find(NodeId from, NameId name, NodeId end = kNoNode) const;
+
+    /**
+     * @brief Append the decoded text of all text nodes below a node
+     * @param id Node id
+     * @param out String to append to
+     */
+    void appendText(NodeId id, std::string& out) const;
+
+    /**
+     * @brief Get the memory held by the tree
+     * @return Bytes allocated for nodes, attributes and names
+     */
+    size_t memoryUsage() const;
+
+    /**
+     * @brief Get the last error message
+     * @return Error message string
+     */
+    std::string getLastError() const;
+
+private:
+    std::vector<Node> nodes_;
+    std::vector<Attribute> attributes_;
+    std::vector<std::string_view> names_;
+    std::vector<NameId> nameSlots_;     // Open-addressing hash of names_
+    std::string lastError_;
+
+    NameId intern(std::string_view qname);
+    size_t findSlot(std::string_view qname) const;
+    void growNameSlots();
+};
+
+#endif // XMLTREE_H
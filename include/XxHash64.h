@@ -0,0 +1,53 @@
+#ifndef XXHASH64_H
+#define XXHASH64_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Streaming XXH64 hash
+ *
+ * Non-cryptographic, but fast (several GB/s) and well distributed, which
+ * is what confirming that two files with equal CRC-32 and size really are
+ * the same needs. Input may be fed in pieces of any size; the digest is
+ * the same as for the whole input at once.
+ */
+class XxHash64 {
+public:
+    /**
+     * @brief Start a new hash
+     * @param seed Seed value
+     */
+    explicit XxHash64(uint64_t seed = 0);
+
+    /**
+     * @brief Add the next piece of input
+     * @param data Input bytes
+     * @param size Number of bytes
+     */
+    void update(const void* data, size_t size);
+
+    /**
+     * @brief Get the hash of the input so far
+     * @return 64-bit digest
+     */
+    uint64_t digest() const;
+
+    /**
+     * @brief Hash a buffer in one go
+     * @param data Input bytes
+     * @param size Number of bytes
+     * @param seed Seed value
+     * @return 64-bit digest
+     */
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = 0);
+
+private:
+    uint64_t seed_;
+    uint64_t lanes_[4];
+    uint64_t total_;
+    unsigned char buffer_[32];  // Partial stripe
+    size_t buffered_;
+};
+
+#endif // XXHASH64_H
@@ -1,24 +1,87 @@
 #ifndef ZIPREADER_H
 #define ZIPREADER_H
 
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "Inflater.h"
+#include "InspectStats.h"
+#include "MappedFile.h"
+
+/**
+ * @brief Central directory record for a single archive entry
+ *
+ * Sizes and offsets are 64-bit; for Zip64 archives they come from the
+ * Zip64 extended information extra field.
+ */
+struct ZipEntry {
+    std::string name;
+    uint64_t compressedSize = 0;
+    uint64_t uncompressedSize = 0;
+    uint32_t crc32 = 0;
+    uint16_t method = 0;        // 0 = stored, 8 = deflated
+    uint64_t dirOffset = 0;     // Offset of the record in the central directory
+    uint64_t fileIndex = 0;     // Position of the entry in the central directory
+    uint64_t localHeaderOffset = 0;  // Offset of the local file header (mapped backend)
+};
 
 /**
  * @brief Handles reading and extracting files from ZIP archives
  * 
  * ODF files are ZIP archives, so this class provides functionality
- * to extract and read individual files from within the archive.
+ * to extract and read individual files from within the archive. Zip64
+ * archives (over 4 GiB, or over 65535 entries) are supported, and entry
+ * names may have any length.
+ *
+ * Once open() has returned, the const read methods may be called from
+ * several threads at once. With the Mapped backend every read works on
+ * the shared mapping with its own inflate state and runs fully in
+ * parallel; the Minizip backend has a single file cursor, so its reads
+ * are serialised.
+ *
+ * Whole entries read by the Mapped backend are decompressed with the
+ * configured Inflater backend (see setInflateBackend()); streamed reads
+ * and the Minizip backend always use zlib.
  */
 class ZipReader {
 public:
+    /**
+     * @brief Receives consecutive chunks of an entry while it is read
+     *
+     * The data pointer is only valid for the duration of the call. Return
+     * false to stop reading the entry early.
+     */
+    using ChunkCallback = std::function<bool(const char* data, size_t size)>;
+
+    /**
+     * @brief Default chunk size for streamFile()
+     */
+    static constexpr size_t kDefaultChunkSize = 64 * 1024;
+
+    /**
+     * @brief How the archive bytes are accessed
+     *
+     * Minizip reads through minizip's buffered FILE* I/O. Mapped maps the
+     * whole archive into memory, parses the central directory straight from
+     * the mapping and can hand out zero-copy views of stored entries.
+     */
+    enum class Backend {
+        Minizip,
+        Mapped
+    };
+
     /**
      * @brief Construct a new Zip Reader object
      * @param zipPath Path to the ZIP/ODF file
+     * @param backend I/O backend to use
      */
-    explicit ZipReader(const std::string& zipPath);
+    explicit ZipReader(const std::string& zipPath, Backend backend = Backend::Minizip);
     
     /**
      * @brief Destroy the Zip Reader object
@@ -55,6 +118,92 @@ public:
      */
     std::string extractFile(const std::string& filename) const;
 
+    /**
+     * @brief Extract a file into a caller-owned buffer
+     *
+     * The buffer is resized to the entry size and filled in place, so a
+     * buffer reused across calls avoids reallocating for every entry.
+     * Entries whose declared size their compressed data can't produce
+     * are rejected before anything is allocated.
+     * @param filename Name of the file to extract
+     * @param out Buffer receiving the file content
+     * @return true if successful, false otherwise
+     */
+    bool extractFileTo(const std::string& filename, std::string& out) const;
+
+    /**
+     * @brief Get a zero-copy view of a stored (uncompressed) entry
+     *
+     * Only available with the Mapped backend and for entries that use the
+     * STORED method. The view points into the mapping and is valid until
+     * the archive is closed.
+     * @param filename Name of the file to view
+     * @param view Receives the entry bytes
+     * @return true if a view could be provided, false otherwise
+     */
+    bool viewFile(const std::string& filename, std::string_view& view) const;
+
+    /**
+     * @brief Stream a file from the archive in fixed-size chunks
+     *
+     * The entry is decompressed through a single buffer of chunkSize bytes,
+     * so memory use does not depend on the size of the entry. With the
+     * Minizip backend the callback must not call back into this reader.
+     * @param filename Name of the file to read
+     * @param onChunk Callback invoked for each chunk, in order
+     * @param chunkSize Maximum number of bytes passed per callback
+     * @return true if the entry was read (or the callback stopped early),
+     *         false on error
+     */
+    bool streamFile(const std::string& filename, const ChunkCallback& onChunk,
+                    size_t chunkSize = kDefaultChunkSize) const;
+
+    /**
+     * @brief Check an entry against its checksum and its local header
+     *
+     * The local header must name the same entry with the same method,
+     * CRC-32 and sizes as the central directory (taken from the data
+     * descriptor when the header defers to one). The entry is then
+     * decompressed through a single streaming buffer and its CRC-32
+     * compared with the stored one. Only available with the Mapped
+     * backend. Unlike the other methods this reports through problem
+     * rather than getLastError(), so entries can be verified from several
+     * threads at once.
+     * @param entry Entry from entries()
+     * @param problem Receives what is wrong with the entry
+     * @return true if the entry is intact, false otherwise
+     */
+    bool verifyEntry(const ZipEntry& entry, std::string& problem) const;
+
+    /**
+     * @brief Extract a byte range of a file, decompressing no further than its end
+     *
+     * Deflated entries are inflated from the start up to the last byte of
+     * the range and no further, so the cost depends on where the range
+     * ends, not on the size of the entry. Stored entries of a mapped
+     * archive are copied straight from the mapping. A range reaching past
+     * the end of the file is cut short.
+     * @param filename Name of the file to read
+     * @param offset Offset of the first byte in the uncompressed file
+     * @param length Maximum number of bytes to extract
+     * @param out Buffer receiving the bytes
+     * @return true if successful, false on error or if offset is past the end
+     */
+    bool extractRange(const std::string& filename, uint64_t offset, size_t length,
+                      std::string& out) const;
+
+    /**
+     * @brief Extract the first bytes of a file
+     *
+     * Same as extractRange() from offset 0; meant for sniffing image
+     * headers, previews and root elements.
+     * @param filename Name of the file to read
+     * @param maxBytes Maximum number of bytes to extract
+     * @param out Buffer receiving the bytes
+     * @return true if successful, false otherwise
+     */
+    bool extractPrefix(const std::string& filename, size_t maxBytes, std::string& out) const;
+
     /**
      * @brief Check if a file exists in the archive
      * @param filename Name of the file to check
@@ -67,7 +216,30 @@ public:
      * @param filename Name of the file
      * @return Size in bytes, or 0 if file doesn't exist
      */
-    size_t getFileSize(const std::string& filename) const;
+    uint64_t getFileSize(const std::string& filename) const;
+
+    /**
+     * @brief Look up an entry in the central directory index
+     * @param filename Name of the file within the archive
+     * @return Pointer to the entry, or nullptr if it doesn't exist
+     */
+    const ZipEntry* findEntry(const std::string& filename) const;
+
+    /**
+     * @brief Get all entries in central directory order
+     * @return Reference to the entry index (empty if not open)
+     */
+    const std::vector<ZipEntry>& entries() const;
+
+    /**
+     * @brief Checksum of the central directory contents
+     *
+     * CRC-32 over every entry's name, method, sizes and CRC, in directory
+     * order. It changes whenever any entry is added, removed or rewritten,
+     * and is the same for both backends.
+     * @return Directory checksum (0 if not open)
+     */
+    uint32_t directoryChecksum() const;
 
     /**
      * @brief Get the last error message
@@ -75,14 +247,83 @@ public:
      */
     std::string getLastError() const;
 
+    /**
+     * @brief Check whether reads from several threads actually overlap
+     * @return true for the Mapped backend, false if reads are serialised
+     */
+    bool supportsConcurrentReads() const;
+
+    /**
+     * @brief Report timings and counters into a stats object
+     *
+     * Covers opening, directory parsing, entry lookups and seeks, and
+     * reading entries. Must be set before open() to include opening.
+     * @param stats Stats to update, or nullptr to disable (the default)
+     */
+    void setStats(InspectStats* stats);
+
+    /**
+     * @brief Choose the decompressor for whole-entry reads
+     * @param backend Inflater backend; defaults to Inflater::getDefault()
+     * @return false if the backend was not built in (the current one stays)
+     */
+    bool setInflateBackend(Inflater::Backend backend);
+
+    /**
+     * @brief Get the decompressor used for whole-entry reads
+     * @return Inflater backend
+     */
+    Inflater::Backend getInflateBackend() const;
+
+    /**
+     * @brief Read the archive into memory instead of mapping it
+     *
+     * For the Mapped backend in long-running processes: a mapping faults
+     * when the file is truncated while an entry is being read, a private
+     * copy keeps serving the archive as it was opened. Must be set before
+     * open().
+     * @param copy true to copy, false to map (the default)
+     */
+    void setPrivateCopy(bool copy);
+
+    /**
+     * @brief Get the backend this reader was created with
+     * @return Backend in use
+     */
+    Backend getBackend() const;
+
 private:
     std::string zipPath_;
+    Backend backend_;
     void* zipHandle_;  // Platform-specific ZIP handle
+    MappedFile mapping_;
     mutable std::string lastError_;
+    mutable std::mutex errorMutex_;
+    mutable std::mutex cursorMutex_;  // Guards the minizip file cursor
     bool isOpen_;
+    bool privateCopy_;
+    InspectStats* stats_;  // Not owned; nullptr when disabled
+    Inflater::Backend inflateBackend_;
+
+    // Central directory index, built once by open()
+    std::vector<ZipEntry> entries_;
+    std::unordered_map<std::string, size_t> entryIndex_;
 
     // Helper methods for ZIP handling
-    bool readZipEntry(const std::string& filename, std::vector<char>& buffer) const;
+    void setError(const std::string& message) const;
+    void countBuffer(size_t size) const;
+    bool buildIndex();
+    bool buildMappedIndex();
+    bool readMappedEntry(const ZipEntry& entry, const char* data, char* dest) const;
+    bool streamMappedEntry(const ZipEntry& entry, const ChunkCallback& onChunk,
+                           size_t chunkSize) const;
+    const char* streamMappedData(const ZipEntry& entry, const char* data,
+                                 const ChunkCallback& onChunk, size_t chunkSize) const;
+    bool checkLocalHeader(const ZipEntry& entry, const char*& data, std::string& problem) const;
+    bool streamMinizipEntry(const ZipEntry& entry, const ChunkCallback& onChunk,
+                            size_t chunkSize) const;
+    bool openMinizipEntry(const ZipEntry& entry) const;
+    bool locateMappedData(const ZipEntry& entry, const char*& data) const;
 };
 
 #endif // ZIPREADER_H
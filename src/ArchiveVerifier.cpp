@@ -0,0 +1,114 @@
+#include "ArchiveVerifier.h"
+#include "BatchRunner.h"
+#include "FlatODF.h"
+#include "ThreadPool.h"
+#include "ZipReader.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Documents queued for opening per worker; their entries are queued by
+// the worker that opens them
+constexpr size_t kQueuedDocumentsPerThread = 4;
+
+// Shared by the tasks of one document; the last one to finish reports
+struct Document {
+    explicit Document(const std::string& path)
+        : reader(path, ZipReader::Backend::Mapped) {
+        report.path = path;
+    }
+
+    ZipReader reader;
+    ArchiveVerifier::Report report;
+    std::mutex mutex;
+    std::atomic<size_t> remaining{0};
+};
+
+} // namespace
+
+ArchiveVerifier::ArchiveVerifier(size_t threadCount)
+    : threadCount_(threadCount) {
+}
+
+void ArchiveVerifier::run(const std::vector<std::string>& inputs, const Callback& onReport) {
+    size_t threads = threadCount_ > 0
+        ? threadCount_ : std::max(1u, std::thread::hardware_concurrency());
+
+    std::mutex reportMutex;
+    auto finish = [&reportMutex, &onReport](Document& document) {
+        std::sort(document.report.problems.begin(), document.report.problems.end(),
+                  [](const Problem& a, const Problem& b) { return a.entry < b.entry; });
+        std::lock_guard<std::mutex> lock(reportMutex);
+        onReport(document.report);
+    };
+
+    ThreadPool workers(threads, kQueuedDocumentsPerThread * threads);
+
+    BatchRunner::forEachPath(inputs, [&](const std::string& path) {
+        workers.submit([&workers, &finish, path] {
+            auto document = std::make_shared<Document>(path);
+            if (!document->reader.open()) {
+                // Flat documents are plain XML and carry no checksums
+                FlatODF flat;
+                if (flat.open(path) || flat.isXml()) {
+                    document->report.skipped = true;
+                } else {
+                    document->report.error = document->reader.getLastError();
+                }
+                finish(*document);
+                return;
+            }
+
+            const std::vector<ZipEntry>& entries = document->reader.entries();
+            document->report.entries = entries.size();
+            if (entries.empty()) {
+                finish(*document);
+                return;
+            }
+
+            // Tasks submitted from a worker land in its own deque, where
+            // idle workers steal them
+            document->remaining = entries.size();
+            for (const ZipEntry& entry : entries) {
+                workers.submit([document, &entry, &finish] {
+                    std::string problem;
+                    bool ok = document->reader.verifyEntry(entry, problem);
+                    {
+                        std::lock_guard<std::mutex> lock(document->mutex);
+                        document->report.bytes += entry.uncompressedSize;
+                        document->report.storedBytes += entry.compressedSize;
+                        if (!ok) {
+                            document->report.problems.push_back({ entry.name, problem });
+                        }
+                    }
+                    if (--document->remaining == 0) {
+                        finish(*document);
+                    }
+                });
+            }
+        });
+    });
+
+    workers.wait();
+}
+
+void ArchiveVerifier::write(const Report& report, std::ostream& out) {
+    if (report.skipped) {
+        out << "SKIPPED " << report.path << " (flat XML, no checksums)\n";
+    } else if (!report.error.empty()) {
+        out << "ERROR   " << report.path << ": " << report.error << "\n";
+    } else if (report.problems.empty()) {
+        out << "OK      " << report.path << " (" << report.entries << " entries, "
+            << report.bytes << " bytes)\n";
+    } else {
+        out << "FAILED  " << report.path << " (" << report.problems.size() << " of "
+            << report.entries << " entries)\n";
+        for (const Problem& problem : report.problems) {
+            out << "        " << problem.entry << ": " << problem.message << "\n";
+        }
+    }
+}
@@ -0,0 +1,229 @@
+#include "BatchRunner.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Queue depth per worker before path discovery waits for the pool
+constexpr size_t kQueuedTasksPerThread = 64;
+
+bool hasWildcard(const std::string& text) {
+    return text.find_first_of("*?") != std::string::npos;
+}
+
+/**
+ * Match text against a shell-style pattern. '*' and '?' stay within one
+ * path component, '**' also crosses directory separators.
+ */
+bool wildcardMatch(const char* pattern, const char* text) {
+    while (*pattern != '\0') {
+        if (pattern[0] == '*' && pattern[1] == '*') {
+            pattern += 2;
+            if (*pattern == '/') {
+                // "**/" may also match zero directories
+                if (wildcardMatch(pattern + 1, text)) {
+                    return true;
+                }
+            }
+            for (const char* t = text; ; ++t) {
+                if (wildcardMatch(pattern, t)) {
+                    return true;
+                }
+                if (*t == '\0') {
+                    return false;
+                }
+            }
+        }
+        if (*pattern == '*') {
+            ++pattern;
+            for (const char* t = text; ; ++t) {
+                if (wildcardMatch(pattern, t)) {
+                    return true;
+                }
+                if (*t == '\0' || *t == '/') {
+                    return false;
+                }
+            }
+        }
+        if (*text == '\0') {
+            return false;
+        }
+        if (*pattern == '?' ? *text == '/' : *pattern != *text) {
+            return false;
+        }
+        ++pattern;
+        ++text;
+    }
+    return *text == '\0';
+}
+
+void expandDirectory(const fs::path& dir,
+                     const std::function<void(const std::string&)>& onPath) {
+    std::error_code ec;
+    fs::recursive_directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        std::error_code typeError;
+        if (it->is_regular_file(typeError) && BatchRunner::hasODFExtension(it->path().string())) {
+            onPath(it->path().string());
+        }
+    }
+}
+
+void expandPattern(std::string pattern,
+                   const std::function<void(const std::string&)>& onPath) {
+    std::replace(pattern.begin(), pattern.end(), '\\', '/');
+
+    // Walk from the deepest directory that has no wildcards in it
+    size_t firstWildcard = pattern.find_first_of("*?");
+    size_t baseEnd = pattern.rfind('/', firstWildcard);
+    std::string base = baseEnd == std::string::npos ? "." : pattern.substr(0, baseEnd);
+    if (base.empty()) {
+        base = "/";
+    }
+    std::string matchPattern = baseEnd == std::string::npos ? "./" + pattern : pattern;
+
+    std::string remainder = pattern.substr(baseEnd == std::string::npos ? 0 : baseEnd + 1);
+    bool recursive = remainder.find('/') != std::string::npos ||
+                     remainder.find("**") != std::string::npos;
+
+    auto consider = [&](const fs::directory_entry& entry) {
+        std::error_code typeError;
+        if (!entry.is_regular_file(typeError)) {
+            return;
+        }
+        std::string candidate = entry.path().generic_string();
+        if (wildcardMatch(matchPattern.c_str(), candidate.c_str())) {
+            onPath(entry.path().string());
+        }
+    };
+
+    std::error_code ec;
+    if (recursive) {
+        fs::recursive_directory_iterator it(base, fs::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            consider(*it);
+        }
+    } else {
+        fs::directory_iterator it(base, fs::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+            consider(*it);
+        }
+    }
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(size_t threadCount)
+    : threadCount_(threadCount)
+    , failureStream_(&std::cerr) {
+}
+
+void BatchRunner::setFailureStream(std::ostream& out) {
+    failureStream_ = &out;
+}
+
+bool BatchRunner::hasODFExtension(const std::string& path) {
+    static const char* const extensions[] = {
+        ".odt", ".ott", ".odm", ".oth", ".ods", ".ots", ".odp", ".otp",
+        ".odg", ".otg", ".odc", ".otc", ".odf", ".odi", ".oti", ".odb",
+        ".fodt", ".fods", ".fodp", ".fodg"
+    };
+
+    size_t dot = path.rfind('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+
+    std::string ext = path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    for (const char* candidate : extensions) {
+        if (ext == candidate) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void BatchRunner::forEachPath(const std::vector<std::string>& inputs,
+                              const std::function<void(const std::string&)>& onPath) {
+    for (const auto& input : inputs) {
+        if (input == "-") {
+            std::string line;
+            while (std::getline(std::cin, line)) {
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                if (!line.empty()) {
+                    onPath(line);
+                }
+            }
+            continue;
+        }
+
+        std::error_code ec;
+        if (fs::is_directory(input, ec)) {
+            expandDirectory(input, onPath);
+        } else if (hasWildcard(input) && !fs::exists(input, ec)) {
+            expandPattern(input, onPath);
+        } else {
+            // Explicit files are passed through as-is; errors surface in the job
+            onPath(input);
+        }
+    }
+}
+
+BatchRunner::Result BatchRunner::run(const std::vector<std::string>& inputs, const Job& job) {
+    size_t threads = threadCount_ > 0
+        ? threadCount_ : std::max(1u, std::thread::hardware_concurrency());
+
+    std::mutex outputMutex;
+    std::atomic<size_t> processed(0);
+    std::atomic<size_t> failed(0);
+
+    // Bound the backlog so discovery over huge trees doesn't outrun the workers
+    ThreadPool workers(threads, kQueuedTasksPerThread * threads);
+
+    forEachPath(inputs, [&](const std::string& path) {
+        workers.submit([&, path] {
+            std::ostringstream buffer;
+            bool ok;
+            try {
+                ok = job(path, buffer);
+            } catch (const std::exception& e) {
+                buffer << "Error: " << path << ": " << e.what() << "\n";
+                ok = false;
+            }
+
+            // One write per document keeps records from interleaving
+            const std::string text = buffer.str();
+            {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                std::ostream& stream = ok ? std::cout : *failureStream_;
+                stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+            }
+
+            ++processed;
+            if (!ok) {
+                ++failed;
+            }
+        });
+    });
+
+    workers.wait();
+
+    Result result;
+    result.processed = processed;
+    result.failed = failed;
+    return result;
+}
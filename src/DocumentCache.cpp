@@ -0,0 +1,85 @@
+#include "DocumentCache.h"
+#include "InspectionCache.h"
+#include <algorithm>
+
+DocumentCache::DocumentCache(size_t capacity, uint64_t maxBytes)
+    : capacity_(std::max<size_t>(1, capacity))
+    , maxBytes_(maxBytes)
+    , bytes_(0) {
+}
+
+std::shared_ptr<const ODFInspector> DocumentCache::get(const std::string& path, std::string& error) {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    // Same validation as InspectionCache records
+    if (!InspectionCache::fileStamp(path, size, mtime)) {
+        error = "Cannot access file: " + path;
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = index_.find(path);
+        if (found != index_.end()) {
+            auto slot = found->second;
+            if (slot->size == size && slot->mtime == mtime) {
+                slots_.splice(slots_.begin(), slots_, slot);
+                ++counters_.hits;
+                return slot->inspector;
+            }
+            bytes_ -= slot->size;
+            slots_.erase(slot);
+            index_.erase(found);
+            ++counters_.invalidations;
+        }
+        ++counters_.misses;
+    }
+
+    // Loaded outside the lock so other documents are served meanwhile.
+    // Requests may still be reading an inspector when its file changes,
+    // so it works on a copy rather than a mapping that could fault.
+    auto inspector = std::make_shared<ODFInspector>(path);
+    inspector->setPrivateCopy(true);
+    if (!inspector->load()) {
+        error = inspector->getLastError();
+        return nullptr;
+    }
+
+    // Keeping it would evict everything else and still exceed the budget
+    if (size > maxBytes_) {
+        return inspector;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    insert(Slot{ path, size, mtime, inspector });
+    return inspector;
+}
+
+DocumentCache::Counters DocumentCache::counters() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Counters counters = counters_;
+    counters.documents = slots_.size();
+    counters.bytes = bytes_;
+    return counters;
+}
+
+void DocumentCache::insert(Slot slot) {
+    // Another thread may have loaded the same document in the meantime
+    auto found = index_.find(slot.path);
+    if (found != index_.end()) {
+        bytes_ -= found->second->size;
+        slots_.erase(found->second);
+        index_.erase(found);
+    }
+
+    bytes_ += slot.size;
+    slots_.push_front(std::move(slot));
+    index_[slots_.front().path] = slots_.begin();
+
+    while (slots_.size() > capacity_ || bytes_ > maxBytes_) {
+        bytes_ -= slots_.back().size;
+        index_.erase(slots_.back().path);
+        slots_.pop_back();
+        ++counters_.evictions;
+    }
+}
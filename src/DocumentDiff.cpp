@@ -0,0 +1,239 @@
+#include "DocumentDiff.h"
+#include <iomanip>
+#include <thread>
+
+namespace {
+
+// Longest attribute value or text shown per change
+constexpr size_t kMaxValueChars = 60;
+
+// Quoted, shortened on a UTF-8 boundary, control characters blanked
+std::string quote(std::string_view value) {
+    bool truncated = value.size() > kMaxValueChars;
+    if (truncated) {
+        size_t end = kMaxValueChars;
+        while (end > 0 && (static_cast<unsigned char>(value[end]) & 0xC0) == 0x80) {
+            --end;
+        }
+        value = value.substr(0, end);
+    }
+
+    std::string quoted = "\"";
+    for (char c : value) {
+        quoted += static_cast<unsigned char>(c) < 0x20 ? ' ' : c;
+    }
+    quoted += truncated ? "...\"" : "\"";
+    return quoted;
+}
+
+char stateMark(DocumentDiff::EntryState state) {
+    switch (state) {
+        case DocumentDiff::EntryState::Identical: return ' ';
+        case DocumentDiff::EntryState::Modified:  return 'M';
+        case DocumentDiff::EntryState::Added:     return 'A';
+        case DocumentDiff::EntryState::Removed:   return 'D';
+    }
+    return '?';
+}
+
+} // namespace
+
+DocumentDiff::DocumentDiff(const ODFInspector& before, const ODFInspector& after)
+    : before_(before)
+    , after_(after) {
+}
+
+bool DocumentDiff::compareEntries() {
+    entries_.clear();
+    bool flat = before_.getInfo().flat || after_.getInfo().flat;
+
+    for (const ZipEntry& entry : before_.getEntries()) {
+        Entry diff;
+        diff.name = entry.name;
+        diff.before = &entry;
+        diff.after = after_.findEntry(entry.name);
+
+        if (diff.after == nullptr) {
+            diff.state = EntryState::Removed;
+        } else if (entry.uncompressedSize != diff.after->uncompressedSize) {
+            diff.state = EntryState::Modified;
+        } else if (!flat) {
+            diff.state = entry.crc32 == diff.after->crc32 ? EntryState::Identical : EntryState::Modified;
+        } else {
+            // Sections have no checksum to go by
+            if (!sameContent(entry.name)) {
+                if (!lastError_.empty()) {
+                    return false;
+                }
+                diff.state = EntryState::Modified;
+            }
+        }
+        entries_.push_back(std::move(diff));
+    }
+
+    for (const ZipEntry& entry : after_.getEntries()) {
+        if (before_.findEntry(entry.name) == nullptr) {
+            Entry diff;
+            diff.name = entry.name;
+            diff.state = EntryState::Added;
+            diff.after = &entry;
+            entries_.push_back(std::move(diff));
+        }
+    }
+    return true;
+}
+
+const std::vector<DocumentDiff::Entry>& DocumentDiff::entries() const {
+    return entries_;
+}
+
+bool DocumentDiff::hasChanges() const {
+    for (const Entry& entry : entries_) {
+        if (entry.state != EntryState::Identical) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DocumentDiff::diffEntry(const Entry& entry, const XmlDiff::Callback& callback, size_t& changes) const {
+    changes = 0;
+
+    // The two sides are read and parsed independently, so the new one is
+    // done on a second thread
+    struct Side {
+        const ODFInspector* inspector;
+        std::string buffer;
+        std::string_view data;
+        XmlTree tree;
+        std::string error;
+
+        void load(const std::string& name) {
+            if (!inspector->readEntry(name, buffer, data)) {
+                error = inspector->getLastError();
+            } else if (!tree.build(data)) {
+                error = tree.getLastError();
+            }
+        }
+    };
+
+    Side before;
+    Side after;
+    before.inspector = &before_;
+    after.inspector = &after_;
+
+    std::thread worker([&after, &entry]() { after.load(entry.name); });
+    before.load(entry.name);
+    worker.join();
+
+    if (!before.error.empty() || !after.error.empty()) {
+        lastError_ = entry.name + ": " + (before.error.empty() ? after.error : before.error);
+        return false;
+    }
+
+    XmlDiff diff(before.tree, after.tree);
+    changes = diff.run(callback);
+    return true;
+}
+
+bool DocumentDiff::write(std::ostream& out) const {
+    out << "\n========================================\n";
+    out << "DOCUMENT DIFF\n";
+    out << "========================================\n\n";
+    out << "Old: " << before_.getInfo().path << "\n";
+    out << "New: " << after_.getInfo().path << "\n\n";
+
+    size_t counts[4] = {};
+    for (const Entry& entry : entries_) {
+        ++counts[static_cast<size_t>(entry.state)];
+        if (entry.state == EntryState::Identical) {
+            continue;
+        }
+
+        out << "  " << stateMark(entry.state) << " " << std::setw(40) << std::left << entry.name << std::right;
+        if (entry.state == EntryState::Modified) {
+            out << std::setw(10) << entry.before->uncompressedSize << " -> "
+                << entry.after->uncompressedSize << " bytes\n";
+        } else {
+            const ZipEntry* zip = entry.before != nullptr ? entry.before : entry.after;
+            out << std::setw(10) << zip->uncompressedSize << " bytes\n";
+        }
+    }
+    out << "\nEntries: " << counts[static_cast<size_t>(EntryState::Identical)] << " identical, "
+        << counts[static_cast<size_t>(EntryState::Modified)] << " modified, "
+        << counts[static_cast<size_t>(EntryState::Added)] << " added, "
+        << counts[static_cast<size_t>(EntryState::Removed)] << " removed\n";
+
+    bool ok = true;
+    for (const Entry& entry : entries_) {
+        if (entry.state != EntryState::Modified || !isXml(entry.name)) {
+            continue;
+        }
+
+        out << "\n" << entry.name << ":\n";
+        size_t changes = 0;
+        bool diffed = diffEntry(entry, [&out](const XmlDiff::Change& change) {
+            switch (change.type) {
+                case XmlDiff::ChangeType::Added:
+                    out << "  + " << change.path;
+                    if (!change.after.empty()) {
+                        out << ": " << quote(change.after);
+                    }
+                    break;
+                case XmlDiff::ChangeType::Removed:
+                    out << "  - " << change.path;
+                    if (!change.before.empty()) {
+                        out << ": " << quote(change.before);
+                    }
+                    break;
+                case XmlDiff::ChangeType::Changed:
+                    out << "  ~ " << change.path << ": " << quote(change.before) << " -> " << quote(change.after);
+                    break;
+            }
+            out << "\n";
+        }, changes);
+
+        if (!diffed) {
+            out << "  Error: " << lastError_ << "\n";
+            ok = false;
+        } else if (changes == 0) {
+            // Same tree, different bytes: attribute order, entities, ...
+            out << "  No structural changes\n";
+        } else {
+            out << "  (" << changes << (changes == 1 ? " change" : " changes") << ")\n";
+        }
+    }
+
+    if (!hasChanges()) {
+        out << "\nDocuments are identical\n";
+    }
+    out << "\n========================================\n\n";
+    return ok;
+}
+
+std::string DocumentDiff::getLastError() const {
+    return lastError_;
+}
+
+bool DocumentDiff::isXml(const std::string& name) {
+    return (name.size() > 4 && name.compare(name.size() - 4, 4, ".xml") == 0) ||
+           name.compare(0, 7, "office:") == 0;
+}
+
+bool DocumentDiff::sameContent(const std::string& name) const {
+    std::string beforeBuffer;
+    std::string afterBuffer;
+    std::string_view before;
+    std::string_view after;
+    lastError_.clear();
+
+    if (!before_.readEntry(name, beforeBuffer, before)) {
+        lastError_ = before_.getLastError();
+        return false;
+    }
+    if (!after_.readEntry(name, afterBuffer, after)) {
+        lastError_ = after_.getLastError();
+        return false;
+    }
+    return before == after;
+}
@@ -0,0 +1,179 @@
+#include "FlatODF.h"
+#include "XmlTokenizer.h"
+
+namespace {
+
+constexpr size_t kNoSection = FlatODF::kSectionCount;
+
+std::string_view trimEnd(std::string_view text) {
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return end == std::string_view::npos ? std::string_view() : text.substr(0, end + 1);
+}
+
+bool endsWith(std::string_view text, std::string_view suffix) {
+    return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+}
+
+// Find the end of office:body from the end of the file: a well-formed
+// document ends with "</office:body></office:document>" plus whitespace.
+// Anything else (comments, unusual spacing) leaves it to the full scan.
+bool findBodyEndFromTail(std::string_view rest, const char*& bodyEnd) {
+    constexpr std::string_view kDocumentEnd = "</office:document>";
+    rest = trimEnd(rest);
+    if (!endsWith(rest, kDocumentEnd)) {
+        return false;
+    }
+    rest = trimEnd(rest.substr(0, rest.size() - kDocumentEnd.size()));
+    if (!endsWith(rest, "</office:body>")) {
+        return false;
+    }
+    bodyEnd = rest.data() + rest.size();
+    return true;
+}
+
+} // namespace
+
+FlatODF::FlatODF()
+    : isOpen_(false)
+    , isXml_(false) {
+}
+
+bool FlatODF::open(const std::string& path, bool privateCopy) {
+    close();
+
+    if (!(privateCopy ? mapping_.openCopy(path) : mapping_.open(path))) {
+        lastError_ = mapping_.getLastError();
+        return false;
+    }
+
+    if (!scan()) {
+        mapping_.close();
+        sections_ = {};
+        mimeType_.clear();
+        return false;
+    }
+
+    isOpen_ = true;
+    return true;
+}
+
+void FlatODF::close() {
+    mapping_.close();
+    mimeType_.clear();
+    sections_ = {};
+    isOpen_ = false;
+    isXml_ = false;
+}
+
+bool FlatODF::isOpen() const {
+    return isOpen_;
+}
+
+bool FlatODF::isXml() const {
+    return isXml_;
+}
+
+const std::string& FlatODF::getMimeType() const {
+    return mimeType_;
+}
+
+std::string_view FlatODF::section(Section section) const {
+    return sections_[static_cast<size_t>(section)];
+}
+
+const char* FlatODF::name(Section section) {
+    switch (section) {
+        case Section::Meta:   return "office:meta";
+        case Section::Styles: return "office:styles";
+        case Section::Body:   return "office:body";
+    }
+    return "";
+}
+
+std::string FlatODF::getLastError() const {
+    return lastError_;
+}
+
+bool FlatODF::scan() {
+    std::string_view document = mapping_.view();
+
+    // Skip a UTF-8 byte order mark and leading whitespace
+    if (document.substr(0, 3) == "\xEF\xBB\xBF") {
+        document.remove_prefix(3);
+    }
+    size_t first = document.find_first_not_of(" \t\r\n");
+    isXml_ = first != std::string_view::npos && document[first] == '<';
+    if (!isXml_) {
+        lastError_ = "Not an XML document";
+        return false;
+    }
+
+    XmlTokenizer tokenizer(document);
+    XmlTokenizer::Token token;
+    bool haveRoot = false;
+    bool rootClosed = false;
+    size_t current = kNoSection;    // Section whose end tag is pending
+    const char* sectionStart = nullptr;
+
+    while (tokenizer.next(token)) {
+        if (token.type == XmlTokenizer::TokenType::StartElement) {
+            // Depth of the element's parent; empty elements don't nest
+            size_t parentDepth = tokenizer.depth() - (token.selfClosing ? 0 : 1);
+
+            if (parentDepth == 0) {
+                if (token.name != "office:document") {
+                    lastError_ = "Root element is " + std::string(token.name) + ", not office:document";
+                    return false;
+                }
+                haveRoot = true;
+                continue;   // Its attributes follow
+            }
+
+            tokenizer.skipAttributes();
+            if (parentDepth != 1) {
+                continue;
+            }
+
+            for (size_t i = 0; i < kSectionCount; ++i) {
+                if (token.name == name(static_cast<Section>(i))) {
+                    current = i;
+                    sectionStart = token.raw.data();
+                }
+            }
+
+            if (current == static_cast<size_t>(Section::Body) && !token.selfClosing) {
+                size_t contentStart = static_cast<size_t>(token.raw.data() + token.raw.size() - document.data());
+                const char* bodyEnd = nullptr;
+                if (findBodyEndFromTail(document.substr(contentStart), bodyEnd)) {
+                    sections_[current] = std::string_view(sectionStart, static_cast<size_t>(bodyEnd - sectionStart));
+                    return true;
+                }
+            }
+        } else if (token.type == XmlTokenizer::TokenType::Attribute) {
+            // Only the root's attributes are read, all others are skipped
+            if (token.name == "office:mimetype") {
+                XmlTokenizer::decodeEntities(token.value, mimeType_);
+            }
+        } else if (token.type == XmlTokenizer::TokenType::EndElement) {
+            if (tokenizer.depth() == 0) {
+                rootClosed = true;
+                break;
+            }
+            if (tokenizer.depth() == 1 && current != kNoSection) {
+                const char* end = document.data() + tokenizer.offset();
+                sections_[current] = std::string_view(sectionStart, static_cast<size_t>(end - sectionStart));
+                current = kNoSection;
+            }
+        }
+    }
+
+    if (tokenizer.hasError() || (haveRoot && !rootClosed)) {
+        lastError_ = "Malformed XML near byte " + std::to_string(tokenizer.offset());
+        return false;
+    }
+    if (!haveRoot) {
+        lastError_ = "No office:document root element";
+        return false;
+    }
+    return true;
+}
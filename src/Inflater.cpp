@@ -0,0 +1,204 @@
+#include "Inflater.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <zlib.h>
+
+#ifdef HAVE_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+
+#ifdef HAVE_ZLIB_NG
+// Defined in InflaterZlibNg.cpp; zlib-ng's header clashes with zlib's
+std::unique_ptr<Inflater> createZlibNgInflater();
+#endif
+
+namespace {
+
+/**
+ * @brief Stock zlib; the stream is initialised once and reset per call
+ */
+class ZlibInflater : public Inflater {
+public:
+    ZlibInflater() {
+        std::memset(&stream_, 0, sizeof(stream_));
+        initialised_ = inflateInit2(&stream_, -MAX_WBITS) == Z_OK;
+    }
+
+    ~ZlibInflater() override {
+        if (initialised_) {
+            inflateEnd(&stream_);
+        }
+    }
+
+    bool inflate(const char* in, size_t inSize, char* out, size_t outSize) override {
+        if (!initialised_ || inflateReset(&stream_) != Z_OK) {
+            return false;
+        }
+
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+        stream_.next_out = reinterpret_cast<Bytef*>(out);
+
+        // avail_in/avail_out are 32-bit, so feed huge entries in slices
+        constexpr size_t kMaxSlice = 1u << 30;
+        size_t inLeft = inSize;
+        size_t outLeft = outSize;
+        int status;
+        do {
+            if (stream_.avail_in == 0 && inLeft > 0) {
+                size_t slice = std::min(inLeft, kMaxSlice);
+                stream_.avail_in = static_cast<uInt>(slice);
+                inLeft -= slice;
+            }
+            if (stream_.avail_out == 0 && outLeft > 0) {
+                size_t slice = std::min(outLeft, kMaxSlice);
+                stream_.avail_out = static_cast<uInt>(slice);
+                outLeft -= slice;
+            }
+            // Z_FINISH on the last slice lets inflate skip its window copy;
+            // truncated input or overlong output ends with Z_BUF_ERROR
+            status = ::inflate(&stream_, inLeft == 0 && outLeft == 0 ? Z_FINISH : Z_NO_FLUSH);
+        } while (status == Z_OK);
+
+        return status == Z_STREAM_END && outLeft == 0 && stream_.avail_out == 0;
+    }
+
+private:
+    z_stream stream_;
+    bool initialised_;
+};
+
+#ifdef HAVE_LIBDEFLATE
+/**
+ * @brief libdeflate; decodes a whole buffer at once, no streaming state
+ */
+class LibdeflateInflater : public Inflater {
+public:
+    LibdeflateInflater()
+        : decompressor_(libdeflate_alloc_decompressor()) {
+    }
+
+    ~LibdeflateInflater() override {
+        if (decompressor_ != nullptr) {
+            libdeflate_free_decompressor(decompressor_);
+        }
+    }
+
+    bool inflate(const char* in, size_t inSize, char* out, size_t outSize) override {
+        // A null actual-size pointer makes anything but exactly outSize an error
+        return decompressor_ != nullptr &&
+               libdeflate_deflate_decompress(decompressor_, in, inSize, out, outSize, nullptr) ==
+                   LIBDEFLATE_SUCCESS;
+    }
+
+private:
+    libdeflate_decompressor* decompressor_;
+};
+#endif
+
+Inflater::Backend initialDefault() {
+#ifdef ODF_DEFAULT_INFLATE
+    Inflater::Backend configured;
+    if (Inflater::fromName(ODF_DEFAULT_INFLATE, configured) && Inflater::isAvailable(configured)) {
+        return configured;
+    }
+#endif
+    // Otherwise the fastest one built in
+#if defined(HAVE_LIBDEFLATE)
+    return Inflater::Backend::Libdeflate;
+#elif defined(HAVE_ZLIB_NG)
+    return Inflater::Backend::ZlibNg;
+#else
+    return Inflater::Backend::Zlib;
+#endif
+}
+
+std::atomic<Inflater::Backend>& defaultBackend() {
+    static std::atomic<Inflater::Backend> backend(initialDefault());
+    return backend;
+}
+
+} // namespace
+
+std::unique_ptr<Inflater> Inflater::create(Backend backend) {
+    switch (backend) {
+        case Backend::Zlib:
+            return std::make_unique<ZlibInflater>();
+        case Backend::ZlibNg:
+#ifdef HAVE_ZLIB_NG
+            return createZlibNgInflater();
+#else
+            break;
+#endif
+        case Backend::Libdeflate:
+#ifdef HAVE_LIBDEFLATE
+            return std::make_unique<LibdeflateInflater>();
+#else
+            break;
+#endif
+    }
+    return nullptr;
+}
+
+Inflater& Inflater::forThread(Backend backend) {
+    thread_local std::array<std::unique_ptr<Inflater>, kBackendCount> inflaters;
+
+    std::unique_ptr<Inflater>& inflater = inflaters[static_cast<size_t>(backend)];
+    if (!inflater) {
+        inflater = create(backend);
+    }
+    return *inflater;
+}
+
+bool Inflater::isAvailable(Backend backend) {
+    switch (backend) {
+        case Backend::Zlib:
+            return true;
+        case Backend::ZlibNg:
+#ifdef HAVE_ZLIB_NG
+            return true;
+#else
+            return false;
+#endif
+        case Backend::Libdeflate:
+#ifdef HAVE_LIBDEFLATE
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+Inflater::Backend Inflater::getDefault() {
+    return defaultBackend().load(std::memory_order_relaxed);
+}
+
+bool Inflater::setDefault(Backend backend) {
+    if (!isAvailable(backend)) {
+        return false;
+    }
+    defaultBackend().store(backend, std::memory_order_relaxed);
+    return true;
+}
+
+const char* Inflater::name(Backend backend) {
+    switch (backend) {
+        case Backend::Zlib:       return "zlib";
+        case Backend::ZlibNg:     return "zlib-ng";
+        case Backend::Libdeflate: return "libdeflate";
+    }
+    return "";
+}
+
+bool Inflater::fromName(std::string_view name, Backend& backend) {
+    for (size_t i = 0; i < kBackendCount; ++i) {
+        auto candidate = static_cast<Backend>(i);
+        if (name == Inflater::name(candidate)) {
+            backend = candidate;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,64 @@
+// zlib-ng backend of Inflater, built when ODF_WITH_ZLIB_NG is on. Kept in
+// its own file because zlib-ng's native header redefines zlib's macros.
+#include "Inflater.h"
+#include <algorithm>
+#include <cstring>
+#include <zlib-ng.h>
+
+namespace {
+
+/**
+ * @brief zlib-ng's native API; same structure as the zlib backend
+ */
+class ZlibNgInflater : public Inflater {
+public:
+    ZlibNgInflater() {
+        std::memset(&stream_, 0, sizeof(stream_));
+        initialised_ = zng_inflateInit2(&stream_, -MAX_WBITS) == Z_OK;
+    }
+
+    ~ZlibNgInflater() override {
+        if (initialised_) {
+            zng_inflateEnd(&stream_);
+        }
+    }
+
+    bool inflate(const char* in, size_t inSize, char* out, size_t outSize) override {
+        if (!initialised_ || zng_inflateReset(&stream_) != Z_OK) {
+            return false;
+        }
+
+        stream_.next_in = reinterpret_cast<const uint8_t*>(in);
+        stream_.next_out = reinterpret_cast<uint8_t*>(out);
+
+        constexpr size_t kMaxSlice = 1u << 30;
+        size_t inLeft = inSize;
+        size_t outLeft = outSize;
+        int32_t status;
+        do {
+            if (stream_.avail_in == 0 && inLeft > 0) {
+                size_t slice = std::min(inLeft, kMaxSlice);
+                stream_.avail_in = static_cast<uint32_t>(slice);
+                inLeft -= slice;
+            }
+            if (stream_.avail_out == 0 && outLeft > 0) {
+                size_t slice = std::min(outLeft, kMaxSlice);
+                stream_.avail_out = static_cast<uint32_t>(slice);
+                outLeft -= slice;
+            }
+            status = zng_inflate(&stream_, inLeft == 0 && outLeft == 0 ? Z_FINISH : Z_NO_FLUSH);
+        } while (status == Z_OK);
+
+        return status == Z_STREAM_END && outLeft == 0 && stream_.avail_out == 0;
+    }
+
+private:
+    zng_stream stream_;
+    bool initialised_;
+};
+
+} // namespace
+
+std::unique_ptr<Inflater> createZlibNgInflater() {
+    return std::make_unique<ZlibNgInflater>();
+}
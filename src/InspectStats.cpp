@@ -0,0 +1,33 @@
+#include "InspectStats.h"
+
+const char* InspectStats::name(Phase phase) {
+    switch (phase) {
+        case Phase::Total:      return "total";
+        case Phase::Open:       return "open";
+        case Phase::Directory:  return "directory";
+        case Phase::Locate:     return "locate";
+        case Phase::Inflate:    return "inflate";
+        case Phase::Format:     return "format";
+        case Phase::Text:       return "text";
+        case Phase::Parse:      return "parse";
+        case Phase::Output:     return "output";
+        case Phase::Count:      break;
+    }
+    return "";
+}
+
+const char* InspectStats::name(Counter counter) {
+    switch (counter) {
+        case Counter::Entries:        return "entries";
+        case Counter::Lookups:        return "lookups";
+        case Counter::Seeks:          return "seeks";
+        case Counter::BytesInflated:  return "bytesInflated";
+        case Counter::BytesCopied:    return "bytesCopied";
+        case Counter::Allocations:    return "allocations";
+        case Counter::AllocatedBytes: return "allocatedBytes";
+        case Counter::BytesFormatted: return "bytesFormatted";
+        case Counter::BytesText:      return "bytesText";
+        case Counter::Count:          break;
+    }
+    return "";
+}
@@ -0,0 +1,288 @@
+#include "InspectionCache.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+// "ODFICACH" followed by the format version
+constexpr char kMagic[8] = { 'O', 'D', 'F', 'I', 'C', 'A', 'C', 'H' };
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderSize = sizeof(kMagic) + 4;
+
+void putLE(std::string& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void putString(std::string& out, std::string_view text) {
+    putLE(out, text.size(), 4);
+    out.append(text.data(), text.size());
+}
+
+/**
+ * @brief Bounds-checked little-endian reader over one record
+ */
+class RecordReader {
+public:
+    explicit RecordReader(std::string_view data)
+        : data_(data)
+        , pos_(0)
+        , ok_(true) {
+    }
+
+    uint64_t number(size_t bytes) {
+        if (!ok_ || data_.size() - pos_ < bytes) {
+            ok_ = false;
+            return 0;
+        }
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(data_[pos_ + i])) << (8 * i);
+        }
+        pos_ += bytes;
+        return value;
+    }
+
+    std::string_view text() {
+        uint64_t length = number(4);
+        if (!ok_ || data_.size() - pos_ < length) {
+            ok_ = false;
+            return std::string_view();
+        }
+        std::string_view value = data_.substr(pos_, static_cast<size_t>(length));
+        pos_ += static_cast<size_t>(length);
+        return value;
+    }
+
+    bool ok() const {
+        return ok_;
+    }
+
+private:
+    std::string_view data_;
+    size_t pos_;
+    bool ok_;
+};
+
+} // namespace
+
+InspectionCache::InspectionCache(const std::string& cachePath)
+    : cachePath_(cachePath)
+    , dirty_(false) {
+}
+
+bool InspectionCache::load() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    mapped_.clear();
+    updated_.clear();
+    mapping_.close();
+    dirty_ = false;
+
+    std::error_code ec;
+    if (!std::filesystem::exists(cachePath_, ec)) {
+        return true;
+    }
+
+    if (!mapping_.open(cachePath_)) {
+        lastError_ = "Failed to open cache: " + mapping_.getLastError();
+        return false;
+    }
+
+    return indexRecords();
+}
+
+bool InspectionCache::save() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!dirty_) {
+        return true;
+    }
+
+    std::string data(kMagic, sizeof(kMagic));
+    putLE(data, kVersion, 4);
+
+    // Unchanged records are copied through without decoding them
+    for (const auto& [key, record] : mapped_) {
+        if (updated_.find(key) == updated_.end()) {
+            putLE(data, record.size(), 4);
+            data.append(record.data(), record.size());
+        }
+    }
+    for (const auto& [key, document] : updated_) {
+        std::string record;
+        encode(key, document, record);
+        putLE(data, record.size(), 4);
+        data += record;
+    }
+
+    // The old file must be unmapped before it can be replaced on Windows
+    mapped_.clear();
+    mapping_.close();
+
+    std::string tempPath = cachePath_ + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            lastError_ = "Failed to write cache: " + tempPath;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cachePath_, ec);
+    if (ec) {
+        lastError_ = "Failed to replace cache: " + cachePath_ + " (" + ec.message() + ")";
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    // Serve later lookups from the new file
+    updated_.clear();
+    dirty_ = false;
+    if (!mapping_.open(cachePath_)) {
+        lastError_ = "Failed to open cache: " + mapping_.getLastError();
+        return false;
+    }
+    return indexRecords();
+}
+
+bool InspectionCache::find(const std::string& path, Document& document) const {
+    std::string key = keyFor(path);
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto updated = updated_.find(key);
+    if (updated != updated_.end()) {
+        document = updated->second;
+        return true;
+    }
+
+    auto mapped = mapped_.find(key);
+    return mapped != mapped_.end() && decode(mapped->second, document);
+}
+
+void InspectionCache::store(const std::string& path, Document document) {
+    std::string key = keyFor(path);
+    std::lock_guard<std::mutex> lock(mutex_);
+    updated_[key] = std::move(document);
+    dirty_ = true;
+}
+
+size_t InspectionCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = updated_.size();
+    for (const auto& entry : mapped_) {
+        if (updated_.find(entry.first) == updated_.end()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+std::string InspectionCache::getLastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
+
+bool InspectionCache::indexRecords() {
+    std::string_view data = mapping_.view();
+    if (data.size() < kHeaderSize || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0 ||
+        RecordReader(data.substr(sizeof(kMagic))).number(4) != kVersion) {
+        lastError_ = "Not a cache file or unsupported version: " + cachePath_;
+        mapping_.close();
+        dirty_ = true;
+        return false;
+    }
+
+    // Only index the paths here; records are decoded when looked up
+    size_t pos = kHeaderSize;
+    while (pos < data.size()) {
+        RecordReader header(data.substr(pos));
+        uint64_t length = header.number(4);
+        if (!header.ok() || data.size() - pos - 4 < length) {
+            lastError_ = "Corrupt cache file: " + cachePath_;
+            dirty_ = true;
+            return false;
+        }
+
+        std::string_view record = data.substr(pos + 4, static_cast<size_t>(length));
+        RecordReader reader(record);
+        std::string_view key = reader.text();
+        if (!reader.ok()) {
+            lastError_ = "Corrupt cache file: " + cachePath_;
+            dirty_ = true;
+            return false;
+        }
+
+        // Later records replace earlier ones for the same document
+        mapped_[std::string(key)] = record;
+        pos += 4 + static_cast<size_t>(length);
+    }
+
+    return true;
+}
+
+bool InspectionCache::fileStamp(const std::string& path, uint64_t& size, int64_t& mtime) {
+    std::error_code ec;
+    size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    auto time = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return false;
+    }
+    mtime = static_cast<int64_t>(time.time_since_epoch().count());
+    return true;
+}
+
+std::string InspectionCache::keyFor(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+    return ec ? path : absolute.lexically_normal().string();
+}
+
+void InspectionCache::encode(const std::string& key, const Document& document, std::string& out) {
+    putString(out, key);
+    putLE(out, document.size, 8);
+    putLE(out, static_cast<uint64_t>(document.mtime), 8);
+    putLE(out, document.directoryCrc, 4);
+    putString(out, document.mimeType);
+
+    putLE(out, document.entries.size(), 4);
+    for (const auto& entry : document.entries) {
+        putString(out, entry.name);
+        putLE(out, entry.compressedSize, 8);
+        putLE(out, entry.uncompressedSize, 8);
+        putLE(out, entry.crc32, 4);
+        putLE(out, entry.method, 2);
+    }
+
+    putString(out, document.metaXml);
+}
+
+bool InspectionCache::decode(std::string_view record, Document& document) {
+    RecordReader reader(record);
+    reader.text();  // Key
+    document.size = reader.number(8);
+    document.mtime = static_cast<int64_t>(reader.number(8));
+    document.directoryCrc = static_cast<uint32_t>(reader.number(4));
+    document.mimeType = std::string(reader.text());
+
+    uint64_t count = reader.number(4);
+    document.entries.clear();
+    for (uint64_t i = 0; i < count && reader.ok(); ++i) {
+        ZipEntry entry;
+        entry.name = std::string(reader.text());
+        entry.compressedSize = reader.number(8);
+        entry.uncompressedSize = reader.number(8);
+        entry.crc32 = static_cast<uint32_t>(reader.number(4));
+        entry.method = static_cast<uint16_t>(reader.number(2));
+        entry.fileIndex = i;
+        document.entries.push_back(std::move(entry));
+    }
+
+    document.metaXml = std::string(reader.text());
+    return reader.ok();
+}
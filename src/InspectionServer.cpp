@@ -0,0 +1,314 @@
+#include "InspectionServer.h"
+#include "JsonSink.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Connections waiting for a worker, per worker
+constexpr size_t kQueuedConnectionsPerThread = 4;
+
+// How often run() checks for stop() while no client connects
+constexpr int kPollIntervalMs = 250;
+
+// A connection without a request for this long gives its worker back
+constexpr long kIdleTimeoutSeconds = 10;
+
+// Longest request line accepted
+constexpr size_t kMaxRequestSize = 64 * 1024;
+
+#ifndef _WIN32
+bool sendAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = ::send(fd, data, size, 0);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool sendResponse(int fd, const std::string& payload) {
+    std::string header = "OK " + std::to_string(payload.size()) + "\n";
+    return sendAll(fd, header.data(), header.size()) && sendAll(fd, payload.data(), payload.size());
+}
+
+bool sendError(int fd, std::string message) {
+    // Keep the status line a single line
+    std::replace(message.begin(), message.end(), '\n', ' ');
+    message = "ERROR " + message + "\n";
+    return sendAll(fd, message.data(), message.size());
+}
+#endif
+
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (;;) {
+        size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab == std::string::npos ? std::string::npos : tab - start));
+        if (tab == std::string::npos) {
+            return fields;
+        }
+        start = tab + 1;
+    }
+}
+
+} // namespace
+
+InspectionServer::InspectionServer(const std::string& socketPath, size_t threadCount, size_t cacheCapacity,
+                                   uint64_t cacheBytes)
+    : socketPath_(socketPath)
+    , threadCount_(threadCount)
+    , cache_(cacheCapacity, cacheBytes)
+    , listenFd_(-1)
+    , stopping_(false) {
+}
+
+InspectionServer::~InspectionServer() {
+#ifndef _WIN32
+    if (listenFd_ >= 0) {
+        ::close(listenFd_);
+        ::unlink(socketPath_.c_str());
+    }
+#endif
+}
+
+bool InspectionServer::start() {
+#ifdef _WIN32
+    lastError_ = "Server mode needs Unix domain sockets, which this build does not support";
+    return false;
+#else
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath_.size() >= sizeof(address.sun_path)) {
+        lastError_ = "Socket path too long: " + socketPath_;
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath_.c_str(), socketPath_.size() + 1);
+    const sockaddr* name = reinterpret_cast<const sockaddr*>(&address);
+
+    listenFd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd_ < 0) {
+        lastError_ = std::string("Failed to create socket: ") + std::strerror(errno);
+        return false;
+    }
+
+    int bound = ::bind(listenFd_, name, sizeof(address));
+    if (bound != 0 && errno == EADDRINUSE) {
+        // Left behind by a server that didn't shut down, unless it still answers
+        int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        bool live = probe >= 0 && ::connect(probe, name, sizeof(address)) == 0;
+        if (probe >= 0) {
+            ::close(probe);
+        }
+        if (live) {
+            lastError_ = "Another server is listening on " + socketPath_;
+            ::close(listenFd_);
+            listenFd_ = -1;
+            return false;
+        }
+        ::unlink(socketPath_.c_str());
+        bound = ::bind(listenFd_, name, sizeof(address));
+    }
+    if (bound != 0 || ::listen(listenFd_, SOMAXCONN) != 0) {
+        lastError_ = "Failed to listen on " + socketPath_ + ": " + std::strerror(errno);
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    return true;
+#endif
+}
+
+void InspectionServer::run() {
+#ifndef _WIN32
+    size_t threads = threadCount_ > 0
+        ? threadCount_ : std::max(1u, std::thread::hardware_concurrency());
+
+    // A full queue stops accepting, which pushes back on clients
+    ThreadPool workers(threads, kQueuedConnectionsPerThread * threads);
+
+    while (!stopping_) {
+        pollfd listener = { listenFd_, POLLIN, 0 };
+        if (::poll(&listener, 1, kPollIntervalMs) <= 0) {
+            continue;
+        }
+        int fd = ::accept(listenFd_, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+
+        timeval timeout = { kIdleTimeoutSeconds, 0 };
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        workers.submit([this, fd] {
+            try {
+                serveConnection(fd);
+            } catch (const std::exception&) {
+                // Costs this client its connection, nobody else anything
+            }
+            ::close(fd);
+        });
+    }
+
+    workers.wait();
+#endif
+}
+
+void InspectionServer::stop() {
+    stopping_ = true;
+}
+
+std::string InspectionServer::getLastError() const {
+    return lastError_;
+}
+
+void InspectionServer::serveConnection(int fd) {
+#ifndef _WIN32
+    std::string pending;
+    char buffer[4096];
+
+    for (;;) {
+        size_t newline;
+        while ((newline = pending.find('\n')) != std::string::npos) {
+            std::string line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty()) {
+                continue;
+            }
+            bool keepOpen;
+            try {
+                keepOpen = handleRequest(fd, line);
+            } catch (const std::exception& e) {
+                // A malformed document fails its request, not the server.
+                // Nothing has been sent yet: answers are sent whole, and
+                // entry streams handle their own failures.
+                keepOpen = sendError(fd, std::string("Internal error: ") + e.what());
+            }
+            if (!keepOpen) {
+                return;
+            }
+        }
+        if (pending.size() > kMaxRequestSize) {
+            sendError(fd, "Request too long");
+            return;
+        }
+
+        // Ends on close, on the idle timeout and on errors alike
+        ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0 || stopping_) {
+            return;
+        }
+        pending.append(buffer, static_cast<size_t>(received));
+    }
+#else
+    (void)fd;
+#endif
+}
+
+bool InspectionServer::handleRequest(int fd, const std::string& line) {
+#ifndef _WIN32
+    std::vector<std::string> fields = splitFields(line);
+    const std::string& command = fields[0];
+
+    if (command == "stats") {
+        DocumentCache::Counters counters = cache_.counters();
+        std::ostringstream out;
+        out << "documents " << counters.documents << "\n"
+            << "hits " << counters.hits << "\n"
+            << "misses " << counters.misses << "\n"
+            << "invalidations " << counters.invalidations << "\n"
+            << "evictions " << counters.evictions << "\n"
+            << "bytes " << counters.bytes << "\n";
+        return sendResponse(fd, out.str());
+    }
+
+    bool isFile = command == "file";
+    if (command != "summary" && command != "structure" && command != "metadata" &&
+        command != "json" && !isFile) {
+        return sendError(fd, "Unknown command: " + command);
+    }
+    if (fields.size() != (isFile ? 3u : 2u)) {
+        return sendError(fd, isFile ? "Usage: file<TAB>path<TAB>entry" : "Usage: " + command + "<TAB>path");
+    }
+
+    std::string error;
+    std::shared_ptr<const ODFInspector> inspector = cache_.get(fields[1], error);
+    if (!inspector) {
+        return sendError(fd, error);
+    }
+
+    if (isFile) {
+        const ZipEntry* entry = inspector->findEntry(fields[2]);
+        if (entry == nullptr) {
+            return sendError(fd, "File '" + fields[2] + "' not found in archive");
+        }
+
+        // Streamed straight to the client; the length is already known
+        // from the directory, so a failure halfway can only drop the
+        // connection
+        std::string header = "OK " + std::to_string(entry->uncompressedSize) + "\n";
+        if (!sendAll(fd, header.data(), header.size())) {
+            return false;
+        }
+        uint64_t sent = 0;
+        bool ok;
+        try {
+            ok = inspector->streamEntry(entry->name, [fd, &sent](const char* data, size_t size) {
+                sent += size;
+                return sendAll(fd, data, size);
+            });
+        } catch (const std::exception&) {
+            ok = false;
+        }
+        return ok && sent == entry->uncompressedSize;
+    }
+
+    std::ostringstream out;
+    if (command == "summary") {
+        inspector->displaySummary(out);
+    } else if (command == "structure") {
+        inspector->displayStructure(out);
+    } else if (command == "metadata") {
+        inspector->displayMetadata(out);
+    } else {
+        JsonSink sink(out);
+        sink.beginDocument(fields[1]);
+        inspector->writeSummary(sink);
+        inspector->writeStructure(sink);
+        inspector->writeMetadata(sink);
+        sink.endDocument();
+    }
+    return sendResponse(fd, out.str());
+#else
+    (void)fd;
+    (void)line;
+    return false;
+#endif
+}
@@ -0,0 +1,354 @@
+#include "JsonSink.h"
+#include <charconv>
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+bool needsEscape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+} // namespace
+
+JsonSink::JsonSink(std::ostream& out)
+    : out_(out)
+    , buffer_(ownBuffer_) {
+    buffer_.reserve(kFlushThreshold + kFlushThreshold / 4);
+}
+
+JsonSink::JsonSink(std::ostream& out, std::string& buffer)
+    : out_(out)
+    , buffer_(buffer) {
+    buffer_.clear();
+}
+
+JsonSink::~JsonSink() {
+    flush();
+}
+
+void JsonSink::flush() {
+    if (!buffer_.empty()) {
+        out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+}
+
+void JsonSink::discard() {
+    buffer_.clear();
+}
+
+void JsonSink::beginDocument(std::string_view path) {
+    buffer_ += '{';
+    field("path", path);
+}
+
+void JsonSink::endDocument() {
+    buffer_ += "}\n";
+    if (buffer_.size() >= kFlushThreshold) {
+        flush();
+    }
+}
+
+void JsonSink::summary(const Summary& summary) {
+    key("summary");
+    buffer_ += '{';
+    field("mimeType", summary.mimeType);
+    field("documentType", summary.documentType);
+    key("valid");
+    boolean(summary.valid);
+    key("flat");
+    boolean(summary.flat);
+    key("fileCount");
+    number(summary.fileCount);
+    key("content");
+    boolean(summary.hasContent);
+    key("meta");
+    boolean(summary.hasMeta);
+    key("styles");
+    boolean(summary.hasStyles);
+    key("manifest");
+    boolean(summary.hasManifest);
+    buffer_ += '}';
+}
+
+void JsonSink::structure(const std::vector<ZipEntry>& entries) {
+    key("structure");
+    buffer_ += '[';
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (i > 0) {
+            buffer_ += ',';
+        }
+        entry(entries[i]);
+    }
+    buffer_ += ']';
+}
+
+void JsonSink::metadata(const ODFMetadata* metadata) {
+    key("metadata");
+    if (metadata == nullptr) {
+        buffer_ += "null";
+        return;
+    }
+
+    const ODFMetadata& m = *metadata;
+    buffer_ += '{';
+
+    const std::pair<std::string_view, const std::string&> texts[] = {
+        { "title", m.title },
+        { "subject", m.subject },
+        { "description", m.description },
+        { "language", m.language },
+        { "creator", m.creator },
+        { "initialCreator", m.initialCreator },
+        { "creationDate", m.creationDate },
+        { "date", m.date },
+        { "printedBy", m.printedBy },
+        { "printDate", m.printDate },
+        { "generator", m.generator },
+        { "editingDuration", m.editingDuration }
+    };
+    for (const auto& [name, value] : texts) {
+        if (!value.empty()) {
+            field(name, value);
+        }
+    }
+
+    if (!m.keywords.empty()) {
+        key("keywords");
+        buffer_ += '[';
+        for (size_t i = 0; i < m.keywords.size(); ++i) {
+            if (i > 0) {
+                buffer_ += ',';
+            }
+            string(m.keywords[i]);
+        }
+        buffer_ += ']';
+    }
+    if (m.editingCycles) {
+        key("editingCycles");
+        number(*m.editingCycles);
+    }
+    if (m.editingSeconds) {
+        key("editingSeconds");
+        number(*m.editingSeconds);
+    }
+    if (!m.templateInfo.href.empty()) {
+        key("template");
+        buffer_ += '{';
+        field("href", m.templateInfo.href);
+        field("title", m.templateInfo.title);
+        field("date", m.templateInfo.date);
+        buffer_ += '}';
+    }
+    if (!m.autoReload.href.empty()) {
+        key("autoReload");
+        buffer_ += '{';
+        field("href", m.autoReload.href);
+        field("delay", m.autoReload.delay);
+        buffer_ += '}';
+    }
+    if (!m.hyperlinkBehaviour.targetFrameName.empty() || !m.hyperlinkBehaviour.show.empty()) {
+        key("hyperlinkBehaviour");
+        buffer_ += '{';
+        field("targetFrameName", m.hyperlinkBehaviour.targetFrameName);
+        field("show", m.hyperlinkBehaviour.show);
+        buffer_ += '}';
+    }
+
+    const ODFMetadata::DocumentStatistic& stats = m.statistics;
+    const std::pair<std::string_view, const std::optional<uint64_t>&> counts[] = {
+        { "pageCount", stats.pageCount },
+        { "paragraphCount", stats.paragraphCount },
+        { "wordCount", stats.wordCount },
+        { "characterCount", stats.characterCount },
+        { "nonWhitespaceCharacterCount", stats.nonWhitespaceCharacterCount },
+        { "sentenceCount", stats.sentenceCount },
+        { "syllableCount", stats.syllableCount },
+        { "tableCount", stats.tableCount },
+        { "rowCount", stats.rowCount },
+        { "cellCount", stats.cellCount },
+        { "imageCount", stats.imageCount },
+        { "drawCount", stats.drawCount },
+        { "frameCount", stats.frameCount },
+        { "objectCount", stats.objectCount },
+        { "oleObjectCount", stats.oleObjectCount }
+    };
+    bool opened = false;
+    for (const auto& [name, count] : counts) {
+        if (count) {
+            if (!opened) {
+                key("statistics");
+                buffer_ += '{';
+                opened = true;
+            }
+            key(name);
+            number(*count);
+        }
+    }
+    if (opened) {
+        buffer_ += '}';
+    }
+
+    if (!m.userDefined.empty()) {
+        key("userDefined");
+        buffer_ += '[';
+        for (size_t i = 0; i < m.userDefined.size(); ++i) {
+            if (i > 0) {
+                buffer_ += ',';
+            }
+            buffer_ += '{';
+            field("name", m.userDefined[i].name);
+            field("type", m.userDefined[i].valueType);
+            field("value", m.userDefined[i].value);
+            buffer_ += '}';
+        }
+        buffer_ += ']';
+    }
+
+    buffer_ += '}';
+}
+
+void JsonSink::images(const std::vector<const ZipEntry*>& images) {
+    key("images");
+    buffer_ += '[';
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (i > 0) {
+            buffer_ += ',';
+        }
+        entry(*images[i]);
+    }
+    buffer_ += ']';
+}
+
+void JsonSink::tables(const std::vector<TableScanner::SheetStats>& sheets) {
+    key("tables");
+    buffer_ += '[';
+    for (size_t i = 0; i < sheets.size(); ++i) {
+        const TableScanner::SheetStats& sheet = sheets[i];
+        if (i > 0) {
+            buffer_ += ',';
+        }
+        buffer_ += '{';
+        field("name", sheet.name);
+        key("rows");
+        number(sheet.rows);
+        key("columns");
+        number(sheet.columns);
+        key("usedRange");
+        if (sheet.used) {
+            string(TableScanner::usedRange(sheet));
+        } else {
+            buffer_ += "null";
+        }
+        key("cells");
+        buffer_ += '{';
+        for (size_t t = 0; t < TableScanner::kCellTypeCount; ++t) {
+            key(TableScanner::name(static_cast<TableScanner::CellType>(t)));
+            number(sheet.cells[t]);
+        }
+        buffer_ += '}';
+        key("formulas");
+        number(sheet.formulas);
+        key("coveredCells");
+        number(sheet.coveredCells);
+        buffer_ += '}';
+    }
+    buffer_ += ']';
+}
+
+void JsonSink::error(std::string_view message) {
+    field("error", message);
+}
+
+void JsonSink::stats(const InspectStats& stats) {
+    key("stats");
+    buffer_ += '{';
+    key("timesNs");
+    buffer_ += '{';
+    for (size_t i = 0; i < InspectStats::kPhaseCount; ++i) {
+        auto phase = static_cast<InspectStats::Phase>(i);
+        key(InspectStats::name(phase));
+        number(stats.time(phase));
+    }
+    buffer_ += '}';
+    key("counters");
+    buffer_ += '{';
+    for (size_t i = 0; i < InspectStats::kCounterCount; ++i) {
+        auto counter = static_cast<InspectStats::Counter>(i);
+        key(InspectStats::name(counter));
+        number(stats.count(counter));
+    }
+    buffer_ += "}}";
+}
+
+void JsonSink::key(std::string_view name) {
+    // Every member but the first of an object is preceded by a comma
+    if (buffer_.back() != '{') {
+        buffer_ += ',';
+    }
+    string(name);
+    buffer_ += ':';
+}
+
+void JsonSink::string(std::string_view value) {
+    buffer_ += '"';
+
+    // Copy runs of plain characters in one go
+    size_t run = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (!needsEscape(c)) {
+            continue;
+        }
+
+        buffer_.append(value.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"':  buffer_ += "\\\""; break;
+            case '\\': buffer_ += "\\\\"; break;
+            case '\n': buffer_ += "\\n"; break;
+            case '\r': buffer_ += "\\r"; break;
+            case '\t': buffer_ += "\\t"; break;
+            case '\b': buffer_ += "\\b"; break;
+            case '\f': buffer_ += "\\f"; break;
+            default:
+                buffer_ += "\\u00";
+                buffer_ += kHexDigits[c >> 4];
+                buffer_ += kHexDigits[c & 0x0F];
+                break;
+        }
+    }
+    buffer_.append(value.data() + run, value.size() - run);
+
+    buffer_ += '"';
+}
+
+void JsonSink::number(uint64_t value) {
+    char digits[20];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer_.append(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+void JsonSink::boolean(bool value) {
+    buffer_ += value ? "true" : "false";
+}
+
+void JsonSink::field(std::string_view name, std::string_view value) {
+    key(name);
+    string(value);
+}
+
+void JsonSink::entry(const ZipEntry& entry) {
+    buffer_ += '{';
+    field("name", entry.name);
+    key("size");
+    number(entry.uncompressedSize);
+    key("compressedSize");
+    number(entry.compressedSize);
+    key("crc32");
+    number(entry.crc32);
+    key("method");
+    number(entry.method);
+    buffer_ += '}';
+}
@@ -0,0 +1,188 @@
+#include "MappedFile.h"
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : data_(nullptr)
+    , size_(0)
+    , isOpen_(false)
+#ifdef _WIN32
+    , fileHandle_(nullptr)
+    , mappingHandle_(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        lastError_ = "Failed to open file: " + path;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        lastError_ = "Failed to get file size: " + path;
+        return false;
+    }
+
+    fileHandle_ = file;
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+    isOpen_ = true;
+
+    // Empty files cannot be mapped; treat them as a valid zero-length view
+    if (size_ == 0) {
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        close();
+        lastError_ = "Failed to map file: " + path;
+        return false;
+    }
+    mappingHandle_ = mapping;
+
+    data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        close();
+        lastError_ = "Failed to map file: " + path;
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr && copy_.empty()) {
+        UnmapViewOfFile(data_);
+    }
+    if (mappingHandle_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(mappingHandle_));
+    }
+    if (fileHandle_ != nullptr) {
+        CloseHandle(static_cast<HANDLE>(fileHandle_));
+    }
+    std::vector<char>().swap(copy_);
+    data_ = nullptr;
+    mappingHandle_ = nullptr;
+    fileHandle_ = nullptr;
+    size_ = 0;
+    isOpen_ = false;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        lastError_ = "Failed to open file: " + path;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        lastError_ = "Failed to get file size: " + path;
+        return false;
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            size_ = 0;
+            lastError_ = "Failed to map file: " + path;
+            return false;
+        }
+        data_ = static_cast<const char*>(addr);
+    }
+
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+    isOpen_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_ != nullptr && copy_.empty()) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+    std::vector<char>().swap(copy_);
+    data_ = nullptr;
+    size_ = 0;
+    isOpen_ = false;
+}
+
+#endif
+
+bool MappedFile::openCopy(const std::string& path) {
+    close();
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    std::streamoff size = file ? static_cast<std::streamoff>(file.tellg()) : -1;
+    if (size < 0) {
+        lastError_ = "Failed to open file: " + path;
+        return false;
+    }
+
+    copy_.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(copy_.data(), static_cast<std::streamsize>(copy_.size()))) {
+        std::vector<char>().swap(copy_);
+        lastError_ = "Failed to read file: " + path;
+        return false;
+    }
+
+    data_ = copy_.empty() ? nullptr : copy_.data();
+    size_ = copy_.size();
+    isOpen_ = true;
+    return true;
+}
+
+bool MappedFile::isOpen() const {
+    return isOpen_;
+}
+
+const char* MappedFile::data() const {
+    return data_;
+}
+
+size_t MappedFile::size() const {
+    return size_;
+}
+
+std::string_view MappedFile::view() const {
+    return std::string_view(data_, size_);
+}
+
+std::string MappedFile::getLastError() const {
+    return lastError_;
+}
@@ -0,0 +1,203 @@
+#include "MediaDedup.h"
+#include "XxHash64.h"
+#include <algorithm>
+#include <iomanip>
+
+bool MediaDedup::add(const std::string& path, const ODFInspector& inspector) {
+    std::vector<const ZipEntry*> images = inspector.getImages();
+    bool ok = true;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++documents_;
+
+    for (const ZipEntry* image : images) {
+        if (image->uncompressedSize == 0) {
+            continue;   // Directory records
+        }
+        ++media_;
+        mediaBytes_ += image->uncompressedSize;
+
+        auto inserted = candidates_.try_emplace(Key{ image->crc32, image->uncompressedSize });
+        Candidate& candidate = inserted.first->second;
+        if (inserted.second) {
+            // Unique so far: nothing to read
+            candidate.document = path;
+            candidate.entry = image->name;
+            candidate.storedBytes = image->compressedSize;
+            continue;
+        }
+
+        // A second copy; the first one is hashed once, by whichever
+        // thread gets here first. Map nodes don't move, so the candidate
+        // stays valid while the lock is released.
+        if (!candidate.hashed && !candidate.hashing) {
+            candidate.hashing = true;
+            std::string document = candidate.document;
+            std::string entry = candidate.entry;
+            lock.unlock();
+
+            uint64_t hash = 0;
+            bool found = hashFirstCopy(path, inspector, document, entry, hash);
+
+            lock.lock();
+            if (found) {
+                Group first;
+                first.document = std::move(document);
+                first.entry = std::move(entry);
+                first.size = image->uncompressedSize;
+                first.crc32 = image->crc32;
+                first.hash = hash;
+                first.copies = 1;
+                first.storedBytes = candidate.storedBytes;
+                first.smallestStored = candidate.storedBytes;
+                candidate.variants.push_back(std::move(first));
+            } else {
+                // The copy this one is compared against is missing from
+                // the counts, so the report is incomplete
+                ok = false;
+            }
+            candidate.hashing = false;
+            candidate.hashed = true;
+            hashed_.notify_all();
+        }
+
+        lock.unlock();
+        uint64_t hash = 0;
+        bool read = hashEntry(inspector, image->name, hash);
+        lock.lock();
+
+        hashed_.wait(lock, [&candidate]() { return candidate.hashed; });
+        if (!read) {
+            ok = false;
+            continue;
+        }
+
+        auto variant = std::find_if(candidate.variants.begin(), candidate.variants.end(),
+                                    [hash](const Group& group) { return group.hash == hash; });
+        if (variant != candidate.variants.end()) {
+            ++variant->copies;
+            variant->storedBytes += image->compressedSize;
+            variant->smallestStored = std::min(variant->smallestStored, image->compressedSize);
+        } else {
+            // Same CRC and size, different bytes
+            Group group;
+            group.document = path;
+            group.entry = image->name;
+            group.size = image->uncompressedSize;
+            group.crc32 = image->crc32;
+            group.hash = hash;
+            group.copies = 1;
+            group.storedBytes = image->compressedSize;
+            group.smallestStored = image->compressedSize;
+            candidate.variants.push_back(std::move(group));
+        }
+    }
+    return ok;
+}
+
+std::vector<MediaDedup::Group> MediaDedup::duplicates() const {
+    std::vector<Group> groups;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& item : candidates_) {
+            for (const Group& group : item.second.variants) {
+                if (group.copies > 1) {
+                    groups.push_back(group);
+                }
+            }
+        }
+    }
+
+    std::sort(groups.begin(), groups.end(), [](const Group& a, const Group& b) {
+        uint64_t reclaimA = (a.copies - 1) * a.size;
+        uint64_t reclaimB = (b.copies - 1) * b.size;
+        if (reclaimA != reclaimB) {
+            return reclaimA > reclaimB;
+        }
+        return a.document != b.document ? a.document < b.document : a.entry < b.entry;
+    });
+    return groups;
+}
+
+void MediaDedup::write(std::ostream& out) const {
+    std::vector<Group> groups = duplicates();
+
+    uint64_t reclaimable = 0;
+    uint64_t storedReclaimable = 0;
+    uint64_t copies = 0;
+    for (const Group& group : groups) {
+        reclaimable += (group.copies - 1) * group.size;
+        storedReclaimable += group.storedBytes - group.smallestStored;
+        copies += group.copies;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    out << "\n========================================\n";
+    out << "DUPLICATE MEDIA\n";
+    out << "========================================\n\n";
+    out << "  Documents:            " << documents_ << "\n";
+    out << "  Media entries:        " << media_ << " (" << mediaBytes_ << " bytes)\n";
+    out << "  Distinct CRC + size:  " << candidates_.size() << "\n";
+    out << "  Hashed to confirm:    " << hashedEntries_ << " entries (" << hashedBytes_ << " bytes)\n";
+    out << "  Duplicate groups:     " << groups.size() << " (" << copies << " copies)\n";
+    out << "  Reclaimable:          " << reclaimable << " bytes (" << storedReclaimable
+        << " bytes compressed)\n\n";
+
+    if (groups.empty()) {
+        out << "  No duplicate media found\n";
+    } else {
+        out << "  " << std::setw(8) << "Copies" << std::setw(14) << "Size" << std::setw(16) << "Reclaimable"
+            << "  First copy\n";
+        for (const Group& group : groups) {
+            out << "  " << std::setw(8) << group.copies << std::setw(14) << group.size
+                << std::setw(16) << (group.copies - 1) * group.size
+                << "  " << group.document << ": " << group.entry << "\n";
+        }
+    }
+
+    out << "\n========================================\n\n";
+}
+
+std::string MediaDedup::getLastError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastError_;
+}
+
+bool MediaDedup::hashEntry(const ODFInspector& inspector, const std::string& entry, uint64_t& hash) {
+    // Streamed in bounded chunks, so a large video costs no more memory
+    // than a thumbnail
+    XxHash64 state;
+    uint64_t bytes = 0;
+    bool ok = inspector.streamEntry(entry, [&state, &bytes](const char* data, size_t size) {
+        state.update(data, size);
+        bytes += size;
+        return true;
+    });
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ok) {
+        lastError_ = entry + ": " + inspector.getLastError();
+        return false;
+    }
+    hash = state.digest();
+    ++hashedEntries_;
+    hashedBytes_ += bytes;
+    return true;
+}
+
+bool MediaDedup::hashFirstCopy(const std::string& path, const ODFInspector& inspector,
+                               const std::string& document, const std::string& entry, uint64_t& hash) {
+    if (document == path) {
+        return hashEntry(inspector, entry, hash);
+    }
+
+    // The first copy's document was closed long ago; open it again
+    ODFInspector first(document);
+    if (!first.load()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lastError_ = document + ": " + first.getLastError();
+        return false;
+    }
+    return hashEntry(first, entry, hash);
+}
@@ -1,44 +1,218 @@
 #include "ODFInspector.h"
+#include "TextSink.h"
+#include "XmlFormatter.h"
+#include "XmlTokenizer.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
-#include <iomanip>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace {
+
+// Characters of formatted XML shown by the preview views
+constexpr size_t kContentPreviewChars = 2000;
+constexpr size_t kStylesPreviewChars = 1500;
+
+// Previews inflate their part in chunks of this size and stop at the
+// first chunk that fills the preview
+constexpr size_t kPreviewChunkSize = 4096;
+
+// Run fn(0..count-1) on up to threadCount threads, including the caller
+template <typename Fn>
+void parallelFor(size_t count, size_t threadCount, Fn fn) {
+    size_t workers = std::min(count, threadCount);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto drain = [&]() {
+        for (size_t i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t t = 1; t < workers; ++t) {
+        threads.emplace_back(drain);
+    }
+    drain();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// Reject absolute paths and ".." components so entries can't escape the
+// output directory
+bool isSafeEntryPath(const std::string& name) {
+    if (name.empty() || name[0] == '/' || name[0] == '\\' || name.find(':') != std::string::npos) {
+        return false;
+    }
+    for (const auto& part : std::filesystem::path(name)) {
+        if (part == "..") {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
 
 ODFInspector::ODFInspector(const std::string& odfPath)
     : odfPath_(odfPath)
-    , zipReader_(std::make_unique<ZipReader>(odfPath))
-    , isLoaded_(false) {
+    , zipReader_(std::make_unique<ZipReader>(odfPath, ZipReader::Backend::Mapped))
+    , isLoaded_(false)
+    , loadedParts_(0)
+    , threadCount_(1)
+    , cache_(nullptr)
+    , stats_(nullptr)
+    , privateCopy_(false)
+    , fromCache_(false)
+    , metadataParsed_(false)
+    , manifestParsed_(false)
+    , builtTrees_(0) {
 }
 
 ODFInspector::~ODFInspector() = default;
 
 bool ODFInspector::load() {
+    InspectionCache::Document record;
+    bool haveRecord = false;
+    if (cache_ != nullptr && loadFromCache(record, haveRecord)) {
+        isLoaded_ = true;
+        return true;
+    }
+
     if (!zipReader_->open()) {
-        lastError_ = "Failed to open ODF file: " + zipReader_->getLastError();
-        return false;
+        isLoaded_ = loadFlat();
+        return isLoaded_;
     }
 
     if (!validateODF()) {
-        lastError_ = "Invalid ODF file";
+        setError("Invalid ODF file");
         return false;
     }
 
-    if (!extractCoreFiles()) {
-        lastError_ = "Failed to extract core ODF files";
+    isLoaded_ = true;
+    if (cache_ != nullptr) {
+        updateCache(haveRecord ? &record : nullptr);
+    }
+    return true;
+}
+
+void ODFInspector::setCache(InspectionCache* cache) {
+    cache_ = cache;
+}
+
+void ODFInspector::setStats(InspectStats* stats) {
+    stats_ = stats;
+    zipReader_->setStats(stats);
+}
+
+void ODFInspector::setPrivateCopy(bool copy) {
+    privateCopy_ = copy;
+    zipReader_->setPrivateCopy(copy);
+}
+
+bool ODFInspector::loadFromCache(InspectionCache::Document& record, bool& haveRecord) {
+    haveRecord = cache_->find(odfPath_, record);
+
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    if (!haveRecord || !InspectionCache::fileStamp(odfPath_, size, mtime) ||
+        record.size != size || record.mtime != mtime) {
         return false;
     }
 
-    isLoaded_ = true;
+    mimeType_ = record.mimeType;
+    cachedEntries_ = std::move(record.entries);
+    metaXml_ = std::move(record.metaXml);
+    loadedParts_ |= 1u << static_cast<unsigned>(Part::Meta);
+    fromCache_ = true;
     return true;
 }
 
+void ODFInspector::updateCache(const InspectionCache::Document* previous) {
+    InspectionCache::Document record;
+    if (!InspectionCache::fileStamp(odfPath_, record.size, record.mtime)) {
+        return;
+    }
+    record.directoryCrc = zipReader_->directoryChecksum();
+    record.mimeType = mimeType_;
+    record.entries = zipReader_->entries();
+
+    // Only re-inflate meta.xml if its entry actually changed
+    if (previous != nullptr) {
+        const ZipEntry* meta = zipReader_->findEntry(partPath(Part::Meta));
+        auto old = std::find_if(previous->entries.begin(), previous->entries.end(),
+                                [](const ZipEntry& entry) { return entry.name == partPath(Part::Meta); });
+        bool unchanged = previous->directoryCrc == record.directoryCrc ||
+                         (meta != nullptr && old != previous->entries.end() &&
+                          old->crc32 == meta->crc32 && old->uncompressedSize == meta->uncompressedSize);
+        if (unchanged) {
+            std::lock_guard<std::mutex> lock(partsMutex_);
+            metaXml_ = previous->metaXml;
+            loadedParts_ |= 1u << static_cast<unsigned>(Part::Meta);
+        }
+    }
+
+    record.metaXml = std::string(loadPart(Part::Meta));
+    cache_->store(odfPath_, std::move(record));
+}
+
+bool ODFInspector::ensureArchive() const {
+    std::lock_guard<std::mutex> lock(archiveMutex_);
+    if (zipReader_->isOpen()) {
+        return true;
+    }
+    if (!zipReader_->open()) {
+        setError("Failed to open ODF file: " + zipReader_->getLastError());
+        return false;
+    }
+    return true;
+}
+
+const std::vector<ZipEntry>& ODFInspector::archiveEntries() const {
+    if (flat_) {
+        return sectionEntries_;
+    }
+    return fromCache_ ? cachedEntries_ : zipReader_->entries();
+}
+
+const ZipEntry* ODFInspector::findArchiveEntry(const std::string& name) const {
+    if (!fromCache_ && !flat_) {
+        return zipReader_->findEntry(name);
+    }
+    for (const auto& entry : archiveEntries()) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
 bool ODFInspector::validateODF() {
     // Check for mimetype file
     if (!zipReader_->fileExists("mimetype")) {
         return false;
     }
 
-    mimeType_ = zipReader_->extractFile("mimetype");
+    // The mimetype entry is normally stored uncompressed, so read it
+    // straight out of the mapping when possible
+    std::string_view mimeView;
+    if (zipReader_->viewFile("mimetype", mimeView)) {
+        mimeType_.assign(mimeView.data(), mimeView.size());
+    } else if (!zipReader_->extractFileTo("mimetype", mimeType_)) {
+        return false;
+    }
     
     // Remove any trailing whitespace
     mimeType_.erase(std::remove_if(mimeType_.begin(), mimeType_.end(), ::isspace), mimeType_.end());
@@ -47,217 +221,681 @@ bool ODFInspector::validateODF() {
     return mimeType_.find("application/vnd.oasis.opendocument") == 0;
 }
 
-bool ODFInspector::extractCoreFiles() {
-    // Extract key XML files
-    if (zipReader_->fileExists("content.xml")) {
-        contentXml_ = zipReader_->extractFile("content.xml");
+bool ODFInspector::loadFlat() {
+    auto flat = std::make_unique<FlatODF>();
+    bool opened;
+    {
+        InspectStats::Timer timer(stats_, InspectStats::Phase::Open);
+        opened = flat->open(odfPath_, privateCopy_);
     }
 
-    if (zipReader_->fileExists("meta.xml")) {
-        metaXml_ = zipReader_->extractFile("meta.xml");
+    // Report the archive error for files that aren't XML either
+    if (!opened) {
+        setError(flat->isXml() ? "Invalid flat ODF file: " + flat->getLastError()
+                               : "Failed to open ODF file: " + zipReader_->getLastError());
+        return false;
     }
 
-    if (zipReader_->fileExists("styles.xml")) {
-        stylesXml_ = zipReader_->extractFile("styles.xml");
+    mimeType_ = flat->getMimeType();
+    if (mimeType_.find("application/vnd.oasis.opendocument") != 0) {
+        setError("Invalid ODF file");
+        return false;
     }
 
-    if (zipReader_->fileExists("META-INF/manifest.xml")) {
-        manifestXml_ = zipReader_->extractFile("META-INF/manifest.xml");
+    for (size_t i = 0; i < FlatODF::kSectionCount; ++i) {
+        auto section = static_cast<FlatODF::Section>(i);
+        std::string_view data = flat->section(section);
+        if (data.empty()) {
+            continue;
+        }
+        ZipEntry entry;
+        entry.name = FlatODF::name(section);
+        entry.compressedSize = data.size();
+        entry.uncompressedSize = data.size();
+        sectionEntries_.push_back(std::move(entry));
     }
 
+    flat_ = std::move(flat);
     return true;
 }
 
-void ODFInspector::displaySummary() const {
+const char* ODFInspector::partPath(Part part) {
+    switch (part) {
+        case Part::Content:  return "content.xml";
+        case Part::Meta:     return "meta.xml";
+        case Part::Styles:   return "styles.xml";
+        case Part::Manifest: return "META-INF/manifest.xml";
+    }
+    return "";
+}
+
+std::string& ODFInspector::partBuffer(Part part) const {
+    switch (part) {
+        case Part::Content:  return contentXml_;
+        case Part::Meta:     return metaXml_;
+        case Part::Styles:   return stylesXml_;
+        case Part::Manifest: break;
+    }
+    return manifestXml_;
+}
+
+std::string_view ODFInspector::loadPart(Part part) const {
+    if (flat_) {
+        switch (part) {
+            case Part::Content:  return flat_->section(FlatODF::Section::Body);
+            case Part::Meta:     return flat_->section(FlatODF::Section::Meta);
+            case Part::Styles:   return flat_->section(FlatODF::Section::Styles);
+            case Part::Manifest: break;
+        }
+        return std::string_view();
+    }
+
+    std::string& target = partBuffer(part);
+    unsigned bit = 1u << static_cast<unsigned>(part);
+
+    {
+        std::lock_guard<std::mutex> lock(partsMutex_);
+        if ((loadedParts_ & bit) != 0) {
+            return target;
+        }
+    }
+
+    // Inflate outside the lock so different parts can load concurrently.
+    // A missing part simply stays empty.
+    std::string data;
+    if (ensureArchive() && zipReader_->fileExists(partPath(part))) {
+        zipReader_->extractFileTo(partPath(part), data);
+    }
+
+    std::lock_guard<std::mutex> lock(partsMutex_);
+    if ((loadedParts_ & bit) == 0) {
+        target.swap(data);
+        loadedParts_ |= bit;
+    }
+    return target;
+}
+
+bool ODFInspector::hasPart(Part part) const {
+    if (flat_) {
+        return !loadPart(part).empty();
+    }
+    const ZipEntry* entry = findArchiveEntry(partPath(part));
+    return entry != nullptr && entry->uncompressedSize > 0;
+}
+
+void ODFInspector::setThreadCount(size_t threadCount) {
+    threadCount_ = threadCount > 0
+        ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ODFInspector::prefetchParts(const std::vector<Part>& parts) const {
+    // Flat documents have nothing to decompress
+    if (!isLoaded_ || flat_) {
+        return;
+    }
+
+    size_t threads = zipReader_->supportsConcurrentReads() ? threadCount_ : 1;
+    parallelFor(parts.size(), threads, [&](size_t i) { loadPart(parts[i]); });
+}
+
+bool ODFInspector::extractAll(const std::string& outputDir, std::ostream& out) const {
+    namespace fs = std::filesystem;
+
+    if (!isLoaded_) {
+        out << "ODF file not loaded\n";
+        return false;
+    }
+
+    if (flat_) {
+        out << "Flat ODF documents have no archive entries to extract\n";
+        return false;
+    }
+
+    if (!ensureArchive()) {
+        out << "Error: " << getLastError() << "\n";
+        return false;
+    }
+
+    const auto& entries = zipReader_->entries();
+    std::vector<const ZipEntry*> files;
+    std::vector<std::string> skipped;
+
+    // Create the directory tree up front so workers only write files
+    std::error_code ec;
+    fs::create_directories(outputDir, ec);
+    for (const auto& entry : entries) {
+        if (!isSafeEntryPath(entry.name)) {
+            skipped.push_back(entry.name);
+            continue;
+        }
+        fs::path target = fs::path(outputDir) / entry.name;
+        if (!entry.name.empty() && entry.name.back() == '/') {
+            fs::create_directories(target, ec);
+            continue;
+        }
+        fs::create_directories(target.parent_path(), ec);
+        files.push_back(&entry);
+    }
+
+    std::mutex failureMutex;
+    std::vector<std::string> failures;
+    size_t threads = zipReader_->supportsConcurrentReads() ? threadCount_ : 1;
+
+    parallelFor(files.size(), threads, [&](size_t i) {
+        const ZipEntry& entry = *files[i];
+        std::ofstream file(fs::path(outputDir) / entry.name, std::ios::binary);
+        bool ok = file && zipReader_->streamFile(entry.name, [&file](const char* data, size_t size) {
+            file.write(data, static_cast<std::streamsize>(size));
+            return static_cast<bool>(file);
+        });
+        if (!ok || !file) {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            failures.push_back(entry.name);
+        }
+    });
+
+    out << "\n========================================\n";
+    out << "EXTRACTED TO: " << outputDir << "\n";
+    out << "========================================\n\n";
+    out << "  " << (files.size() - failures.size()) << " of " << files.size() << " files written\n";
+    for (const auto& name : skipped) {
+        out << "  Skipped unsafe path: " << name << "\n";
+    }
+    for (const auto& name : failures) {
+        out << "  Failed: " << name << "\n";
+    }
+    out << "\n========================================\n\n";
+
+    return failures.empty() && skipped.empty();
+}
+
+void ODFInspector::releaseParts() {
+    // swap() with a temporary actually returns the memory, unlike clear()
+    std::string().swap(contentXml_);
+    std::string().swap(metaXml_);
+    std::string().swap(stylesXml_);
+    std::string().swap(manifestXml_);
+    loadedParts_ = 0;
+
+    metadata_ = ODFMetadata();
+    std::vector<ManifestEntry>().swap(manifest_);
+    decodedStrings_.clear();
+    metadataParsed_ = false;
+    manifestParsed_ = false;
+
+    for (auto& tree : trees_) {
+        tree.clear();
+    }
+    builtTrees_ = 0;
+}
+
+void ODFInspector::writeSummary(OutputSink& sink) const {
     if (!isLoaded_) {
-        std::cout << "ODF file not loaded\n";
+        sink.error("ODF file not loaded");
         return;
     }
 
-    std::cout << "\n========================================\n";
-    std::cout << "ODF INSPECTOR SUMMARY\n";
-    std::cout << "========================================\n\n";
-    std::cout << "File: " << odfPath_ << "\n";
-    std::cout << "Type: " << getDocumentType() << "\n";
-    std::cout << "MIME: " << mimeType_ << "\n";
-    std::cout << "Valid ODF: " << (isValidODF() ? "Yes" : "No") << "\n\n";
+    Info info = getInfo();
+    OutputSink::Summary summary;
+    summary.path = info.path;
+    summary.mimeType = info.mimeType;
+    summary.documentType = info.documentType;
+    summary.valid = info.valid;
+    summary.flat = info.flat;
+    summary.fileCount = info.entryCount;
+    summary.hasContent = hasPart(Part::Content);
+    summary.hasMeta = hasPart(Part::Meta);
+    summary.hasStyles = hasPart(Part::Styles);
+    summary.hasManifest = hasPart(Part::Manifest);
+    sink.summary(summary);
+}
 
-    // File count
-    auto files = zipReader_->listFiles();
-    std::cout << "Total files in archive: " << files.size() << "\n";
-    
-    // Core files present
-    std::cout << "\nCore Files:\n";
-    std::cout << "  - content.xml: " << (!contentXml_.empty() ? "Present" : "Missing") << "\n";
-    std::cout << "  - meta.xml: " << (!metaXml_.empty() ? "Present" : "Missing") << "\n";
-    std::cout << "  - styles.xml: " << (!stylesXml_.empty() ? "Present" : "Missing") << "\n";
-    std::cout << "  - manifest.xml: " << (!manifestXml_.empty() ? "Present" : "Missing") << "\n";
-    
-    std::cout << "========================================\n\n";
+void ODFInspector::writeStructure(OutputSink& sink) const {
+    if (!isLoaded_) {
+        sink.error("ODF file not loaded");
+        return;
+    }
+
+    sink.structure(archiveEntries());
 }
 
-void ODFInspector::displayStructure() const {
+void ODFInspector::writeMetadata(OutputSink& sink) const {
+    if (!isLoaded_ || loadPart(Part::Meta).empty()) {
+        sink.metadata(nullptr);
+        return;
+    }
+
+    sink.metadata(&getMetadata());
+}
+
+void ODFInspector::writeImages(OutputSink& sink) const {
     if (!isLoaded_) {
-        std::cout << "ODF file not loaded\n";
+        sink.error("ODF file not loaded");
         return;
     }
 
-    std::cout << "\n========================================\n";
-    std::cout << "FILE STRUCTURE\n";
-    std::cout << "========================================\n\n";
+    sink.images(getImages());
+}
+
+void ODFInspector::writeTables(OutputSink& sink) const {
+    if (!isLoaded_ || !hasPart(Part::Content)) {
+        sink.error("Content not available");
+        return;
+    }
 
-    auto files = zipReader_->listFiles();
-    for (const auto& file : files) {
-        size_t size = zipReader_->getFileSize(file);
-        std::cout << "  " << std::setw(40) << std::left << file 
-                  << std::setw(10) << std::right << size << " bytes\n";
+    TableScanner scanner;
+    if (!scanTables(scanner)) {
+        sink.error(getLastError());
+        return;
     }
+    sink.tables(scanner.sheets());
+}
 
-    std::cout << "\n========================================\n\n";
+void ODFInspector::displaySummary(std::ostream& out) const {
+    TextSink sink(out);
+    writeSummary(sink);
 }
 
-void ODFInspector::displayMetadata() const {
-    if (!isLoaded_ || metaXml_.empty()) {
-        std::cout << "Metadata not available\n";
+void ODFInspector::displayStructure(std::ostream& out) const {
+    TextSink sink(out);
+    writeStructure(sink);
+}
+
+void ODFInspector::displayMetadata(std::ostream& out) const {
+    TextSink sink(out);
+    writeMetadata(sink);
+}
+
+void ODFInspector::displayContent(std::ostream& out) const {
+    if (!isLoaded_ || !hasPart(Part::Content)) {
+        out << "Content not available\n";
         return;
     }
 
-    std::cout << "\n========================================\n";
-    std::cout << "METADATA (meta.xml)\n";
-    std::cout << "========================================\n\n";
+    out << "\n========================================\n";
+    out << "CONTENT PREVIEW (content.xml)\n";
+    out << "========================================\n\n";
 
-    auto metadata = parseMetadata();
-    
-    if (metadata.empty()) {
-        std::cout << "No metadata extracted\n";
-    } else {
-        for (const auto& [key, value] : metadata) {
-            std::cout << "  " << key << ": " << value << "\n";
-        }
+    // Format only as much of the document as the preview shows
+    XmlFormatter formatter(kContentPreviewChars);
+    bool ok = previewPart(Part::Content, formatter);
+
+    out << formatter.output();
+
+    if (!ok) {
+        out << "\n\nError: " << getLastError() << "\n";
+    } else if (formatter.isTruncated()) {
+        out << "\n\n... (truncated, " << (partSize(Part::Content) - formatter.bytesConsumed())
+            << " more bytes of XML)\n";
     }
 
-    std::cout << "\n========================================\n\n";
+    out << "\n========================================\n\n";
 }
 
-void ODFInspector::displayContent() const {
-    if (!isLoaded_ || contentXml_.empty()) {
-        std::cout << "Content not available\n";
+void ODFInspector::displayText(std::ostream& out) const {
+    if (!isLoaded_ || !hasPart(Part::Content)) {
+        out << "Content not available\n";
         return;
     }
 
-    std::cout << "\n========================================\n";
-    std::cout << "CONTENT PREVIEW (content.xml)\n";
-    std::cout << "========================================\n\n";
+    out << "\n========================================\n";
+    out << "DOCUMENT TEXT\n";
+    out << "========================================\n\n";
 
-    // Display first 2000 characters of formatted XML
-    std::string formatted = formatXML(contentXml_);
-    std::string preview = formatted.substr(0, std::min(size_t(2000), formatted.size()));
-    
-    std::cout << preview;
-    
-    if (formatted.size() > 2000) {
-        std::cout << "\n\n... (truncated, " << (formatted.size() - 2000) 
-                  << " more characters)\n";
+    bool ok = extractText([&out](std::string_view text) {
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    });
+    if (!ok) {
+        out << "Error: " << getLastError() << "\n";
     }
 
-    std::cout << "\n========================================\n\n";
+    out << "\n========================================\n\n";
+}
+
+void ODFInspector::displayTables(std::ostream& out) const {
+    TextSink sink(out);
+    writeTables(sink);
 }
 
-void ODFInspector::displayStyles() const {
-    if (!isLoaded_ || stylesXml_.empty()) {
-        std::cout << "Styles not available\n";
+void ODFInspector::displayOutline(std::ostream& out) const {
+    if (!isLoaded_ || !hasPart(Part::Content)) {
+        out << "Content not available\n";
         return;
     }
 
-    std::cout << "\n========================================\n";
-    std::cout << "STYLES (styles.xml)\n";
-    std::cout << "========================================\n\n";
+    const XmlTree& tree = getTree(Part::Content);
+    if (tree.empty()) {
+        out << "Error: " << getLastError() << "\n";
+        return;
+    }
 
-    // Display first 1500 characters of formatted XML
-    std::string formatted = formatXML(stylesXml_);
-    std::string preview = formatted.substr(0, std::min(size_t(1500), formatted.size()));
-    
-    std::cout << preview;
-    
-    if (formatted.size() > 1500) {
-        std::cout << "\n\n... (truncated)\n";
+    out << "\n========================================\n";
+    out << "DOCUMENT OUTLINE\n";
+    out << "========================================\n\n";
+
+    // Names are resolved once; the walk itself only compares ids
+    const XmlTree::NameId heading = tree.nameId("text:h");
+    const XmlTree::NameId outlineLevel = tree.nameId("text:outline-level");
+    const XmlTree::NameId page = tree.nameId("draw:page");
+    const XmlTree::NameId pageName = tree.nameId("draw:name");
+    const XmlTree::NameId table = tree.nameId("table:table");
+    const XmlTree::NameId tableName = tree.nameId("table:name");
+    const char* tableLabel = mimeType_.find("spreadsheet") != std::string::npos ? "Sheet " : "Table ";
+
+    size_t slides = 0;
+    size_t tables = 0;
+    std::string text;
+    for (XmlTree::NodeId id = 0; id < tree.size(); ++id) {
+        XmlTree::NameId name = tree.node(id).name;
+        if (name == XmlTree::kNoName) {
+            continue;
+        }
+
+        text.clear();
+        if (name == heading) {
+            size_t level = std::strtoul(std::string(tree.attribute(id, outlineLevel)).c_str(), nullptr, 10);
+            level = std::min<size_t>(std::max<size_t>(level, 1), 10);
+            tree.appendText(id, text);
+            out << std::string((level - 1) * 2, ' ') << text << "\n";
+        } else if (name == page) {
+            XmlTokenizer::decodeEntities(tree.attribute(id, pageName), text);
+            out << "Slide " << ++slides << ": " << text << "\n";
+        } else if (name == table) {
+            XmlTokenizer::decodeEntities(tree.attribute(id, tableName), text);
+            out << tableLabel << ++tables << ": " << text << "\n";
+        }
     }
 
-    std::cout << "\n========================================\n\n";
+    out << "\n========================================\n\n";
 }
 
-void ODFInspector::displayManifest() const {
-    if (!isLoaded_ || manifestXml_.empty()) {
-        std::cout << "Manifest not available\n";
+void ODFInspector::displayStyles(std::ostream& out) const {
+    if (!isLoaded_ || !hasPart(Part::Styles)) {
+        out << "Styles not available\n";
         return;
     }
 
-    std::cout << "\n========================================\n";
-    std::cout << "MANIFEST (META-INF/manifest.xml)\n";
-    std::cout << "========================================\n\n";
+    out << "\n========================================\n";
+    out << "STYLES (styles.xml)\n";
+    out << "========================================\n\n";
 
-    std::cout << formatXML(manifestXml_) << "\n";
+    XmlFormatter formatter(kStylesPreviewChars);
+    bool ok = previewPart(Part::Styles, formatter);
 
-    std::cout << "========================================\n\n";
+    out << formatter.output();
+
+    if (!ok) {
+        out << "\n\nError: " << getLastError() << "\n";
+    } else if (formatter.isTruncated()) {
+        out << "\n\n... (truncated)\n";
+    }
+
+    out << "\n========================================\n\n";
 }
 
-void ODFInspector::displayFile(const std::string& filename) const {
+void ODFInspector::displayManifest(std::ostream& out) const {
+    if (!isLoaded_ || loadPart(Part::Manifest).empty()) {
+        out << "Manifest not available\n";
+        return;
+    }
+
+    out << "\n========================================\n";
+    out << "MANIFEST (META-INF/manifest.xml)\n";
+    out << "========================================\n\n";
+
+    out << formatXML(loadPart(Part::Manifest)) << "\n";
+
+    out << "========================================\n\n";
+}
+
+void ODFInspector::displayFile(const std::string& filename, std::ostream& out) const {
     if (!isLoaded_) {
-        std::cout << "ODF file not loaded\n";
+        out << "ODF file not loaded\n";
+        return;
+    }
+
+    // Sections of a flat document are shown like XML entries
+    if (flat_) {
+        for (size_t i = 0; i < FlatODF::kSectionCount; ++i) {
+            auto section = static_cast<FlatODF::Section>(i);
+            if (filename == FlatODF::name(section) && !flat_->section(section).empty()) {
+                out << "\n========================================\n";
+                out << "SECTION: " << filename << "\n";
+                out << "SIZE: " << flat_->section(section).size() << " bytes\n";
+                out << "========================================\n\n";
+                out << formatXML(flat_->section(section)) << "\n";
+                out << "========================================\n\n";
+                return;
+            }
+        }
+        out << "Section '" << filename << "' not found in flat document\n";
+        return;
+    }
+
+    if (!ensureArchive()) {
+        out << "Error: " << getLastError() << "\n";
         return;
     }
 
     if (!zipReader_->fileExists(filename)) {
-        std::cout << "File '" << filename << "' not found in archive\n";
+        out << "File '" << filename << "' not found in archive\n";
         return;
     }
 
-    std::string content = zipReader_->extractFile(filename);
-    
-    std::cout << "\n========================================\n";
-    std::cout << "FILE: " << filename << "\n";
-    std::cout << "SIZE: " << content.size() << " bytes\n";
-    std::cout << "========================================\n\n";
+    out << "\n========================================\n";
+    out << "FILE: " << filename << "\n";
+    out << "SIZE: " << zipReader_->getFileSize(filename) << " bytes\n";
+    out << "========================================\n\n";
 
     // If it's XML, format it
     if (filename.find(".xml") != std::string::npos) {
-        std::cout << formatXML(content) << "\n";
+        out << formatXML(zipReader_->extractFile(filename)) << "\n";
     } else {
-        std::cout << content << "\n";
+        // Everything else is copied through in bounded chunks
+        zipReader_->streamFile(filename, [&out](const char* data, size_t size) {
+            out.write(data, static_cast<std::streamsize>(size));
+            return true;
+        });
+        out << "\n";
     }
 
-    std::cout << "========================================\n\n";
+    out << "========================================\n\n";
+}
+
+void ODFInspector::listImages(std::ostream& out) const {
+    TextSink sink(out);
+    writeImages(sink);
+}
+
+ODFInspector::Info ODFInspector::getInfo() const {
+    Info info;
+    info.path = odfPath_;
+    info.mimeType = mimeType_;
+    info.documentType = getDocTypeFromMime(mimeType_);
+    info.valid = isValidODF();
+    info.flat = flat_ != nullptr;
+    info.entryCount = isLoaded_ ? archiveEntries().size() : 0;
+    return info;
+}
+
+const std::vector<ZipEntry>& ODFInspector::getEntries() const {
+    return archiveEntries();
+}
+
+const ZipEntry* ODFInspector::findEntry(const std::string& name) const {
+    return findArchiveEntry(name);
 }
 
-void ODFInspector::listImages() const {
+bool ODFInspector::readEntry(const std::string& name, std::string& buffer, std::string_view& data) const {
     if (!isLoaded_) {
-        std::cout << "ODF file not loaded\n";
-        return;
+        setError("Document is not loaded");
+        return false;
     }
 
-    std::cout << "\n========================================\n";
-    std::cout << "EMBEDDED IMAGES\n";
-    std::cout << "========================================\n\n";
+    if (flat_) {
+        for (size_t i = 0; i < FlatODF::kSectionCount; ++i) {
+            auto section = static_cast<FlatODF::Section>(i);
+            if (name == FlatODF::name(section) && !flat_->section(section).empty()) {
+                data = flat_->section(section);
+                return true;
+            }
+        }
+        setError("Section '" + name + "' not found in flat document");
+        return false;
+    }
 
-    auto files = zipReader_->listFiles();
-    bool foundImages = false;
+    if (!ensureArchive()) {
+        return false;
+    }
+    if (zipReader_->viewFile(name, data)) {
+        return true;
+    }
+    if (!zipReader_->extractFileTo(name, buffer)) {
+        setError(zipReader_->getLastError());
+        return false;
+    }
+    data = buffer;
+    return true;
+}
 
-    for (const auto& file : files) {
+bool ODFInspector::streamEntry(const std::string& name, const ZipReader::ChunkCallback& onChunk) const {
+    if (flat_) {
+        // Sections are in memory already
+        std::string buffer;
+        std::string_view data;
+        if (!readEntry(name, buffer, data)) {
+            return false;
+        }
+        onChunk(data.data(), data.size());
+        return true;
+    }
+
+    if (!isLoaded_) {
+        setError("Document is not loaded");
+        return false;
+    }
+    if (!ensureArchive()) {
+        return false;
+    }
+    if (!zipReader_->streamFile(name, onChunk)) {
+        setError(zipReader_->getLastError());
+        return false;
+    }
+    return true;
+}
+
+std::vector<const ZipEntry*> ODFInspector::getImages() const {
+    std::vector<const ZipEntry*> images;
+    for (const auto& entry : archiveEntries()) {
+        const std::string& file = entry.name;
         if (file.find("Pictures/") == 0 || file.find("images/") == 0) {
-            size_t size = zipReader_->getFileSize(file);
-            std::cout << "  " << file << " (" << size << " bytes)\n";
-            foundImages = true;
+            images.push_back(&entry);
         }
     }
+    return images;
+}
+
+const ODFMetadata& ODFInspector::getMetadata() const {
+    std::lock_guard<std::mutex> lock(queryMutex_);
+    if (!metadataParsed_) {
+        if (isLoaded_) {
+            std::string_view xml = loadPart(Part::Meta);
+            InspectStats::Timer timer(stats_, InspectStats::Phase::Parse);
+            ODFMetadata::parse(xml, metadata_);
+        }
+        metadataParsed_ = true;
+    }
+    return metadata_;
+}
+
+const XmlTree& ODFInspector::getTree(Part part) const {
+    std::lock_guard<std::mutex> lock(queryMutex_);
+    XmlTree& tree = trees_[static_cast<size_t>(part)];
+    unsigned bit = 1u << static_cast<unsigned>(part);
+    if ((builtTrees_ & bit) != 0) {
+        return tree;
+    }
+    builtTrees_ |= bit;
+    if (!isLoaded_) {
+        return tree;
+    }
+
+    std::string_view xml = loadPart(part);
+    if (xml.empty()) {
+        return tree;
+    }
+    InspectStats::Timer timer(stats_, InspectStats::Phase::Parse);
+    if (!tree.build(xml)) {
+        setError(std::string(partPath(part)) + ": " + tree.getLastError());
+    }
+    return tree;
+}
 
-    if (!foundImages) {
-        std::cout << "  No embedded images found\n";
+const std::vector<ODFInspector::ManifestEntry>& ODFInspector::getManifest() const {
+    std::lock_guard<std::mutex> lock(queryMutex_);
+    if (manifestParsed_) {
+        return manifest_;
+    }
+    manifestParsed_ = true;
+    if (!isLoaded_) {
+        return manifest_;
     }
 
-    std::cout << "\n========================================\n\n";
+    // Values point straight into manifest.xml unless they carry entities
+    auto value = [this](std::string_view raw) -> std::string_view {
+        if (raw.find('&') == std::string_view::npos) {
+            return raw;
+        }
+        decodedStrings_.emplace_back();
+        XmlTokenizer::decodeEntities(raw, decodedStrings_.back());
+        return decodedStrings_.back();
+    };
+
+    XmlTokenizer tokenizer(loadPart(Part::Manifest));
+    XmlTokenizer::Token token;
+    bool inEntry = false;   // Inside a file-entry element
+    InspectStats::Timer timer(stats_, InspectStats::Phase::Parse);
+
+    while (tokenizer.next(token)) {
+        switch (token.type) {
+            case XmlTokenizer::TokenType::StartElement:
+                // Only file-entry attributes are read; all others are skipped
+                if (token.name == "manifest:file-entry") {
+                    manifest_.emplace_back();
+                    inEntry = true;
+                } else {
+                    if (inEntry && token.name == "manifest:encryption-data") {
+                        manifest_.back().encrypted = true;
+                    }
+                    tokenizer.skipAttributes();
+                }
+                break;
+
+            case XmlTokenizer::TokenType::Attribute:
+                if (token.name == "manifest:full-path") {
+                    manifest_.back().fullPath = value(token.value);
+                } else if (token.name == "manifest:media-type") {
+                    manifest_.back().mediaType = value(token.value);
+                } else if (token.name == "manifest:version") {
+                    manifest_.back().version = value(token.value);
+                }
+                break;
+
+            case XmlTokenizer::TokenType::EndElement:
+                if (token.name == "manifest:file-entry") {
+                    inEntry = false;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return manifest_;
 }
 
-std::string ODFInspector::getMimeType() const {
+const std::string& ODFInspector::getMimeType() const {
     return mimeType_;
 }
 
@@ -270,103 +908,132 @@ bool ODFInspector::isValidODF() const {
 }
 
 std::string ODFInspector::getLastError() const {
+    std::lock_guard<std::mutex> lock(errorMutex_);
     return lastError_;
 }
 
-std::string ODFInspector::formatXML(const std::string& xml) const {
-    // Basic XML formatting (add line breaks after tags)
-    std::string formatted;
-    formatted.reserve(xml.size() * 1.2);
-    
-    int indent = 0;
-    bool inTag = false;
-    bool afterClosingBracket = false;
-    
-    for (size_t i = 0; i < xml.size(); ++i) {
-        char c = xml[i];
-        
-        if (c == '<') {
-            if (afterClosingBracket) {
-                formatted += '\n';
-                formatted.append(indent * 2, ' ');
-            }
-            
-            if (i + 1 < xml.size() && xml[i + 1] == '/') {
-                indent--;
-                formatted += '\n';
-                formatted.append(indent * 2, ' ');
-            }
-            
-            inTag = true;
-            afterClosingBracket = false;
-        }
-        
-        formatted += c;
-        
-        if (c == '>') {
-            inTag = false;
-            afterClosingBracket = true;
-            
-            if (i > 0 && xml[i - 1] != '/') {
-                if (i + 1 < xml.size() && xml[i + 1] != '<') {
-                    // Don't add newline if followed by text content
-                } else {
-                    indent++;
-                }
-            }
-        }
+void ODFInspector::setError(const std::string& message) const {
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    lastError_ = message;
+}
+
+std::string ODFInspector::formatXML(std::string_view xml) const {
+    XmlFormatter formatter;
+    runFormatter(formatter, xml);
+    return formatter.output();
+}
+
+void ODFInspector::runFormatter(XmlFormatter& formatter, std::string_view xml) const {
+    InspectStats::Timer timer(stats_, InspectStats::Phase::Format);
+    formatter.feed(xml);
+    formatter.finish();
+    if (stats_ != nullptr) {
+        stats_->add(InspectStats::Counter::BytesFormatted, formatter.bytesConsumed());
     }
-    
-    return formatted;
 }
 
-std::map<std::string, std::string> ODFInspector::parseMetadata() const {
-    std::map<std::string, std::string> metadata;
-    
-    // Simple tag extraction (not full XML parsing)
-    auto extractTag = [](const std::string& xml, const std::string& tagName) -> std::string {
-        std::string openTag = "<" + tagName + ">";
-        std::string closeTag = "</" + tagName + ">";
-        
-        size_t start = xml.find(openTag);
-        if (start == std::string::npos) return "";
-        
-        start += openTag.length();
-        size_t end = xml.find(closeTag, start);
-        if (end == std::string::npos) return "";
-        
-        return xml.substr(start, end - start);
-    };
-    
-    metadata["Title"] = extractTag(metaXml_, "dc:title");
-    metadata["Creator"] = extractTag(metaXml_, "dc:creator");
-    metadata["Date"] = extractTag(metaXml_, "dc:date");
-    metadata["Generator"] = extractTag(metaXml_, "meta:generator");
-    
-    // Remove empty entries
-    for (auto it = metadata.begin(); it != metadata.end();) {
-        if (it->second.empty()) {
-            it = metadata.erase(it);
-        } else {
-            ++it;
-        }
+bool ODFInspector::extractText(const TextExtractor::Writer& writer) const {
+    TextExtractor extractor(writer);
+    bool ok = streamPart(Part::Content, [this, &extractor](std::string_view xml) {
+        InspectStats::Timer timer(stats_, InspectStats::Phase::Text);
+        extractor.feed(xml);
+        return true;
+    });
+    if (!ok) {
+        return false;
     }
-    
-    return metadata;
+
+    {
+        InspectStats::Timer timer(stats_, InspectStats::Phase::Text);
+        extractor.finish();
+    }
+    if (stats_ != nullptr) {
+        stats_->add(InspectStats::Counter::BytesText, extractor.bytesConsumed());
+    }
+    return true;
+}
+
+bool ODFInspector::scanTables(TableScanner& scanner) const {
+    bool ok = streamPart(Part::Content, [this, &scanner](std::string_view xml) {
+        InspectStats::Timer timer(stats_, InspectStats::Phase::Parse);
+        scanner.feed(xml);
+        return true;
+    });
+    if (!ok) {
+        return false;
+    }
+
+    InspectStats::Timer timer(stats_, InspectStats::Phase::Parse);
+    scanner.finish();
+    return true;
+}
+
+bool ODFInspector::streamPart(Part part, const std::function<bool(std::string_view)>& feed,
+                              size_t chunkSize) const {
+    if (!isLoaded_) {
+        setError("Document is not loaded");
+        return false;
+    }
+
+    bool loaded;
+    {
+        std::lock_guard<std::mutex> lock(partsMutex_);
+        loaded = (loadedParts_ & (1u << static_cast<unsigned>(part))) != 0;
+    }
+
+    // A part already in memory is read in place; otherwise it is consumed
+    // chunk by chunk as it is inflated, until feed asks to stop
+    if (flat_ || loaded) {
+        feed(loadPart(part));
+        return true;
+    }
+
+    if (!ensureArchive()) {
+        return false;
+    }
+    bool ok = zipReader_->streamFile(partPath(part), [&feed](const char* data, size_t size) {
+        return feed(std::string_view(data, size));
+    }, chunkSize);
+    if (!ok) {
+        setError(zipReader_->getLastError());
+    }
+    return ok;
+}
+
+bool ODFInspector::previewPart(Part part, XmlFormatter& formatter) const {
+    bool ok = streamPart(part, [this, &formatter](std::string_view xml) {
+        InspectStats::Timer timer(stats_, InspectStats::Phase::Format);
+        return formatter.feed(xml);
+    }, kPreviewChunkSize);
+
+    InspectStats::Timer timer(stats_, InspectStats::Phase::Format);
+    formatter.finish();
+    if (stats_ != nullptr) {
+        stats_->add(InspectStats::Counter::BytesFormatted, formatter.bytesConsumed());
+    }
+    return ok;
+}
+
+uint64_t ODFInspector::partSize(Part part) const {
+    if (flat_) {
+        return loadPart(part).size();
+    }
+    const ZipEntry* entry = findArchiveEntry(partPath(part));
+    return entry != nullptr ? entry->uncompressedSize : 0;
 }
 
-std::string ODFInspector::getDocTypeFromMime(const std::string& mime) const {
-    if (mime.find("text") != std::string::npos) {
+const char* ODFInspector::getDocTypeFromMime(std::string_view mime) {
+    if (mime.find("text") != std::string_view::npos) {
         return "Text Document (.odt)";
-    } else if (mime.find("spreadsheet") != std::string::npos) {
+    } else if (mime.find("spreadsheet") != std::string_view::npos) {
         return "Spreadsheet (.ods)";
-    } else if (mime.find("presentation") != std::string::npos) {
+    } else if (mime.find("presentation") != std::string_view::npos) {
         return "Presentation (.odp)";
-    } else if (mime.find("graphics") != std::string::npos) {
+    } else if (mime.find("graphics") != std::string_view::npos) {
         return "Drawing (.odg)";
-    } else if (mime.find("chart") != std::string::npos) {
+    } else if (mime.find("chart") != std::string_view::npos) {
         return "Chart (.odc)";
-    } else if (mime.find("formula") != std::string::npos) {
+    } else if (mime.find("formula") != std::string_view::npos) {
         return "Formula (.odf)";
     }
     return "Unknown ODF Document";
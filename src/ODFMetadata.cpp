@@ -0,0 +1,405 @@
+#include "ODFMetadata.h"
+#include "XmlTokenizer.h"
+#include <charconv>
+
+namespace {
+
+using Statistic = ODFMetadata::DocumentStatistic;
+
+// Elements whose text goes straight into a string member
+const std::pair<std::string_view, std::string ODFMetadata::*> kTextFields[] = {
+    { "dc:title", &ODFMetadata::title },
+    { "dc:description", &ODFMetadata::description },
+    { "dc:subject", &ODFMetadata::subject },
+    { "dc:creator", &ODFMetadata::creator },
+    { "dc:date", &ODFMetadata::date },
+    { "dc:language", &ODFMetadata::language },
+    { "meta:generator", &ODFMetadata::generator },
+    { "meta:initial-creator", &ODFMetadata::initialCreator },
+    { "meta:creation-date", &ODFMetadata::creationDate },
+    { "meta:printed-by", &ODFMetadata::printedBy },
+    { "meta:print-date", &ODFMetadata::printDate }
+};
+
+const std::pair<std::string_view, std::optional<uint64_t> Statistic::*> kStatisticFields[] = {
+    { "meta:page-count", &Statistic::pageCount },
+    { "meta:table-count", &Statistic::tableCount },
+    { "meta:draw-count", &Statistic::drawCount },
+    { "meta:image-count", &Statistic::imageCount },
+    { "meta:ole-object-count", &Statistic::oleObjectCount },
+    { "meta:object-count", &Statistic::objectCount },
+    { "meta:paragraph-count", &Statistic::paragraphCount },
+    { "meta:word-count", &Statistic::wordCount },
+    { "meta:character-count", &Statistic::characterCount },
+    { "meta:non-whitespace-character-count", &Statistic::nonWhitespaceCharacterCount },
+    { "meta:row-count", &Statistic::rowCount },
+    { "meta:frame-count", &Statistic::frameCount },
+    { "meta:sentence-count", &Statistic::sentenceCount },
+    { "meta:syllable-count", &Statistic::syllableCount },
+    { "meta:cell-count", &Statistic::cellCount }
+};
+
+std::string_view trim(std::string_view text) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+        return std::string_view();
+    }
+    size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+bool parseCount(std::string_view text, uint64_t& value) {
+    text = trim(text);
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    return !text.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+std::string decoded(std::string_view raw) {
+    std::string text;
+    XmlTokenizer::decodeEntities(raw, text);
+    return text;
+}
+
+/**
+ * @brief Token-driven state machine behind ODFMetadata::parse
+ */
+class MetaParser {
+public:
+    explicit MetaParser(ODFMetadata& metadata)
+        : metadata_(metadata)
+        , element_(Element::Other)
+        , capture_(Capture::None)
+        , textField_(nullptr) {
+    }
+
+    void startElement(std::string_view name) {
+        element_ = Element::Other;
+        if (capture_ != Capture::None) {
+            return;     // Markup nested inside a text field adds nothing
+        }
+
+        for (const auto& [qname, member] : kTextFields) {
+            if (name == qname) {
+                textField_ = &(metadata_.*member);
+                begin(name, Capture::Text);
+                return;
+            }
+        }
+
+        if (name == "meta:keyword") {
+            begin(name, Capture::Keyword);
+        } else if (name == "meta:editing-cycles") {
+            begin(name, Capture::EditingCycles);
+        } else if (name == "meta:editing-duration") {
+            begin(name, Capture::EditingDuration);
+        } else if (name == "meta:user-defined") {
+            metadata_.userDefined.emplace_back();
+            element_ = Element::UserDefined;
+            begin(name, Capture::UserDefined);
+        } else if (name == "meta:document-statistic") {
+            element_ = Element::Statistic;
+        } else if (name == "meta:template") {
+            element_ = Element::Template;
+        } else if (name == "meta:auto-reload") {
+            element_ = Element::AutoReload;
+        } else if (name == "meta:hyperlink-behaviour") {
+            element_ = Element::HyperlinkBehaviour;
+        }
+    }
+
+    // Returns false when the current element has no attributes of interest
+    bool wantsAttributes() const {
+        return element_ != Element::Other;
+    }
+
+    void attribute(std::string_view name, std::string_view value) {
+        switch (element_) {
+            case Element::Statistic:
+                for (const auto& [qname, member] : kStatisticFields) {
+                    uint64_t count;
+                    if (name == qname && parseCount(value, count)) {
+                        metadata_.statistics.*member = count;
+                        break;
+                    }
+                }
+                break;
+
+            case Element::Template:
+                if (name == "xlink:href") {
+                    metadata_.templateInfo.href = decoded(value);
+                } else if (name == "xlink:title") {
+                    metadata_.templateInfo.title = decoded(value);
+                } else if (name == "meta:date") {
+                    metadata_.templateInfo.date = decoded(value);
+                }
+                break;
+
+            case Element::AutoReload:
+                if (name == "xlink:href") {
+                    metadata_.autoReload.href = decoded(value);
+                } else if (name == "meta:delay") {
+                    metadata_.autoReload.delay = decoded(value);
+                }
+                break;
+
+            case Element::HyperlinkBehaviour:
+                if (name == "office:target-frame-name") {
+                    metadata_.hyperlinkBehaviour.targetFrameName = decoded(value);
+                } else if (name == "xlink:show") {
+                    metadata_.hyperlinkBehaviour.show = decoded(value);
+                }
+                break;
+
+            case Element::UserDefined:
+                if (name == "meta:name") {
+                    metadata_.userDefined.back().name = decoded(value);
+                } else if (name == "meta:value-type") {
+                    metadata_.userDefined.back().valueType = decoded(value);
+                }
+                break;
+
+            case Element::Other:
+                break;
+        }
+    }
+
+    void text(std::string_view raw, bool cdata) {
+        if (capture_ == Capture::None) {
+            return;
+        }
+        if (cdata) {
+            value_.append(raw);
+        } else {
+            XmlTokenizer::decodeEntities(raw, value_);
+        }
+    }
+
+    void endElement(std::string_view name) {
+        if (capture_ == Capture::None || name != captureName_) {
+            return;
+        }
+
+        switch (capture_) {
+            case Capture::Text:
+                // The first occurrence of a field wins
+                if (textField_->empty()) {
+                    *textField_ = value_;
+                }
+                break;
+
+            case Capture::Keyword:
+                if (!trim(value_).empty()) {
+                    metadata_.keywords.push_back(value_);
+                }
+                break;
+
+            case Capture::EditingCycles: {
+                uint64_t cycles;
+                if (parseCount(value_, cycles)) {
+                    metadata_.editingCycles = cycles;
+                }
+                break;
+            }
+
+            case Capture::EditingDuration: {
+                metadata_.editingDuration = std::string(trim(value_));
+                uint64_t seconds;
+                if (ODFMetadata::parseDuration(metadata_.editingDuration, seconds)) {
+                    metadata_.editingSeconds = seconds;
+                }
+                break;
+            }
+
+            case Capture::UserDefined:
+                metadata_.userDefined.back().value = value_;
+                break;
+
+            case Capture::None:
+                break;
+        }
+
+        capture_ = Capture::None;
+        textField_ = nullptr;
+    }
+
+private:
+    enum class Element {
+        Other,
+        Statistic,
+        Template,
+        AutoReload,
+        HyperlinkBehaviour,
+        UserDefined
+    };
+
+    enum class Capture {
+        None,
+        Text,
+        Keyword,
+        EditingCycles,
+        EditingDuration,
+        UserDefined
+    };
+
+    ODFMetadata& metadata_;
+    Element element_;           // Element whose attributes are being read
+    Capture capture_;           // What the collected text belongs to
+    std::string_view captureName_;
+    std::string* textField_;
+    std::string value_;
+
+    void begin(std::string_view name, Capture capture) {
+        capture_ = capture;
+        captureName_ = name;
+        value_.clear();
+    }
+};
+
+} // namespace
+
+bool ODFMetadata::parse(std::string_view xml, ODFMetadata& metadata) {
+    metadata = ODFMetadata();
+    MetaParser parser(metadata);
+
+    XmlTokenizer tokenizer(xml);
+    XmlTokenizer::Token token;
+
+    while (tokenizer.next(token)) {
+        switch (token.type) {
+            case XmlTokenizer::TokenType::StartElement:
+                parser.startElement(token.name);
+                if (!parser.wantsAttributes()) {
+                    tokenizer.skipAttributes();
+                }
+                break;
+
+            case XmlTokenizer::TokenType::Attribute:
+                parser.attribute(token.name, token.value);
+                break;
+
+            case XmlTokenizer::TokenType::Text:
+                parser.text(token.value, false);
+                break;
+
+            case XmlTokenizer::TokenType::CData:
+                parser.text(token.value, true);
+                break;
+
+            case XmlTokenizer::TokenType::EndElement:
+                parser.endElement(token.name);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return !tokenizer.hasError();
+}
+
+bool ODFMetadata::parseDuration(std::string_view duration, uint64_t& seconds) {
+    constexpr uint64_t kDay = 24 * 60 * 60;
+    constexpr uint64_t kMaxComponent = 1000000000000ULL;
+
+    duration = trim(duration);
+    if (duration.empty() || duration[0] != 'P') {
+        return false;
+    }
+
+    uint64_t total = 0;
+    bool inTime = false;
+    bool any = false;
+    size_t i = 1;
+
+    while (i < duration.size()) {
+        if (duration[i] == 'T') {
+            if (inTime) {
+                return false;
+            }
+            inTime = true;
+            ++i;
+            continue;
+        }
+
+        size_t start = i;
+        uint64_t number = 0;
+        while (i < duration.size() && duration[i] >= '0' && duration[i] <= '9') {
+            number = number * 10 + static_cast<uint64_t>(duration[i] - '0');
+            if (number > kMaxComponent) {
+                return false;
+            }
+            ++i;
+        }
+        if (i == start) {
+            return false;
+        }
+
+        // Only seconds may have a fraction; it is dropped
+        bool fraction = false;
+        if (i < duration.size() && (duration[i] == '.' || duration[i] == ',')) {
+            fraction = true;
+            ++i;
+            while (i < duration.size() && duration[i] >= '0' && duration[i] <= '9') {
+                ++i;
+            }
+        }
+        if (i == duration.size()) {
+            return false;
+        }
+
+        uint64_t unit = 0;
+        char designator = duration[i++];
+        if (!inTime) {
+            switch (designator) {
+                case 'Y': unit = 365 * kDay; break;
+                case 'M': unit = 30 * kDay; break;
+                case 'W': unit = 7 * kDay; break;
+                case 'D': unit = kDay; break;
+                default: break;
+            }
+        } else {
+            switch (designator) {
+                case 'H': unit = 60 * 60; break;
+                case 'M': unit = 60; break;
+                case 'S': unit = 1; break;
+                default: break;
+            }
+        }
+        if (unit == 0 || (fraction && designator != 'S')) {
+            return false;
+        }
+
+        // Components are capped, but a large enough count of years still
+        // overflows; such durations are rejected rather than wrapped
+        if (number > (UINT64_MAX - total) / unit) {
+            return false;
+        }
+        total += number * unit;
+        any = true;
+    }
+
+    if (!any) {
+        return false;
+    }
+
+    seconds = total;
+    return true;
+}
+
+bool ODFMetadata::empty() const {
+    const Statistic& s = statistics;
+    bool noStatistics = !s.pageCount && !s.tableCount && !s.drawCount && !s.imageCount &&
+                        !s.oleObjectCount && !s.objectCount && !s.paragraphCount &&
+                        !s.wordCount && !s.characterCount && !s.nonWhitespaceCharacterCount &&
+                        !s.rowCount && !s.frameCount && !s.sentenceCount &&
+                        !s.syllableCount && !s.cellCount;
+
+    return title.empty() && description.empty() && subject.empty() && creator.empty() &&
+           date.empty() && language.empty() && generator.empty() && initialCreator.empty() &&
+           creationDate.empty() && printedBy.empty() && printDate.empty() &&
+           keywords.empty() && !editingCycles && editingDuration.empty() &&
+           templateInfo.href.empty() && autoReload.href.empty() &&
+           hyperlinkBehaviour.targetFrameName.empty() && hyperlinkBehaviour.show.empty() &&
+           userDefined.empty() && noStatistics;
+}
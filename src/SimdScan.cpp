@@ -0,0 +1,202 @@
+#include "SimdScan.h"
+
+#if defined(__AVX2__)
+#define ODF_SIMD_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ODF_SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+#if defined(ODF_SIMD_AVX2) || defined(ODF_SIMD_SSE2)
+inline unsigned countTrailingZeros(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+inline unsigned populationCount(unsigned mask) {
+#ifdef _MSC_VER
+    return static_cast<unsigned>(__popcnt(mask));
+#else
+    return static_cast<unsigned>(__builtin_popcount(mask));
+#endif
+}
+#endif
+
+// Build a match mask for one block of input. Needles are passed as
+// vectors so the broadcasts stay outside the loops.
+#if defined(ODF_SIMD_AVX2)
+using Block = __m256i;
+constexpr long kBlockSize = 32;
+
+inline Block load(const char* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+inline Block splat(char c) {
+    return _mm256_set1_epi8(c);
+}
+inline Block equal(Block a, Block b) {
+    return _mm256_cmpeq_epi8(a, b);
+}
+inline Block either(Block a, Block b) {
+    return _mm256_or_si256(a, b);
+}
+inline unsigned maskOf(Block v) {
+    return static_cast<unsigned>(_mm256_movemask_epi8(v));
+}
+#elif defined(ODF_SIMD_SSE2)
+using Block = __m128i;
+constexpr long kBlockSize = 16;
+
+inline Block load(const char* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+inline Block splat(char c) {
+    return _mm_set1_epi8(c);
+}
+inline Block equal(Block a, Block b) {
+    return _mm_cmpeq_epi8(a, b);
+}
+inline Block either(Block a, Block b) {
+    return _mm_or_si128(a, b);
+}
+inline unsigned maskOf(Block v) {
+    return static_cast<unsigned>(_mm_movemask_epi8(v));
+}
+#endif
+
+} // namespace
+
+namespace SimdScan {
+
+const char* findByte(const char* begin, const char* end, char c) {
+    const char* p = begin;
+#if defined(ODF_SIMD_AVX2) || defined(ODF_SIMD_SSE2)
+    const Block needle = splat(c);
+    while (end - p >= kBlockSize) {
+        unsigned mask = maskOf(equal(load(p), needle));
+        if (mask != 0) {
+            return p + countTrailingZeros(mask);
+        }
+        p += kBlockSize;
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == c) {
+            return p;
+        }
+    }
+    return end;
+}
+
+const char* findEither(const char* begin, const char* end, char a, char b) {
+    const char* p = begin;
+#if defined(ODF_SIMD_AVX2) || defined(ODF_SIMD_SSE2)
+    const Block needleA = splat(a);
+    const Block needleB = splat(b);
+    while (end - p >= kBlockSize) {
+        Block block = load(p);
+        unsigned mask = maskOf(either(equal(block, needleA), equal(block, needleB)));
+        if (mask != 0) {
+            return p + countTrailingZeros(mask);
+        }
+        p += kBlockSize;
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == a || *p == b) {
+            return p;
+        }
+    }
+    return end;
+}
+
+const char* findAnyOf3(const char* begin, const char* end, char a, char b, char c) {
+    const char* p = begin;
+#if defined(ODF_SIMD_AVX2) || defined(ODF_SIMD_SSE2)
+    const Block needleA = splat(a);
+    const Block needleB = splat(b);
+    const Block needleC = splat(c);
+    while (end - p >= kBlockSize) {
+        Block block = load(p);
+        unsigned mask = maskOf(either(either(equal(block, needleA), equal(block, needleB)),
+                                      equal(block, needleC)));
+        if (mask != 0) {
+            return p + countTrailingZeros(mask);
+        }
+        p += kBlockSize;
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == a || *p == b || *p == c) {
+            return p;
+        }
+    }
+    return end;
+}
+
+size_t countByte(const char* begin, const char* end, char c) {
+    const char* p = begin;
+    size_t count = 0;
+#if defined(ODF_SIMD_AVX2) || defined(ODF_SIMD_SSE2)
+    const Block needle = splat(c);
+    while (end - p >= kBlockSize) {
+        count += populationCount(maskOf(equal(load(p), needle)));
+        p += kBlockSize;
+    }
+#endif
+    for (; p < end; ++p) {
+        count += *p == c ? 1 : 0;
+    }
+    return count;
+}
+
+const char* findSpaceRun(const char* begin, const char* end) {
+    const char* p = begin;
+#if defined(ODF_SIMD_AVX2) || defined(ODF_SIMD_SSE2)
+    const Block space = splat(' ');
+    const Block tab = splat('\t');
+    const Block lf = splat('\n');
+    const Block cr = splat('\r');
+    // The second load, one byte on, pairs each space with its successor
+    while (end - p > kBlockSize) {
+        Block block = load(p);
+        Block spaces = equal(block, space);
+        unsigned mask = maskOf(either(either(equal(block, tab), equal(block, lf)), equal(block, cr))) |
+                        (maskOf(spaces) & maskOf(equal(load(p + 1), space)));
+        if (mask != 0) {
+            return p + countTrailingZeros(mask);
+        }
+        p += kBlockSize;
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == '\t' || *p == '\n' || *p == '\r' || (*p == ' ' && p + 1 < end && p[1] == ' ')) {
+            return p;
+        }
+    }
+    return end;
+}
+
+const char* instructionSet() {
+#if defined(ODF_SIMD_AVX2)
+    return "AVX2";
+#elif defined(ODF_SIMD_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace SimdScan
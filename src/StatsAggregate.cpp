@@ -0,0 +1,130 @@
+#include "StatsAggregate.h"
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+
+constexpr size_t kBarWidth = 40;
+
+} // namespace
+
+size_t StatsAggregate::bucketFor(uint64_t nanoseconds) {
+    // Bucket 0 holds times under 1 us, bucket b times in [2^(b-1), 2^b) us
+    uint64_t microseconds = nanoseconds / 1000;
+    size_t bucket = 0;
+    while (microseconds > 0 && bucket < kBucketCount - 1) {
+        microseconds >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+uint64_t StatsAggregate::bucketLimitUs(size_t bucket) {
+    return uint64_t(1) << bucket;
+}
+
+std::string StatsAggregate::bucketLabel(size_t bucket) {
+    if (bucket == 0) {
+        return "< 1 us";
+    }
+    if (bucket == kBucketCount - 1) {
+        return ">= " + std::to_string(bucketLimitUs(bucket - 1)) + " us";
+    }
+    return std::to_string(bucketLimitUs(bucket - 1)) + " - " + std::to_string(bucketLimitUs(bucket)) + " us";
+}
+
+void StatsAggregate::add(const InspectStats& stats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++documents_;
+
+    for (size_t i = 0; i < InspectStats::kPhaseCount; ++i) {
+        uint64_t ns = stats.time(static_cast<InspectStats::Phase>(i));
+        PhaseHistogram& histogram = phases_[i];
+        ++histogram.buckets[bucketFor(ns)];
+        histogram.totalNs += ns;
+        histogram.maxNs = std::max(histogram.maxNs, ns);
+    }
+    for (size_t i = 0; i < InspectStats::kCounterCount; ++i) {
+        counters_[i] += stats.count(static_cast<InspectStats::Counter>(i));
+    }
+}
+
+uint64_t StatsAggregate::percentileUs(const PhaseHistogram& histogram, double fraction) const {
+    if (histogram.totalNs == 0) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(fraction * documents_ + 0.5);
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+        seen += histogram.buckets[bucket];
+        if (seen >= rank) {
+            return bucketLimitUs(bucket);
+        }
+    }
+    return bucketLimitUs(kBucketCount - 1);
+}
+
+void StatsAggregate::write(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    out << "\n========================================\n";
+    out << "BATCH STATISTICS (" << documents_ << " documents)\n";
+    out << "========================================\n\n";
+
+    if (documents_ == 0) {
+        out << "========================================\n\n";
+        return;
+    }
+
+    out << "  Percentiles are bucket upper bounds\n\n";
+    out << "  " << std::left << std::setw(12) << "phase" << std::right
+        << std::setw(12) << "total ms" << std::setw(10) << "mean us"
+        << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+        << std::setw(10) << "p99 us" << std::setw(10) << "max us" << "\n";
+
+    for (size_t i = 0; i < InspectStats::kPhaseCount; ++i) {
+        const PhaseHistogram& histogram = phases_[i];
+        out << "  " << std::left << std::setw(12) << InspectStats::name(static_cast<InspectStats::Phase>(i))
+            << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << histogram.totalNs / 1e6
+            << std::setw(10) << histogram.totalNs / 1e3 / documents_
+            << std::setw(10) << percentileUs(histogram, 0.50)
+            << std::setw(10) << percentileUs(histogram, 0.90)
+            << std::setw(10) << percentileUs(histogram, 0.99)
+            << std::setw(10) << histogram.maxNs / 1000 << "\n";
+    }
+
+    out << "\n  Counters (all documents):\n";
+    for (size_t i = 0; i < InspectStats::kCounterCount; ++i) {
+        out << "    " << std::left << std::setw(16) << InspectStats::name(static_cast<InspectStats::Counter>(i))
+            << std::right << std::setw(16) << counters_[i] << "\n";
+    }
+
+    for (size_t i = 0; i < InspectStats::kPhaseCount; ++i) {
+        const PhaseHistogram& histogram = phases_[i];
+        if (histogram.totalNs == 0) {
+            continue;
+        }
+
+        auto first = std::find_if(histogram.buckets.begin(), histogram.buckets.end(),
+                                  [](uint64_t count) { return count > 0; });
+        auto last = std::find_if(histogram.buckets.rbegin(), histogram.buckets.rend(),
+                                 [](uint64_t count) { return count > 0; });
+        uint64_t peak = *std::max_element(histogram.buckets.begin(), histogram.buckets.end());
+
+        out << "\n  " << InspectStats::name(static_cast<InspectStats::Phase>(i)) << " per document:\n";
+        for (size_t bucket = static_cast<size_t>(first - histogram.buckets.begin());
+             bucket < kBucketCount - static_cast<size_t>(last - histogram.buckets.rbegin()); ++bucket) {
+            uint64_t count = histogram.buckets[bucket];
+            size_t bar = static_cast<size_t>(count * kBarWidth / peak);
+            out << "    " << std::left << std::setw(20) << bucketLabel(bucket) << std::right
+                << std::string(bar, '#') << std::string(kBarWidth - bar, ' ')
+                << " " << count << "\n";
+        }
+    }
+
+    out << "\n========================================\n\n";
+}
@@ -0,0 +1,338 @@
+#include "TableScanner.h"
+#include "XmlTokenizer.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Far beyond any spreadsheet application's limits; keeps products of row
+// and column repeats within 64 bits
+constexpr uint64_t kMaxRepeat = uint64_t(1) << 31;
+
+uint64_t parseRepeat(std::string_view value) {
+    uint64_t repeat = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') {
+            break;
+        }
+        repeat = repeat * 10 + static_cast<uint64_t>(c - '0');
+        if (repeat > kMaxRepeat) {
+            return kMaxRepeat;
+        }
+    }
+    return std::max<uint64_t>(repeat, 1);
+}
+
+TableScanner::CellType typeFromValueType(std::string_view valueType) {
+    if (valueType == "float") { return TableScanner::CellType::Float; }
+    if (valueType == "percentage") { return TableScanner::CellType::Percentage; }
+    if (valueType == "currency") { return TableScanner::CellType::Currency; }
+    if (valueType == "date") { return TableScanner::CellType::Date; }
+    if (valueType == "time") { return TableScanner::CellType::Time; }
+    if (valueType == "boolean") { return TableScanner::CellType::Boolean; }
+    return TableScanner::CellType::String;
+}
+
+bool isCell(std::string_view name) {
+    return name == "table:table-cell" || name == "table:covered-table-cell";
+}
+
+} // namespace
+
+TableScanner::TableScanner()
+    : consumed_(0)
+    , tableDepth_(0)
+    , element_(Element::Other)
+    , row_(0)
+    , rowRepeat_(1)
+    , declaredColumns_(0)
+    , inRow_(false)
+    , inCell_(false)
+    , cellHasText_(false)
+    , cellTyped_(false) {
+}
+
+void TableScanner::setRowCallback(RowCallback callback) {
+    rowCallback_ = std::move(callback);
+}
+
+void TableScanner::feed(std::string_view chunk) {
+    if (pending_.empty()) {
+        // Common case: scan straight from the caller's buffer and only copy
+        // the unfinished tail
+        size_t used = process(chunk, false);
+        pending_.assign(chunk.data() + used, chunk.size() - used);
+    } else {
+        // Only new bytes can complete the carried-over markup, so don't
+        // tokenize it again until they might
+        size_t scanned = pending_.size();
+        pending_.append(chunk.data(), chunk.size());
+        if (XmlTokenizer::mayCompleteMarkup(pending_, scanned)) {
+            size_t used = process(pending_, false);
+            pending_.erase(0, used);
+        }
+    }
+
+    if (pending_.size() > XmlTokenizer::kMaxCarryOver) {
+        // Drop the runaway token rather than buffer it
+        process(pending_, true);
+        pending_.clear();
+    }
+}
+
+void TableScanner::finish() {
+    if (!pending_.empty()) {
+        process(pending_, true);
+    }
+    pending_.clear();
+}
+
+const std::vector<TableScanner::SheetStats>& TableScanner::sheets() const {
+    return sheets_;
+}
+
+size_t TableScanner::bytesConsumed() const {
+    return consumed_;
+}
+
+const char* TableScanner::name(CellType type) {
+    switch (type) {
+        case CellType::Empty:      return "empty";
+        case CellType::Float:      return "float";
+        case CellType::Percentage: return "percentage";
+        case CellType::Currency:   return "currency";
+        case CellType::Date:       return "date";
+        case CellType::Time:       return "time";
+        case CellType::Boolean:    return "boolean";
+        case CellType::String:     return "string";
+        case CellType::Count:      break;
+    }
+    return "";
+}
+
+std::string TableScanner::columnName(uint64_t column) {
+    // Bijective base 26: A..Z, AA..ZZ, AAA...
+    std::string letters;
+    uint64_t n = column + 1;
+    while (n > 0) {
+        --n;
+        letters.insert(letters.begin(), static_cast<char>('A' + n % 26));
+        n /= 26;
+    }
+    return letters;
+}
+
+std::string TableScanner::usedRange(const SheetStats& sheet) {
+    if (!sheet.used) {
+        return std::string();
+    }
+    return columnName(sheet.firstUsedColumn) + std::to_string(sheet.firstUsedRow + 1) + ":" +
+           columnName(sheet.lastUsedColumn) + std::to_string(sheet.lastUsedRow + 1);
+}
+
+size_t TableScanner::process(std::string_view data, bool final) {
+    XmlTokenizer tokenizer(data);
+    XmlTokenizer::Token token;
+    size_t used = 0;   // End of the last fully scanned token
+
+    while (tokenizer.next(token)) {
+        switch (token.type) {
+            case XmlTokenizer::TokenType::StartElement:
+                startElement(token.name, tokenizer);
+                break;
+
+            case XmlTokenizer::TokenType::Attribute:
+                attribute(token.name, token.value);
+                continue;   // Part of the start tag already counted as used
+
+            case XmlTokenizer::TokenType::EndElement:
+                endElement(token.name);
+                break;
+
+            case XmlTokenizer::TokenType::Text:
+            case XmlTokenizer::TokenType::CData:
+                // Part of a run cut by the chunk boundary is enough to
+                // tell whether it holds anything but whitespace
+                if (inCell_ && !cellHasText_) {
+                    cellHasText_ = token.value.find_first_not_of(" \t\r\n") != std::string_view::npos;
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        used = static_cast<size_t>(token.raw.data() + token.raw.size() - data.data());
+    }
+
+    // Markup cut off by the chunk boundary is retried with more data; at
+    // the end of the input, whatever the tokenizer couldn't read is dropped
+    if (final) {
+        used = data.size();
+    }
+    consumed_ += used;
+    return used;
+}
+
+void TableScanner::startElement(std::string_view name, XmlTokenizer& tokenizer) {
+    element_ = Element::Other;
+
+    if (name == "table:table") {
+        if (tableDepth_++ == 0) {
+            sheets_.emplace_back();
+            element_ = Element::Table;
+            row_ = 0;
+            declaredColumns_ = 0;
+            return;
+        }
+    } else if (tableDepth_ == 1) {
+        if (name == "table:table-column") {
+            element_ = Element::Column;
+            ++declaredColumns_;
+            return;
+        }
+        if (name == "table:table-row") {
+            element_ = Element::Row;
+            inRow_ = true;
+            rowRepeat_ = 1;
+            cells_.clear();
+            return;
+        }
+        if (inRow_ && isCell(name)) {
+            element_ = Element::Cell;
+            inCell_ = true;
+            cellHasText_ = false;
+            cellTyped_ = false;
+            cell_ = CellRun();
+            cell_.column = cells_.empty() ? 0 : cells_.back().column + cells_.back().repeat;
+            cell_.covered = name == "table:covered-table-cell";
+            return;
+        }
+    }
+
+    tokenizer.skipAttributes();
+}
+
+void TableScanner::attribute(std::string_view name, std::string_view value) {
+    switch (element_) {
+        case Element::Table:
+            if (name == "table:name") {
+                XmlTokenizer::decodeEntities(value, sheets_.back().name);
+            }
+            break;
+
+        case Element::Column:
+            if (name == "table:number-columns-repeated") {
+                declaredColumns_ += parseRepeat(value) - 1;
+            }
+            break;
+
+        case Element::Row:
+            if (name == "table:number-rows-repeated") {
+                rowRepeat_ = parseRepeat(value);
+            }
+            break;
+
+        case Element::Cell:
+            if (name == "table:number-columns-repeated") {
+                cell_.repeat = parseRepeat(value);
+            } else if (name == "office:value-type") {
+                cell_.type = typeFromValueType(value);
+                cellTyped_ = true;
+            } else if (name == "table:formula") {
+                cell_.formula = true;
+            }
+            break;
+
+        case Element::Other:
+            break;
+    }
+}
+
+void TableScanner::endElement(std::string_view name) {
+    if (tableDepth_ == 0) {
+        return;
+    }
+
+    if (name == "table:table") {
+        if (--tableDepth_ == 0) {
+            SheetStats& sheet = sheets_.back();
+            sheet.rows = row_;
+            sheet.columns = std::max(sheet.columns, declaredColumns_);
+            inRow_ = false;
+            inCell_ = false;
+        }
+        return;
+    }
+
+    if (tableDepth_ != 1) {
+        return;
+    }
+    if (inCell_ && isCell(name)) {
+        endCell();
+    } else if (inRow_ && name == "table:table-row") {
+        endRow();
+    }
+}
+
+void TableScanner::endCell() {
+    if (!cellTyped_) {
+        cell_.type = cellHasText_ ? CellType::String : CellType::Empty;
+    }
+    cells_.push_back(cell_);
+    inCell_ = false;
+}
+
+void TableScanner::endRow() {
+    SheetStats& sheet = sheets_.back();
+    bool rowUsed = false;
+
+    for (const CellRun& cell : cells_) {
+        // Repeats multiply instead of being expanded
+        uint64_t logical = rowRepeat_ * cell.repeat;
+        sheet.cells[static_cast<size_t>(cell.type)] += logical;
+        if (cell.formula) {
+            sheet.formulas += logical;
+        }
+        if (cell.covered) {
+            sheet.coveredCells += logical;
+        }
+        if (cell.type == CellType::Empty) {
+            continue;
+        }
+
+        uint64_t lastColumn = cell.column + cell.repeat - 1;
+        if (!sheet.used && !rowUsed) {
+            sheet.firstUsedColumn = cell.column;
+            sheet.lastUsedColumn = lastColumn;
+        } else {
+            sheet.firstUsedColumn = std::min(sheet.firstUsedColumn, cell.column);
+            sheet.lastUsedColumn = std::max(sheet.lastUsedColumn, lastColumn);
+        }
+        rowUsed = true;
+    }
+
+    if (rowUsed) {
+        if (!sheet.used) {
+            sheet.firstUsedRow = row_;
+            sheet.used = true;
+        }
+        sheet.lastUsedRow = row_ + rowRepeat_ - 1;
+    }
+
+    if (!cells_.empty()) {
+        sheet.columns = std::max(sheet.columns, cells_.back().column + cells_.back().repeat);
+    }
+
+    if (rowCallback_) {
+        Row row;
+        row.row = row_;
+        row.repeat = rowRepeat_;
+        row.cells = cells_.data();
+        row.cellCount = cells_.size();
+        rowCallback_(sheets_.size() - 1, row);
+    }
+
+    row_ += rowRepeat_;
+    inRow_ = false;
+}
@@ -0,0 +1,328 @@
+#include "TextExtractor.h"
+#include "SimdScan.h"
+#include "XmlTokenizer.h"
+#include <cstddef>
+#include <utility>
+
+namespace {
+
+// Longest entity decodeEntities() recognises, '&' to ';' inclusive
+constexpr size_t kMaxEntity = 12;
+
+// Far beyond any real document, but keeps a bogus count from running away
+constexpr size_t kMaxSpaces = 1u << 20;
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool endsWithSpace(char c) {
+    return c == '\0' || c == ' ' || c == '\t' || c == '\n';
+}
+
+// Bytes at the end of a text run that may be the start of an entity whose
+// ';' is in the next chunk. Only the last '&' matters: an entity name
+// can't contain another '&'.
+size_t entityTail(std::string_view text) {
+    size_t from = text.size() > kMaxEntity ? text.size() - kMaxEntity : 0;
+    size_t amp = text.rfind('&');
+    if (amp == std::string_view::npos || amp < from ||
+        text.find(';', amp) != std::string_view::npos) {
+        return 0;
+    }
+    return text.size() - amp;
+}
+
+// The predefined entities, which are most of those in real text, without
+// a round trip through decodeEntities(); none of them decodes to whitespace
+char namedEntity(std::string_view name) {
+    if (name == "amp") { return '&'; }
+    if (name == "lt") { return '<'; }
+    if (name == "gt") { return '>'; }
+    if (name == "quot") { return '"'; }
+    if (name == "apos") { return '\''; }
+    return '\0';
+}
+
+size_t parseCount(std::string_view value) {
+    size_t count = 0;
+    for (char c : value) {
+        if (c < '0' || c > '9') {
+            break;
+        }
+        count = count * 10 + static_cast<size_t>(c - '0');
+        if (count > kMaxSpaces) {
+            return kMaxSpaces;
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+TextExtractor::TextExtractor(Writer writer)
+    : writer_(std::move(writer))
+    , consumed_(0)
+    , spaces_(0)
+    , inBody_(false)
+    , inSpace_(false)
+    , inCitation_(false)
+    , afterNote_(false) {
+}
+
+void TextExtractor::feed(std::string_view chunk) {
+    if (pending_.empty()) {
+        // Common case: read straight from the caller's buffer and only copy
+        // the unfinished tail
+        size_t used = process(chunk, false);
+        pending_.assign(chunk.data() + used, chunk.size() - used);
+    } else {
+        // Only new bytes can complete the carried-over markup, so don't
+        // tokenize it again until they might
+        size_t scanned = pending_.size();
+        pending_.append(chunk.data(), chunk.size());
+        if (XmlTokenizer::mayCompleteMarkup(pending_, scanned)) {
+            size_t used = process(pending_, false);
+            pending_.erase(0, used);
+        }
+    }
+
+    if (pending_.size() > XmlTokenizer::kMaxCarryOver) {
+        // Drop the runaway token rather than buffer it
+        process(pending_, true);
+        pending_.clear();
+    }
+}
+
+void TextExtractor::finish() {
+    if (!pending_.empty()) {
+        process(pending_, true);
+    }
+    pending_.clear();
+    flush(true);
+}
+
+size_t TextExtractor::bytesConsumed() const {
+    return consumed_;
+}
+
+size_t TextExtractor::process(std::string_view data, bool final) {
+    XmlTokenizer tokenizer(data);
+    XmlTokenizer::Token token;
+    size_t used = 0;   // End of the last fully processed token
+
+    auto endOf = [&data](const XmlTokenizer::Token& t) {
+        return static_cast<size_t>(t.raw.data() + t.raw.size() - data.data());
+    };
+
+    while (tokenizer.next(token)) {
+        switch (token.type) {
+            case XmlTokenizer::TokenType::StartElement:
+                startElement(token.name, tokenizer);
+                break;
+
+            case XmlTokenizer::TokenType::Attribute:
+                if (inSpace_ && token.name == "text:c") {
+                    spaces_ = parseCount(token.value);
+                }
+                continue;   // Part of the start tag already counted as used
+
+            case XmlTokenizer::TokenType::EndElement:
+                endElement(token.name);
+                break;
+
+            case XmlTokenizer::TokenType::Text:
+                if (!inBody_ || inCitation_) {
+                    break;
+                }
+                // A run touching the end of a chunk is written up to a
+                // possibly incomplete entity, which waits for the next one
+                if (!final && endOf(token) == data.size()) {
+                    size_t tail = entityTail(token.value);
+                    appendText(token.value.substr(0, token.value.size() - tail));
+                    used = data.size() - tail;
+                    flush(false);
+                    consumed_ += used;
+                    return used;
+                }
+                appendText(token.value);
+                break;
+
+            case XmlTokenizer::TokenType::CData:
+                if (inBody_ && !inCitation_) {
+                    text_.append(token.value.data(), token.value.size());
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        used = endOf(token);
+        flush(false);
+    }
+
+    // Markup cut off by the chunk boundary is retried with more data; at
+    // the end of the input, whatever the tokenizer couldn't read is dropped
+    if (final) {
+        used = data.size();
+    }
+    consumed_ += used;
+    return used;
+}
+
+void TextExtractor::startElement(std::string_view name, XmlTokenizer& tokenizer) {
+    if (!inBody_) {
+        inBody_ = name == "office:body";
+        tokenizer.skipAttributes();
+        return;
+    }
+
+    if (name == "text:s") {
+        // The count arrives as an attribute; the spaces go out at the end tag
+        inSpace_ = true;
+        spaces_ = 1;
+        return;
+    }
+
+    tokenizer.skipAttributes();
+    afterNote_ = false;
+    if (name == "text:tab") {
+        append('\t');
+    } else if (name == "text:line-break") {
+        append('\n');
+    } else if (name == "text:note-citation") {
+        inCitation_ = true;
+    } else if (name == "text:note-body") {
+        // The note's paragraphs sit inside the one citing it; start them on
+        // a line of their own rather than run them into its text
+        if (last() == ' ') {
+            text_.back() = '\n';
+        } else if (!endsWithSpace(last())) {
+            append('\n');
+        }
+    }
+}
+
+void TextExtractor::endElement(std::string_view name) {
+    if (!inBody_) {
+        return;
+    }
+
+    if (name == "office:body") {
+        inBody_ = false;
+    } else if (name == "text:s") {
+        appendRepeated(spaces_, ' ');
+        inSpace_ = false;
+    } else if (name == "text:note-citation") {
+        inCitation_ = false;
+    } else if (name == "text:note-body") {
+        afterNote_ = true;
+    } else if (name == "text:p" || name == "text:h") {
+        // A note at the end of the paragraph has already ended the line
+        if (!afterNote_ || last() != '\n') {
+            append('\n');
+        }
+        afterNote_ = false;
+    } else if (name == "table:table-cell") {
+        // The cell's last paragraph ends in a tab instead
+        if (last() == '\n') {
+            text_.back() = '\t';
+        } else {
+            append('\t');
+        }
+    } else if (name == "table:table-row") {
+        if (last() == '\t') {
+            text_.back() = '\n';
+        } else {
+            append('\n');
+        }
+    }
+}
+
+void TextExtractor::appendText(std::string_view raw) {
+    // Plain stretches are collapsed straight from the input; only the
+    // entities themselves go through the decoder
+    const char* p = raw.data();
+    const char* end = p + raw.size();
+
+    while (p < end) {
+        const char* amp = SimdScan::findByte(p, end, '&');
+        appendCollapsed(std::string_view(p, static_cast<size_t>(amp - p)));
+        if (amp == end) {
+            break;
+        }
+
+        // Same rules as decodeEntities(): anything unrecognised stays as-is
+        const char* limit = end - amp > static_cast<ptrdiff_t>(kMaxEntity) ? amp + kMaxEntity : end;
+        const char* semi = SimdScan::findByte(amp + 1, limit, ';');
+        if (semi == limit) {
+            appendCollapsed("&");
+            p = amp + 1;
+            continue;
+        }
+
+        char named = namedEntity(std::string_view(amp + 1, static_cast<size_t>(semi - amp - 1)));
+        if (named != '\0') {
+            text_ += named;
+        } else {
+            decoded_.clear();
+            XmlTokenizer::decodeEntities(std::string_view(amp, static_cast<size_t>(semi + 1 - amp)), decoded_);
+            appendCollapsed(decoded_);
+        }
+        p = semi + 1;
+    }
+}
+
+void TextExtractor::appendCollapsed(std::string_view text) {
+    // ODF collapses runs of whitespace in character data to one space.
+    // Words separated by single spaces are copied as they are.
+    const char* p = text.data();
+    const char* end = p + text.size();
+
+    while (p < end) {
+        if (endsWithSpace(last())) {
+            while (p < end && isSpace(*p)) {
+                ++p;
+            }
+        }
+        const char* run = SimdScan::findSpaceRun(p, end);
+        text_.append(p, static_cast<size_t>(run - p));
+        if (run == end) {
+            break;
+        }
+        if (!endsWithSpace(last())) {
+            text_ += ' ';
+        }
+        p = run + 1;
+    }
+}
+
+void TextExtractor::append(char c) {
+    text_ += c;
+}
+
+void TextExtractor::appendRepeated(size_t count, char c) {
+    while (count > 0) {
+        size_t block = count < kBlockSize ? count : kBlockSize;
+        text_.append(block, c);
+        count -= block;
+        flush(false);
+    }
+}
+
+char TextExtractor::last() const {
+    return text_.empty() ? '\0' : text_.back();
+}
+
+void TextExtractor::flush(bool all) {
+    if (text_.size() < (all ? 1 : kBlockSize)) {
+        return;
+    }
+
+    // Hold back the last character: a closing table cell or row may still
+    // replace it
+    size_t size = all ? text_.size() : text_.size() - 1;
+    writer_(std::string_view(text_.data(), size));
+    text_.erase(0, size);
+}
@@ -0,0 +1,233 @@
+#include "TextSink.h"
+#include <iomanip>
+#include <sstream>
+#include <optional>
+
+TextSink::TextSink(std::ostream& out)
+    : out_(out) {
+}
+
+void TextSink::beginDocument(std::string_view /*path*/) {
+}
+
+void TextSink::endDocument() {
+}
+
+void TextSink::summary(const Summary& summary) {
+    out_ << "\n========================================\n";
+    out_ << "ODF INSPECTOR SUMMARY\n";
+    out_ << "========================================\n\n";
+    out_ << "File: " << summary.path << "\n";
+    out_ << "Type: " << summary.documentType << "\n";
+    out_ << "MIME: " << summary.mimeType << "\n";
+    out_ << "Valid ODF: " << (summary.valid ? "Yes" : "No") << "\n\n";
+
+    // File count
+    if (summary.flat) {
+        out_ << "Flat XML document, sections found: " << summary.fileCount << "\n";
+    } else {
+        out_ << "Total files in archive: " << summary.fileCount << "\n";
+    }
+    
+    // Core files present
+    out_ << "\nCore Files:\n";
+    out_ << "  - content.xml: " << (summary.hasContent ? "Present" : "Missing") << "\n";
+    out_ << "  - meta.xml: " << (summary.hasMeta ? "Present" : "Missing") << "\n";
+    out_ << "  - styles.xml: " << (summary.hasStyles ? "Present" : "Missing") << "\n";
+    out_ << "  - manifest.xml: " << (summary.hasManifest ? "Present" : "Missing") << "\n";
+    
+    out_ << "========================================\n\n";
+}
+
+void TextSink::structure(const std::vector<ZipEntry>& entries) {
+    out_ << "\n========================================\n";
+    out_ << "FILE STRUCTURE\n";
+    out_ << "========================================\n\n";
+
+    for (const auto& entry : entries) {
+        out_ << "  " << std::setw(40) << std::left << entry.name 
+             << std::setw(10) << std::right << entry.uncompressedSize << " bytes\n";
+    }
+
+    out_ << "\n========================================\n\n";
+}
+
+void TextSink::metadata(const ODFMetadata* metadata) {
+    if (metadata == nullptr) {
+        out_ << "Metadata not available\n";
+        return;
+    }
+
+    out_ << "\n========================================\n";
+    out_ << "METADATA (meta.xml)\n";
+    out_ << "========================================\n\n";
+
+    if (metadata->empty()) {
+        out_ << "No metadata extracted\n";
+    } else {
+        auto field = [this](const char* label, const std::string& value) {
+            if (!value.empty()) {
+                out_ << "  " << label << ": " << value << "\n";
+            }
+        };
+
+        field("Title", metadata->title);
+        field("Subject", metadata->subject);
+        field("Description", metadata->description);
+        if (!metadata->keywords.empty()) {
+            out_ << "  Keywords: ";
+            for (size_t i = 0; i < metadata->keywords.size(); ++i) {
+                out_ << (i > 0 ? ", " : "") << metadata->keywords[i];
+            }
+            out_ << "\n";
+        }
+        field("Language", metadata->language);
+        field("Creator", metadata->creator);
+        field("Initial creator", metadata->initialCreator);
+        field("Creation date", metadata->creationDate);
+        field("Date", metadata->date);
+        field("Printed by", metadata->printedBy);
+        field("Print date", metadata->printDate);
+        field("Generator", metadata->generator);
+        if (metadata->editingCycles) {
+            out_ << "  Editing cycles: " << *metadata->editingCycles << "\n";
+        }
+        if (!metadata->editingDuration.empty()) {
+            out_ << "  Editing duration: " << metadata->editingDuration;
+            if (metadata->editingSeconds) {
+                out_ << " (" << *metadata->editingSeconds << " s)";
+            }
+            out_ << "\n";
+        }
+        if (!metadata->templateInfo.href.empty()) {
+            out_ << "  Template: " << metadata->templateInfo.href;
+            if (!metadata->templateInfo.title.empty()) {
+                out_ << " (" << metadata->templateInfo.title << ")";
+            }
+            out_ << "\n";
+        }
+        field("Auto reload", metadata->autoReload.href);
+        field("Hyperlink target frame", metadata->hyperlinkBehaviour.targetFrameName);
+
+        const ODFMetadata::DocumentStatistic& stats = metadata->statistics;
+        const std::pair<const char*, const std::optional<uint64_t>&> counts[] = {
+            { "Pages", stats.pageCount },
+            { "Paragraphs", stats.paragraphCount },
+            { "Words", stats.wordCount },
+            { "Characters", stats.characterCount },
+            { "Non-whitespace characters", stats.nonWhitespaceCharacterCount },
+            { "Sentences", stats.sentenceCount },
+            { "Syllables", stats.syllableCount },
+            { "Tables", stats.tableCount },
+            { "Rows", stats.rowCount },
+            { "Cells", stats.cellCount },
+            { "Images", stats.imageCount },
+            { "Drawings", stats.drawCount },
+            { "Frames", stats.frameCount },
+            { "Objects", stats.objectCount },
+            { "OLE objects", stats.oleObjectCount }
+        };
+        bool heading = false;
+        for (const auto& [label, count] : counts) {
+            if (count) {
+                if (!heading) {
+                    out_ << "\n  Statistics:\n";
+                    heading = true;
+                }
+                out_ << "    " << label << ": " << *count << "\n";
+            }
+        }
+
+        if (!metadata->userDefined.empty()) {
+            out_ << "\n  User-defined:\n";
+            for (const auto& user : metadata->userDefined) {
+                out_ << "    " << user.name << ": " << user.value;
+                if (!user.valueType.empty() && user.valueType != "string") {
+                    out_ << " [" << user.valueType << "]";
+                }
+                out_ << "\n";
+            }
+        }
+    }
+
+    out_ << "\n========================================\n\n";
+}
+
+void TextSink::images(const std::vector<const ZipEntry*>& images) {
+    out_ << "\n========================================\n";
+    out_ << "EMBEDDED IMAGES\n";
+    out_ << "========================================\n\n";
+
+    for (const ZipEntry* image : images) {
+        out_ << "  " << image->name << " (" << image->uncompressedSize << " bytes)\n";
+    }
+
+    if (images.empty()) {
+        out_ << "  No embedded images found\n";
+    }
+
+    out_ << "\n========================================\n\n";
+}
+
+void TextSink::tables(const std::vector<TableScanner::SheetStats>& sheets) {
+    out_ << "\n========================================\n";
+    out_ << "TABLES\n";
+    out_ << "========================================\n\n";
+
+    for (size_t i = 0; i < sheets.size(); ++i) {
+        const TableScanner::SheetStats& sheet = sheets[i];
+        out_ << "  Table " << (i + 1) << ": " << sheet.name << "\n";
+        out_ << "    Rows: " << sheet.rows << "\n";
+        out_ << "    Columns: " << sheet.columns << "\n";
+        out_ << "    Used range: " << (sheet.used ? TableScanner::usedRange(sheet) : "none") << "\n";
+
+        out_ << "    Cells:\n";
+        for (size_t t = 0; t < TableScanner::kCellTypeCount; ++t) {
+            if (sheet.cells[t] != 0) {
+                out_ << "      " << std::setw(12) << std::left << TableScanner::name(static_cast<TableScanner::CellType>(t))
+                     << std::setw(16) << std::right << sheet.cells[t] << "\n";
+            }
+        }
+        if (sheet.formulas != 0) {
+            out_ << "    Formulas: " << sheet.formulas << "\n";
+        }
+        if (sheet.coveredCells != 0) {
+            out_ << "    Covered cells: " << sheet.coveredCells << "\n";
+        }
+        out_ << "\n";
+    }
+
+    if (sheets.empty()) {
+        out_ << "  No tables found\n\n";
+    }
+
+    out_ << "========================================\n\n";
+}
+
+void TextSink::error(std::string_view message) {
+    out_ << message << "\n";
+}
+
+void TextSink::stats(const InspectStats& stats) {
+    out_ << "\n========================================\n";
+    out_ << "STATISTICS\n";
+    out_ << "========================================\n\n";
+
+    // Format the times on a scratch stream to leave out_'s flags alone
+    std::ostringstream times;
+    times << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < InspectStats::kPhaseCount; ++i) {
+        auto phase = static_cast<InspectStats::Phase>(i);
+        times << "  " << std::setw(16) << std::left << InspectStats::name(phase)
+              << std::setw(12) << std::right << stats.time(phase) / 1e6 << " ms\n";
+    }
+    out_ << times.str() << "\n";
+
+    for (size_t i = 0; i < InspectStats::kCounterCount; ++i) {
+        auto counter = static_cast<InspectStats::Counter>(i);
+        out_ << "  " << std::setw(16) << std::left << InspectStats::name(counter)
+             << std::setw(12) << std::right << stats.count(counter) << "\n";
+    }
+
+    out_ << "========================================\n\n";
+}
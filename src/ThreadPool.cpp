@@ -0,0 +1,161 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace {
+
+// Identifies the pool and deque of the current worker thread, if any
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threadCount, size_t maxQueued)
+    : queued_(0)
+    , pending_(0)
+    , maxQueued_(maxQueued)
+    , nextQueue_(0)
+    , stopping_(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    queues_.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+
+    threads_.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    // Exceptions are for wait(); a destructor can't report them
+    waitIdle();
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        stopping_ = true;
+    }
+    taskAvailable_.notify_all();
+
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(Task task) {
+    bool fromWorker = currentPool == this;
+    size_t target;
+
+    {
+        std::unique_lock<std::mutex> lock(stateMutex_);
+        // Workers never block on a full queue, or nested submissions
+        // could deadlock the pool
+        if (maxQueued_ > 0 && !fromWorker) {
+            spaceAvailable_.wait(lock, [this] { return queued_ < maxQueued_; });
+        }
+        target = fromWorker ? currentWorker : nextQueue_++ % queues_.size();
+        ++pending_;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        ++queued_;
+    }
+    taskAvailable_.notify_one();
+}
+
+void ThreadPool::wait() {
+    waitIdle();
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        std::swap(error, firstError_);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(stateMutex_);
+    allDone_.wait(lock, [this] { return pending_ == 0; });
+}
+
+size_t ThreadPool::size() const {
+    return threads_.size();
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentWorker = index;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex_);
+            taskAvailable_.wait(lock, [this] { return queued_ > 0 || stopping_; });
+            if (queued_ == 0) {
+                return;
+            }
+            // Claim one task; it is guaranteed to be in some deque
+            --queued_;
+        }
+        spaceAvailable_.notify_one();
+
+        Task task = takeTask(index);
+        std::exception_ptr error;
+        try {
+            task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        bool finished;
+        {
+            std::lock_guard<std::mutex> lock(stateMutex_);
+            if (error && !firstError_) {
+                firstError_ = error;
+            }
+            finished = --pending_ == 0;
+        }
+        if (finished) {
+            allDone_.notify_all();
+        }
+    }
+}
+
+ThreadPool::Task ThreadPool::takeTask(size_t index) {
+    for (;;) {
+        // Newest task from our own deque keeps caches warm...
+        {
+            WorkQueue& own = *queues_[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                Task task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return task;
+            }
+        }
+
+        // ...otherwise steal the oldest task from a sibling
+        for (size_t offset = 1; offset < queues_.size(); ++offset) {
+            WorkQueue& victim = *queues_[(index + offset) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                Task task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return task;
+            }
+        }
+
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,444 @@
+#include "XmlDiff.h"
+#include "XmlTokenizer.h"
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+// Patience levels before gaps are only paired by name
+constexpr int kMaxAnchorDepth = 8;
+
+// Largest gap (old x new children) aligned by an exact LCS of names;
+// bigger ones are paired greedily
+constexpr size_t kMaxLcsCells = size_t(1) << 20;
+
+constexpr uint64_t kTextKey = 0x74657874;   // Keys of text and CDATA nodes
+constexpr uint64_t kCDataKey = 0x63646174;
+
+// Text and CDATA nodes are both text() in a path and share its numbering
+uint64_t stepKey(uint64_t key) {
+    return key == kCDataKey ? kTextKey : key;
+}
+
+uint64_t combine(uint64_t seed, uint64_t value) {
+    uint64_t hash = (seed ^ value) * 0x9E3779B97F4A7C15ull;
+    return hash ^ (hash >> 32);
+}
+
+uint64_t hashText(std::string_view text) {
+    return std::hash<std::string_view>()(text);
+}
+
+const XmlTree::Attribute* findAttribute(const XmlTree& tree, XmlTree::NodeId id, std::string_view name) {
+    const XmlTree::Attribute* first = tree.attributes(id);
+    const XmlTree::Attribute* last = first + tree.node(id).attributeCount;
+    for (const XmlTree::Attribute* a = first; a != last; ++a) {
+        if (tree.name(a->name) == name) {
+            return a;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+XmlDiff::XmlDiff(const XmlTree& before, const XmlTree& after)
+    : callback_(nullptr)
+    , changes_(0) {
+    before_.tree = &before;
+    after_.tree = &after;
+}
+
+size_t XmlDiff::run(const Callback& callback) {
+    callback_ = &callback;
+    changes_ = 0;
+
+    // The trees are independent; hash the new one alongside
+    std::thread worker([this]() { hashTree(after_); });
+    hashTree(before_);
+    worker.join();
+
+    XmlTree::NodeId before = before_.tree->root();
+    XmlTree::NodeId after = after_.tree->root();
+
+    if (before != XmlTree::kNoNode && after != XmlTree::kNoNode &&
+        key(before_, before) == key(after_, after)) {
+        if (before_.hashes[before] != after_.hashes[after]) {
+            path_ = "/";
+            path_ += after_.tree->name(after_.tree->node(after).name);
+            diffElement(before, after);
+        }
+        return changes_;
+    }
+
+    // Different document elements have nothing in common
+    if (before != XmlTree::kNoNode) {
+        path_ = "/";
+        path_ += before_.tree->name(before_.tree->node(before).name);
+        report(ChangeType::Removed, std::string_view(), std::string_view());
+    }
+    if (after != XmlTree::kNoNode) {
+        path_ = "/";
+        path_ += after_.tree->name(after_.tree->node(after).name);
+        report(ChangeType::Added, std::string_view(), std::string_view());
+    }
+    return changes_;
+}
+
+void XmlDiff::hashTree(Side& side) {
+    // Children come after their parent, so a backwards pass sees every
+    // child's hash before the parent needs it
+    const XmlTree& tree = *side.tree;
+    side.hashes.assign(tree.size(), 0);
+
+    for (size_t i = tree.size(); i-- > 0;) {
+        auto id = static_cast<XmlTree::NodeId>(i);
+        const XmlTree::Node& node = tree.node(id);
+        uint64_t hash = key(side, id);
+
+        if (node.type == XmlTree::NodeType::Element) {
+            // Attribute order is not significant in XML
+            uint64_t attributes = 0;
+            const XmlTree::Attribute* first = tree.attributes(id);
+            for (const XmlTree::Attribute* a = first; a != first + node.attributeCount; ++a) {
+                attributes += combine(nameHash(side, a->name), hashText(a->value));
+            }
+            hash = combine(hash, attributes);
+
+            for (XmlTree::NodeId child = tree.firstChild(id); child != XmlTree::kNoNode;
+                 child = tree.node(child).nextSibling) {
+                hash = combine(hash, side.hashes[child]);
+            }
+        } else {
+            hash = combine(hash, hashText(node.text));
+        }
+
+        side.hashes[id] = hash;
+    }
+}
+
+uint64_t XmlDiff::nameHash(Side& side, XmlTree::NameId name) {
+    // Name ids differ between the trees; hashes of the names do not
+    if (name >= side.nameHashes.size()) {
+        side.nameHashes.resize(name + 1, 0);
+    }
+    uint64_t& hash = side.nameHashes[name];
+    if (hash == 0) {
+        hash = hashText(side.tree->name(name)) | 1;
+    }
+    return hash;
+}
+
+uint64_t XmlDiff::key(Side& side, XmlTree::NodeId id) {
+    const XmlTree::Node& node = side.tree->node(id);
+    switch (node.type) {
+        case XmlTree::NodeType::Element: return nameHash(side, node.name);
+        case XmlTree::NodeType::Text:    return kTextKey;
+        case XmlTree::NodeType::CData:   return kCDataKey;
+    }
+    return 0;
+}
+
+void XmlDiff::collectChildren(Side& side, XmlTree::NodeId parent, Children& children) {
+    const XmlTree& tree = *side.tree;
+    children.side = &side;
+    for (XmlTree::NodeId child = tree.firstChild(parent); child != XmlTree::kNoNode;
+         child = tree.node(child).nextSibling) {
+        children.ids.push_back(child);
+        children.keys.push_back(key(side, child));
+    }
+}
+
+std::string_view XmlDiff::decode(std::string_view raw, std::string& scratch) {
+    if (raw.find('&') == std::string_view::npos) {
+        return raw;
+    }
+    scratch.clear();
+    XmlTokenizer::decodeEntities(raw, scratch);
+    return scratch;
+}
+
+std::string_view XmlDiff::nodeText(const Side& side, XmlTree::NodeId id, std::string& scratch) {
+    if (id == XmlTree::kNoNode) {
+        return std::string_view();
+    }
+    const XmlTree::Node& node = side.tree->node(id);
+    return node.type == XmlTree::NodeType::Text ? decode(node.text, scratch) : node.text;
+}
+
+void XmlDiff::report(ChangeType type, std::string_view before, std::string_view after) {
+    // Raw values can differ only in how characters are escaped
+    if (type == ChangeType::Changed && before == after) {
+        return;
+    }
+    ++changes_;
+    (*callback_)({ type, path_, before, after });
+}
+
+void XmlDiff::diffElement(XmlTree::NodeId before, XmlTree::NodeId after) {
+    // An explicit stack rather than recursion: nesting depth is up to the
+    // document, and paired elements are entered before their later siblings
+    // so changes still come out in document order
+    std::vector<Frame> frames;
+    auto enter = [this, &frames](XmlTree::NodeId oldId, XmlTree::NodeId newId) {
+        diffAttributes(oldId, newId);
+        frames.emplace_back();
+        Frame& frame = frames.back();
+        frame.length = path_.size();
+        collectChildren(before_, oldId, frame.oldChildren);
+        collectChildren(after_, newId, frame.newChildren);
+        align(frame.oldChildren, frame.newChildren, 0, frame.oldChildren.ids.size(),
+              0, frame.newChildren.ids.size(), 0, frame.ops);
+    };
+    enter(before, after);
+
+    while (!frames.empty()) {
+        Frame& frame = frames.back();
+        if (frame.next == frame.ops.size()) {
+            frames.pop_back();
+            continue;
+        }
+        path_.resize(frame.length);
+        const Op op = frame.ops[frame.next++];
+
+        XmlTree::NodeId oldId = op.type == OpType::Insert ? XmlTree::kNoNode : frame.oldChildren.ids[op.before];
+        XmlTree::NodeId newId = op.type == OpType::Remove ? XmlTree::kNoNode : frame.newChildren.ids[op.after];
+        std::string_view oldText = nodeText(before_, oldId, beforeText_);
+        std::string_view newText = nodeText(after_, newId, afterText_);
+
+        if (op.type == OpType::Remove) {
+            appendStep(frame.oldChildren, op.before);
+            report(ChangeType::Removed, oldText, std::string_view());
+        } else if (op.type == OpType::Insert) {
+            appendStep(frame.newChildren, op.after);
+            report(ChangeType::Added, std::string_view(), newText);
+        } else {
+            appendStep(frame.newChildren, op.after);
+            if (before_.tree->node(oldId).type == XmlTree::NodeType::Element) {
+                enter(oldId, newId);    // Invalidates frame
+            } else {
+                report(ChangeType::Changed, oldText, newText);
+            }
+        }
+    }
+}
+
+void XmlDiff::diffAttributes(XmlTree::NodeId before, XmlTree::NodeId after) {
+    const XmlTree& oldTree = *before_.tree;
+    const XmlTree& newTree = *after_.tree;
+    size_t length = path_.size();
+
+    auto step = [this, length](std::string_view name) {
+        path_.resize(length);
+        path_ += "/@";
+        path_ += name;
+    };
+
+    const XmlTree::Attribute* first = oldTree.attributes(before);
+    for (const XmlTree::Attribute* a = first; a != first + oldTree.node(before).attributeCount; ++a) {
+        std::string_view name = oldTree.name(a->name);
+        const XmlTree::Attribute* match = findAttribute(newTree, after, name);
+        if (match == nullptr) {
+            step(name);
+            report(ChangeType::Removed, decode(a->value, beforeText_), std::string_view());
+        } else if (match->value != a->value) {
+            step(name);
+            report(ChangeType::Changed, decode(a->value, beforeText_), decode(match->value, afterText_));
+        }
+    }
+
+    first = newTree.attributes(after);
+    for (const XmlTree::Attribute* a = first; a != first + newTree.node(after).attributeCount; ++a) {
+        std::string_view name = newTree.name(a->name);
+        if (findAttribute(oldTree, before, name) == nullptr) {
+            step(name);
+            report(ChangeType::Added, std::string_view(), decode(a->value, afterText_));
+        }
+    }
+
+    path_.resize(length);
+}
+
+void XmlDiff::align(const Children& before, const Children& after, size_t b0, size_t b1,
+                    size_t a0, size_t a1, int depth, std::vector<Op>& ops) const {
+    auto same = [&](size_t b, size_t a) {
+        return before.side->hashes[before.ids[b]] == after.side->hashes[after.ids[a]];
+    };
+
+    // Unchanged runs at both ends
+    while (b0 < b1 && a0 < a1 && same(b0, a0)) {
+        ++b0;
+        ++a0;
+    }
+    size_t suffix = 0;
+    while (b0 < b1 - suffix && a0 < a1 - suffix && same(b1 - suffix - 1, a1 - suffix - 1)) {
+        ++suffix;
+    }
+    b1 -= suffix;
+    a1 -= suffix;
+
+    // Anchors: subtrees that occur exactly once on each side
+    std::vector<std::pair<uint32_t, uint32_t>> candidates;
+    if (b0 < b1 && a0 < a1 && depth < kMaxAnchorDepth) {
+        struct Slot {
+            uint32_t before = 0;
+            uint32_t after = 0;
+            uint32_t beforeIndex = 0;
+            uint32_t afterIndex = 0;
+        };
+        std::unordered_map<uint64_t, Slot> slots;
+        slots.reserve(b1 - b0);
+        for (size_t i = b0; i < b1; ++i) {
+            Slot& slot = slots[before.side->hashes[before.ids[i]]];
+            ++slot.before;
+            slot.beforeIndex = static_cast<uint32_t>(i);
+        }
+        for (size_t j = a0; j < a1; ++j) {
+            auto it = slots.find(after.side->hashes[after.ids[j]]);
+            if (it != slots.end()) {
+                ++it->second.after;
+                it->second.afterIndex = static_cast<uint32_t>(j);
+            }
+        }
+        for (size_t i = b0; i < b1; ++i) {
+            const Slot& slot = slots[before.side->hashes[before.ids[i]]];
+            if (slot.before == 1 && slot.after == 1) {
+                candidates.emplace_back(static_cast<uint32_t>(i), slot.afterIndex);
+            }
+        }
+    }
+
+    if (candidates.empty()) {
+        pairByName(before, after, b0, b1, a0, a1, ops);
+    } else {
+        // Longest run of candidates in order on both sides (patience sort)
+        std::vector<size_t> tails;
+        std::vector<size_t> previous(candidates.size(), SIZE_MAX);
+        for (size_t k = 0; k < candidates.size(); ++k) {
+            auto pos = std::lower_bound(tails.begin(), tails.end(), candidates[k].second,
+                [&candidates](size_t t, uint32_t value) { return candidates[t].second < value; });
+            if (pos != tails.begin()) {
+                previous[k] = *(pos - 1);
+            }
+            if (pos == tails.end()) {
+                tails.push_back(k);
+            } else {
+                *pos = k;
+            }
+        }
+        std::vector<std::pair<uint32_t, uint32_t>> anchors;
+        for (size_t k = tails.back(); k != SIZE_MAX; k = previous[k]) {
+            anchors.push_back(candidates[k]);
+        }
+        std::reverse(anchors.begin(), anchors.end());
+
+        size_t b = b0;
+        size_t a = a0;
+        for (const auto& anchor : anchors) {
+            align(before, after, b, anchor.first, a, anchor.second, depth + 1, ops);
+            b = anchor.first + 1;
+            a = anchor.second + 1;
+        }
+        align(before, after, b, b1, a, a1, depth + 1, ops);
+    }
+}
+
+void XmlDiff::pairByName(const Children& before, const Children& after, size_t b0, size_t b1,
+                         size_t a0, size_t a1, std::vector<Op>& ops) const {
+    auto pair = [&](size_t b, size_t a) {
+        if (before.side->hashes[before.ids[b]] != after.side->hashes[after.ids[a]]) {
+            ops.push_back({ OpType::Pair, static_cast<uint32_t>(b), static_cast<uint32_t>(a) });
+        }
+    };
+    auto remove = [&ops](size_t b) { ops.push_back({ OpType::Remove, static_cast<uint32_t>(b), 0 }); };
+    auto insert = [&ops](size_t a) { ops.push_back({ OpType::Insert, 0, static_cast<uint32_t>(a) }); };
+
+    size_t n = b1 - b0;
+    size_t m = a1 - a0;
+
+    if (n > 0 && m > 0 && (n + 1) * (m + 1) <= kMaxLcsCells) {
+        // Longest common subsequence of names; table[i][j] covers the
+        // suffixes from b0 + i and a0 + j
+        std::vector<uint32_t> table((n + 1) * (m + 1), 0);
+        auto at = [&table, m](size_t i, size_t j) -> uint32_t& { return table[i * (m + 1) + j]; };
+        for (size_t i = n; i-- > 0;) {
+            for (size_t j = m; j-- > 0;) {
+                at(i, j) = before.keys[b0 + i] == after.keys[a0 + j]
+                    ? at(i + 1, j + 1) + 1 : std::max(at(i + 1, j), at(i, j + 1));
+            }
+        }
+
+        size_t i = 0;
+        size_t j = 0;
+        while (i < n && j < m) {
+            if (before.keys[b0 + i] == after.keys[a0 + j]) {
+                pair(b0 + i++, a0 + j++);
+            } else if (at(i + 1, j) >= at(i, j + 1)) {
+                remove(b0 + i++);
+            } else {
+                insert(a0 + j++);
+            }
+        }
+        b0 += i;
+        a0 += j;
+    } else {
+        // Too big for a table: pair in order, looking one node ahead
+        while (b0 < b1 && a0 < a1) {
+            if (before.keys[b0] == after.keys[a0]) {
+                pair(b0++, a0++);
+            } else if (a0 + 1 < a1 && before.keys[b0] == after.keys[a0 + 1]) {
+                insert(a0++);
+            } else if (b0 + 1 < b1 && before.keys[b0 + 1] == after.keys[a0]) {
+                remove(b0++);
+            } else {
+                remove(b0++);
+                insert(a0++);
+            }
+        }
+    }
+
+    while (b0 < b1) {
+        remove(b0++);
+    }
+    while (a0 < a1) {
+        insert(a0++);
+    }
+}
+
+void XmlDiff::appendStep(Children& children, size_t index) {
+    const XmlTree& tree = *children.side->tree;
+    const XmlTree::Node& node = tree.node(children.ids[index]);
+    const std::vector<uint64_t>& keys = children.keys;
+    uint64_t key = stepKey(keys[index]);
+    auto sameStep = [key](uint64_t k) { return stepKey(k) == key; };
+
+    // Steps are appended in increasing order on each side, so counting on
+    // from the previous step with the same key is enough
+    auto cursor = std::find_if(children.cursors.begin(), children.cursors.end(),
+                               [key](const Cursor& c) { return c.key == key; });
+    if (cursor == children.cursors.end()) {
+        size_t first = std::find_if(keys.begin(), keys.end(), sameStep) - keys.begin();
+        bool repeated = std::find_if(keys.begin() + first + 1, keys.end(), sameStep) != keys.end();
+        children.cursors.push_back({ key, first, 1, repeated });
+        cursor = children.cursors.end() - 1;
+    }
+    for (size_t i = cursor->index; i < index; ++i) {
+        if (sameStep(keys[i + 1])) {
+            ++cursor->ordinal;
+        }
+    }
+    cursor->index = index;
+
+    path_ += '/';
+    if (node.type == XmlTree::NodeType::Element) {
+        path_ += tree.name(node.name);
+    } else {
+        path_ += "text()";
+    }
+    if (cursor->repeated) {
+        path_ += '[';
+        path_ += std::to_string(cursor->ordinal);
+        path_ += ']';
+    }
+}
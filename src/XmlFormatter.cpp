@@ -0,0 +1,216 @@
+#include "XmlFormatter.h"
+#include "XmlTokenizer.h"
+#include <algorithm>
+
+XmlFormatter::XmlFormatter(size_t outputLimit)
+    : limit_(outputLimit)
+    , consumed_(0)
+    , indent_(0)
+    , last_(Last::Nothing)
+    , truncated_(false)
+    , inText_(false)
+    , textStarted_(false) {
+}
+
+bool XmlFormatter::feed(std::string_view chunk) {
+    if (truncated_) {
+        return false;
+    }
+
+    if (pending_.empty()) {
+        // Common case: format straight from the caller's buffer and only
+        // copy the unfinished tail
+        size_t used = process(chunk, false);
+        if (!truncated_) {
+            pending_.assign(chunk.data() + used, chunk.size() - used);
+        }
+    } else {
+        // Only new bytes can complete the carried-over markup, so don't
+        // tokenize it again until they might
+        size_t scanned = pending_.size();
+        pending_.append(chunk.data(), chunk.size());
+        if (XmlTokenizer::mayCompleteMarkup(pending_, scanned)) {
+            size_t used = process(pending_, false);
+            pending_.erase(0, used);
+        }
+    }
+
+    if (pending_.size() > XmlTokenizer::kMaxCarryOver) {
+        // Show the runaway token as it is, and stop there
+        process(pending_, true);
+        pending_.clear();
+        truncated_ = true;
+    }
+
+    return !truncated_;
+}
+
+void XmlFormatter::finish() {
+    if (!truncated_ && !pending_.empty()) {
+        process(pending_, true);
+    }
+    pending_.clear();
+    inText_ = false;
+}
+
+const std::string& XmlFormatter::output() const {
+    return output_;
+}
+
+bool XmlFormatter::isTruncated() const {
+    return truncated_;
+}
+
+size_t XmlFormatter::bytesConsumed() const {
+    return consumed_;
+}
+
+void XmlFormatter::newLine() {
+    if (output_.empty() || !append("\n")) {
+        return;
+    }
+
+    size_t spaces = indent_ * 2;
+    size_t room = limit_ - output_.size();
+    if (spaces > room) {
+        output_.append(room, ' ');
+        truncated_ = true;
+        return;
+    }
+    output_.append(spaces, ' ');
+}
+
+bool XmlFormatter::append(std::string_view text) {
+    if (truncated_) {
+        return false;
+    }
+
+    size_t room = limit_ - output_.size();
+    if (text.size() > room) {
+        output_.append(text.data(), room);
+        truncated_ = true;
+        return false;
+    }
+
+    output_.append(text.data(), text.size());
+    return true;
+}
+
+void XmlFormatter::appendText(std::string_view text, bool open) {
+    // Runs are trimmed as a whole: leading whitespace is dropped, and
+    // whitespace is held back until more text shows it isn't trailing
+    if (!inText_) {
+        textStarted_ = false;
+        heldSpace_.clear();
+    }
+    inText_ = open;
+
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+        if (textStarted_) {
+            holdSpace(text);
+        }
+        return;
+    }
+
+    size_t lastChar = text.find_last_not_of(" \t\r\n");
+    if (textStarted_) {
+        append(heldSpace_);
+        first = 0;
+    }
+    append(text.substr(first, lastChar - first + 1));
+    heldSpace_.clear();
+    holdSpace(text.substr(lastChar + 1));
+    textStarted_ = true;
+    last_ = Last::Text;
+}
+
+void XmlFormatter::holdSpace(std::string_view space) {
+    // More than fits in the output can't be shown anyway
+    size_t room = limit_ - output_.size();
+    if (heldSpace_.size() < room) {
+        heldSpace_.append(space.data(), std::min(space.size(), room - heldSpace_.size()));
+    }
+}
+
+size_t XmlFormatter::process(std::string_view data, bool final) {
+    XmlTokenizer tokenizer(data);
+    XmlTokenizer::Token token;
+    size_t used = 0;   // End of the last fully formatted token
+
+    auto endOf = [&data](const XmlTokenizer::Token& t) {
+        return static_cast<size_t>(t.raw.data() + t.raw.size() - data.data());
+    };
+
+    while (!truncated_ && tokenizer.next(token)) {
+        switch (token.type) {
+            case XmlTokenizer::TokenType::StartElement:
+                tokenizer.skipAttributes();
+                newLine();
+                append(token.raw);
+                if (!token.selfClosing) {
+                    ++indent_;
+                    last_ = Last::StartTag;
+                } else {
+                    last_ = Last::Other;
+                }
+                break;
+
+            case XmlTokenizer::TokenType::EndElement:
+                if (token.selfClosing) {
+                    break;
+                }
+                if (indent_ > 0) {
+                    --indent_;
+                }
+                // Text-only and empty elements stay on one line
+                if (last_ != Last::Text && last_ != Last::StartTag) {
+                    newLine();
+                }
+                append(token.raw);
+                last_ = Last::Other;
+                break;
+
+            case XmlTokenizer::TokenType::Text:
+                // A run touching the end of a chunk may continue in the next one
+                appendText(token.value, !final && endOf(token) == data.size());
+                break;
+
+            case XmlTokenizer::TokenType::Attribute:
+                break;
+
+            case XmlTokenizer::TokenType::CData:
+                append(token.raw);
+                last_ = Last::Text;
+                break;
+
+            default:
+                newLine();
+                append(token.raw);
+                last_ = Last::Other;
+                break;
+        }
+
+        if (token.type != XmlTokenizer::TokenType::Attribute) {
+            used = endOf(token);
+            if (token.type != XmlTokenizer::TokenType::Text) {
+                inText_ = false;
+            }
+        }
+    }
+
+    if (tokenizer.hasError() && !truncated_) {
+        if (!final) {
+            // Most likely markup cut off by the chunk boundary; retry with more data
+            consumed_ += used;
+            return used;
+        }
+        // Show malformed input as-is from the point the tokenizer gave up
+        newLine();
+        append(data.substr(used));
+        used = data.size();
+    }
+
+    consumed_ += used;
+    return used;
+}
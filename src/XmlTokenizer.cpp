@@ -0,0 +1,406 @@
+#include "XmlTokenizer.h"
+#include "SimdScan.h"
+#include <cstring>
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+const char* skipSpace(const char* p, const char* end) {
+    while (p < end && isSpace(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+const char* findChar(const char* p, const char* end, char c) {
+    return SimdScan::findByte(p, end, c);
+}
+
+// Name characters end at whitespace or markup delimiters
+const char* scanName(const char* p, const char* end) {
+    while (p < end && !isSpace(*p) && *p != '>' && *p != '/' && *p != '=' && *p != '?') {
+        ++p;
+    }
+    return p;
+}
+
+void appendUtf8(unsigned long cp, std::string& out) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// Decode one entity body (between '&' and ';'); false if unrecognised
+bool decodeEntity(std::string_view entity, std::string& out) {
+    if (entity == "amp") { out += '&'; return true; }
+    if (entity == "lt") { out += '<'; return true; }
+    if (entity == "gt") { out += '>'; return true; }
+    if (entity == "quot") { out += '"'; return true; }
+    if (entity == "apos") { out += '\''; return true; }
+
+    if (entity.size() < 2 || entity[0] != '#') {
+        return false;
+    }
+
+    bool hex = entity[1] == 'x' || entity[1] == 'X';
+    size_t i = hex ? 2 : 1;
+    if (i == entity.size()) {
+        return false;
+    }
+
+    unsigned long cp = 0;
+    for (; i < entity.size(); ++i) {
+        char c = entity[i];
+        unsigned digit;
+        if (c >= '0' && c <= '9') {
+            digit = static_cast<unsigned>(c - '0');
+        } else if (hex && c >= 'a' && c <= 'f') {
+            digit = static_cast<unsigned>(c - 'a' + 10);
+        } else if (hex && c >= 'A' && c <= 'F') {
+            digit = static_cast<unsigned>(c - 'A' + 10);
+        } else {
+            return false;
+        }
+        cp = cp * (hex ? 16 : 10) + digit;
+        if (cp > 0x10FFFF) {
+            return false;
+        }
+    }
+
+    if (cp == 0 || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        return false;
+    }
+
+    appendUtf8(cp, out);
+    return true;
+}
+
+} // namespace
+
+XmlTokenizer::XmlTokenizer(std::string_view input)
+    : begin_(input.data())
+    , pos_(input.data())
+    , end_(input.data() + input.size())
+    , tagEnd_(nullptr)
+    , state_(State::Content)
+    , depth_(0)
+    , selfClosing_(false)
+    , error_(false) {
+}
+
+bool XmlTokenizer::next(Token& token) {
+    if (error_) {
+        return false;
+    }
+
+    if (state_ == State::Attributes) {
+        if (readAttribute(token)) {
+            return true;
+        }
+        if (error_) {
+            return false;
+        }
+
+        // The start tag is finished; empty elements close right here
+        state_ = State::Content;
+        pos_ = tagEnd_ + (selfClosing_ ? 2 : 1);
+        if (selfClosing_) {
+            token = Token();
+            token.type = TokenType::EndElement;
+            token.name = element_;
+            token.raw = std::string_view(tagEnd_, 2);
+            token.selfClosing = true;
+            return true;
+        }
+    }
+
+    if (pos_ >= end_) {
+        return false;
+    }
+
+    if (*pos_ == '<') {
+        return readMarkup(token);
+    }
+
+    const char* lt = findChar(pos_, end_, '<');
+    token = Token();
+    token.type = TokenType::Text;
+    token.value = std::string_view(pos_, static_cast<size_t>(lt - pos_));
+    token.raw = token.value;
+    pos_ = lt;
+    return true;
+}
+
+void XmlTokenizer::skipAttributes() {
+    if (state_ == State::Attributes) {
+        pos_ = tagEnd_;
+    }
+}
+
+bool XmlTokenizer::hasError() const {
+    return error_;
+}
+
+size_t XmlTokenizer::offset() const {
+    return static_cast<size_t>(pos_ - begin_);
+}
+
+size_t XmlTokenizer::depth() const {
+    return depth_;
+}
+
+std::string_view XmlTokenizer::localName(std::string_view qname) {
+    size_t colon = qname.find(':');
+    return colon == std::string_view::npos ? qname : qname.substr(colon + 1);
+}
+
+void XmlTokenizer::decodeEntities(std::string_view raw, std::string& out) {
+    const char* p = raw.data();
+    const char* end = p + raw.size();
+
+    while (p < end) {
+        const char* amp = findChar(p, end, '&');
+        out.append(p, static_cast<size_t>(amp - p));
+        if (amp == end) {
+            break;
+        }
+
+        // Entity names are short; anything longer is passed through as-is
+        const char* limit = end - amp > 12 ? amp + 12 : end;
+        const char* semi = findChar(amp + 1, limit, ';');
+        if (semi == limit ||
+            !decodeEntity(std::string_view(amp + 1, static_cast<size_t>(semi - amp - 1)), out)) {
+            out += '&';
+            p = amp + 1;
+            continue;
+        }
+        p = semi + 1;
+    }
+}
+
+bool XmlTokenizer::mayCompleteMarkup(std::string_view data, size_t scanned) {
+    // Too short to tell what kind of markup it is, and cheap to retry
+    if (data.size() < 9 || data[0] != '<') {
+        return true;
+    }
+
+    std::string_view terminator = ">";
+    size_t from = 1;
+    if (data.compare(0, 4, "<!--") == 0) {
+        terminator = "-->";
+        from = 4;
+    } else if (data.compare(0, 9, "<![CDATA[") == 0) {
+        terminator = "]]>";
+        from = 9;
+    } else if (data[1] == '?') {
+        terminator = "?>";
+        from = 2;
+    }
+
+    // The terminator may straddle the end of the part already scanned
+    if (scanned >= from + terminator.size() - 1) {
+        from = scanned - (terminator.size() - 1);
+    }
+    return data.find(terminator, from) != std::string_view::npos;
+}
+
+bool XmlTokenizer::readUntil(const char* terminator, size_t length, const char* from,
+                             const char*& found) {
+    const char* p = from;
+    while (p < end_) {
+        p = findChar(p, end_, terminator[0]);
+        if (static_cast<size_t>(end_ - p) < length) {
+            return fail();
+        }
+        if (std::memcmp(p, terminator, length) == 0) {
+            found = p;
+            return true;
+        }
+        ++p;
+    }
+    return fail();
+}
+
+bool XmlTokenizer::readMarkup(Token& token) {
+    token = Token();
+    size_t remaining = static_cast<size_t>(end_ - pos_);
+    const char* found = nullptr;
+
+    if (remaining >= 4 && std::memcmp(pos_, "<!--", 4) == 0) {
+        if (!readUntil("-->", 3, pos_ + 4, found)) {
+            return false;
+        }
+        token.type = TokenType::Comment;
+        token.value = std::string_view(pos_ + 4, static_cast<size_t>(found - pos_ - 4));
+        token.raw = std::string_view(pos_, static_cast<size_t>(found + 3 - pos_));
+        pos_ = found + 3;
+        return true;
+    }
+
+    if (remaining >= 9 && std::memcmp(pos_, "<![CDATA[", 9) == 0) {
+        if (!readUntil("]]>", 3, pos_ + 9, found)) {
+            return false;
+        }
+        token.type = TokenType::CData;
+        token.value = std::string_view(pos_ + 9, static_cast<size_t>(found - pos_ - 9));
+        token.raw = std::string_view(pos_, static_cast<size_t>(found + 3 - pos_));
+        pos_ = found + 3;
+        return true;
+    }
+
+    if (remaining >= 2 && pos_[1] == '?') {
+        if (!readUntil("?>", 2, pos_ + 2, found)) {
+            return false;
+        }
+        const char* nameEnd = scanName(pos_ + 2, found);
+        token.type = TokenType::ProcessingInstruction;
+        token.name = std::string_view(pos_ + 2, static_cast<size_t>(nameEnd - pos_ - 2));
+        const char* body = skipSpace(nameEnd, found);
+        token.value = std::string_view(body, static_cast<size_t>(found - body));
+        token.raw = std::string_view(pos_, static_cast<size_t>(found + 2 - pos_));
+        pos_ = found + 2;
+        return true;
+    }
+
+    if (remaining >= 2 && pos_[1] == '!') {
+        // <!DOCTYPE ...> may carry an internal subset in brackets
+        int brackets = 0;
+        const char* p = pos_ + 2;
+        for (; p < end_; ++p) {
+            if (*p == '[') {
+                ++brackets;
+            } else if (*p == ']') {
+                --brackets;
+            } else if (*p == '>' && brackets <= 0) {
+                break;
+            }
+        }
+        if (p == end_) {
+            return fail();
+        }
+        token.type = TokenType::Doctype;
+        token.value = std::string_view(pos_ + 2, static_cast<size_t>(p - pos_ - 2));
+        token.raw = std::string_view(pos_, static_cast<size_t>(p + 1 - pos_));
+        pos_ = p + 1;
+        return true;
+    }
+
+    if (remaining >= 2 && pos_[1] == '/') {
+        const char* nameEnd = scanName(pos_ + 2, end_);
+        const char* gt = findChar(nameEnd, end_, '>');
+        if (gt == end_ || nameEnd == pos_ + 2) {
+            return fail();
+        }
+        token.type = TokenType::EndElement;
+        token.name = std::string_view(pos_ + 2, static_cast<size_t>(nameEnd - pos_ - 2));
+        token.raw = std::string_view(pos_, static_cast<size_t>(gt + 1 - pos_));
+        if (depth_ > 0) {
+            --depth_;
+        }
+        pos_ = gt + 1;
+        return true;
+    }
+
+    return readStartTag(token);
+}
+
+bool XmlTokenizer::readStartTag(Token& token) {
+    const char* nameBegin = pos_ + 1;
+    const char* nameEnd = scanName(nameBegin, end_);
+    if (nameEnd == nameBegin) {
+        return fail();
+    }
+
+    // Find the end of the tag, jumping over quoted attribute values
+    // since they may legally contain '>'
+    const char* p = nameEnd;
+    for (;;) {
+        p = SimdScan::findAnyOf3(p, end_, '"', '\'', '>');
+        if (p == end_) {
+            return fail();
+        }
+        if (*p == '>') {
+            break;
+        }
+        const char* close = findChar(p + 1, end_, *p);
+        if (close == end_) {
+            return fail();
+        }
+        p = close + 1;
+    }
+
+    selfClosing_ = p - 1 >= nameEnd && p[-1] == '/';
+    if (selfClosing_) {
+        --p;
+    }
+
+    tagEnd_ = p;
+    element_ = std::string_view(nameBegin, static_cast<size_t>(nameEnd - nameBegin));
+
+    token.type = TokenType::StartElement;
+    token.name = element_;
+    token.raw = std::string_view(pos_, static_cast<size_t>(tagEnd_ + (selfClosing_ ? 2 : 1) - pos_));
+    token.selfClosing = selfClosing_;
+
+    if (!selfClosing_) {
+        ++depth_;
+    }
+    state_ = State::Attributes;
+    pos_ = nameEnd;
+    return true;
+}
+
+bool XmlTokenizer::readAttribute(Token& token) {
+    const char* p = skipSpace(pos_, tagEnd_);
+    if (p >= tagEnd_) {
+        return false;
+    }
+
+    const char* nameEnd = scanName(p, tagEnd_);
+    if (nameEnd == p) {
+        return fail();
+    }
+
+    const char* eq = skipSpace(nameEnd, tagEnd_);
+    if (eq >= tagEnd_ || *eq != '=') {
+        return fail();
+    }
+
+    const char* quote = skipSpace(eq + 1, tagEnd_);
+    if (quote >= tagEnd_ || (*quote != '"' && *quote != '\'')) {
+        return fail();
+    }
+
+    const char* close = findChar(quote + 1, tagEnd_, *quote);
+    if (close == tagEnd_) {
+        return fail();
+    }
+
+    token = Token();
+    token.type = TokenType::Attribute;
+    token.name = std::string_view(p, static_cast<size_t>(nameEnd - p));
+    token.value = std::string_view(quote + 1, static_cast<size_t>(close - quote - 1));
+    token.raw = std::string_view(p, static_cast<size_t>(close + 1 - p));
+    pos_ = close + 1;
+    return true;
+}
+
+bool XmlTokenizer::fail() {
+    error_ = true;
+    return false;
+}
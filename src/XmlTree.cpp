@@ -0,0 +1,254 @@
+#include "XmlTree.h"
+#include "SimdScan.h"
+#include "XmlTokenizer.h"
+
+namespace {
+
+constexpr size_t kInitialNameSlots = 256;   // ODF parts use a few hundred names
+constexpr size_t kMaxAttributes = UINT16_MAX;
+
+// FNV-1a; names are short, so a simple byte loop is enough
+uint32_t hashName(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+} // namespace
+
+XmlTree::XmlTree() = default;
+
+bool XmlTree::build(std::string_view xml) {
+    clear();
+
+    // An element takes two '<' and is followed by at most one text node,
+    // so the '<' count sizes the node array for all but odd documents
+    // made mostly of empty elements. Every attribute needs a '='.
+    size_t markup = SimdScan::countByte(xml.data(), xml.data() + xml.size(), '<');
+    if (markup * 2 + 1 >= kNoNode) {
+        lastError_ = "Document too large for a tree";
+        return false;
+    }
+    nodes_.reserve(markup + 1);
+    attributes_.reserve(SimdScan::countByte(xml.data(), xml.data() + xml.size(), '='));
+    nameSlots_.assign(kInitialNameSlots, kNoName);
+
+    XmlTokenizer tokenizer(xml);
+    XmlTokenizer::Token token;
+    std::vector<NodeId> open;           // Elements whose end tag is pending
+    std::vector<NodeId> lastChild;      // Last child so far of each open element
+    bool haveRoot = false;
+
+    auto fail = [this](const std::string& message) {
+        clear();
+        lastError_ = message;
+        return false;
+    };
+
+    auto append = [&](NodeType type) {
+        NodeId id = static_cast<NodeId>(nodes_.size());
+        Node node;
+        node.parent = open.empty() ? kNoNode : open.back();
+        node.nextSibling = kNoNode;
+        node.end = id + 1;
+        node.name = kNoName;
+        node.firstAttribute = static_cast<uint32_t>(attributes_.size());
+        node.attributeCount = 0;
+        node.type = type;
+        nodes_.push_back(node);
+
+        if (!lastChild.empty()) {
+            if (lastChild.back() != kNoNode) {
+                nodes_[lastChild.back()].nextSibling = id;
+            }
+            lastChild.back() = id;
+        }
+        return id;
+    };
+
+    while (tokenizer.next(token)) {
+        switch (token.type) {
+            case XmlTokenizer::TokenType::StartElement: {
+                if (open.empty()) {
+                    if (haveRoot) {
+                        return fail("More than one root element");
+                    }
+                    haveRoot = true;
+                }
+                NodeId id = append(NodeType::Element);
+                nodes_[id].name = intern(token.name);
+                open.push_back(id);
+                lastChild.push_back(kNoNode);
+                break;
+            }
+
+            case XmlTokenizer::TokenType::Attribute: {
+                Node& element = nodes_[open.back()];
+                if (element.attributeCount == kMaxAttributes) {
+                    return fail("Too many attributes on " + std::string(names_[element.name]));
+                }
+                attributes_.push_back({ intern(token.name), token.value });
+                ++element.attributeCount;
+                break;
+            }
+
+            case XmlTokenizer::TokenType::EndElement: {
+                if (open.empty()) {
+                    return fail("Unexpected end tag " + std::string(token.name));
+                }
+                Node& element = nodes_[open.back()];
+                if (!token.selfClosing && names_[element.name] != token.name) {
+                    return fail("Mismatched end tag " + std::string(token.name) + " near byte " +
+                                std::to_string(tokenizer.offset()));
+                }
+                element.end = static_cast<NodeId>(nodes_.size());
+                open.pop_back();
+                lastChild.pop_back();
+                break;
+            }
+
+            case XmlTokenizer::TokenType::Text:
+            case XmlTokenizer::TokenType::CData:
+                // Whitespace around the root element is not part of the tree
+                if (!open.empty()) {
+                    bool cdata = token.type == XmlTokenizer::TokenType::CData;
+                    NodeId id = append(cdata ? NodeType::CData : NodeType::Text);
+                    nodes_[id].text = token.value;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    if (tokenizer.hasError() || !open.empty()) {
+        return fail("Malformed XML near byte " + std::to_string(tokenizer.offset()));
+    }
+    if (!haveRoot) {
+        return fail("No root element");
+    }
+    return true;
+}
+
+void XmlTree::clear() {
+    // swap() with a temporary actually returns the memory, unlike clear()
+    std::vector<Node>().swap(nodes_);
+    std::vector<Attribute>().swap(attributes_);
+    std::vector<std::string_view>().swap(names_);
+    std::vector<NameId>().swap(nameSlots_);
+}
+
+bool XmlTree::empty() const {
+    return nodes_.empty();
+}
+
+size_t XmlTree::size() const {
+    return nodes_.size();
+}
+
+XmlTree::NodeId XmlTree::root() const {
+    return nodes_.empty() ? kNoNode : 0;
+}
+
+const XmlTree::Node& XmlTree::node(NodeId id) const {
+    return nodes_[id];
+}
+
+XmlTree::NodeId XmlTree::firstChild(NodeId id) const {
+    // Children follow their parent directly in document order
+    return nodes_[id].end > id + 1 ? id + 1 : kNoNode;
+}
+
+XmlTree::NameId XmlTree::nameId(std::string_view qname) const {
+    if (nameSlots_.empty()) {
+        return kNoName;
+    }
+    return nameSlots_[findSlot(qname)];
+}
+
+std::string_view XmlTree::name(NameId id) const {
+    return id < names_.size() ? names_[id] : std::string_view();
+}
+
+const XmlTree::Attribute* XmlTree::attributes(NodeId id) const {
+    return attributes_.data() + nodes_[id].firstAttribute;
+}
+
+std::string_view XmlTree::attribute(NodeId id, NameId attribute) const {
+    const Node& element = nodes_[id];
+    const Attribute* first = attributes_.data() + element.firstAttribute;
+    for (const Attribute* a = first; a != first + element.attributeCount; ++a) {
+        if (a->name == attribute) {
+            return a->value;
+        }
+    }
+    return std::string_view();
+}
+
+XmlTree::NodeId XmlTree::find(NodeId from, NameId name, NodeId end) const {
+    if (name == kNoName) {
+        return kNoNode;
+    }
+    NodeId last = end < nodes_.size() ? end : static_cast<NodeId>(nodes_.size());
+    for (NodeId id = from; id < last; ++id) {
+        if (nodes_[id].name == name) {
+            return id;
+        }
+    }
+    return kNoNode;
+}
+
+void XmlTree::appendText(NodeId id, std::string& out) const {
+    for (NodeId i = id; i < nodes_[id].end; ++i) {
+        const Node& n = nodes_[i];
+        if (n.type == NodeType::Text) {
+            XmlTokenizer::decodeEntities(n.text, out);
+        } else if (n.type == NodeType::CData) {
+            out.append(n.text.data(), n.text.size());
+        }
+    }
+}
+
+size_t XmlTree::memoryUsage() const {
+    return nodes_.capacity() * sizeof(Node) + attributes_.capacity() * sizeof(Attribute) +
+           names_.capacity() * sizeof(std::string_view) + nameSlots_.capacity() * sizeof(NameId);
+}
+
+std::string XmlTree::getLastError() const {
+    return lastError_;
+}
+
+size_t XmlTree::findSlot(std::string_view qname) const {
+    // Linear probing; the table is kept at most half full
+    size_t mask = nameSlots_.size() - 1;
+    size_t slot = hashName(qname) & mask;
+    while (nameSlots_[slot] != kNoName && names_[nameSlots_[slot]] != qname) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+XmlTree::NameId XmlTree::intern(std::string_view qname) {
+    size_t slot = findSlot(qname);
+    if (nameSlots_[slot] != kNoName) {
+        return nameSlots_[slot];
+    }
+
+    NameId id = static_cast<NameId>(names_.size());
+    names_.push_back(qname);
+    nameSlots_[slot] = id;
+    if (names_.size() * 2 > nameSlots_.size()) {
+        growNameSlots();
+    }
+    return id;
+}
+
+void XmlTree::growNameSlots() {
+    nameSlots_.assign(nameSlots_.size() * 2, kNoName);
+    for (NameId id = 0; id < names_.size(); ++id) {
+        nameSlots_[findSlot(names_[id])] = id;
+    }
+}
@@ -0,0 +1,130 @@
+#include "XxHash64.h"
+#include <cstring>
+
+namespace {
+
+constexpr uint64_t kPrime1 = 11400714785074694791ull;
+constexpr uint64_t kPrime2 = 14029467366897019727ull;
+constexpr uint64_t kPrime3 = 1609587929392839161ull;
+constexpr uint64_t kPrime4 = 9650029242287828579ull;
+constexpr uint64_t kPrime5 = 2870177450012600261ull;
+
+constexpr size_t kStripe = 32;
+
+uint64_t rotl(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// Little-endian loads, like the archive fields ZipReader reads
+uint64_t read64(const unsigned char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t read32(const unsigned char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint64_t round(uint64_t lane, uint64_t input) {
+    lane += input * kPrime2;
+    lane = rotl(lane, 31);
+    return lane * kPrime1;
+}
+
+uint64_t mergeRound(uint64_t hash, uint64_t lane) {
+    hash ^= round(0, lane);
+    return hash * kPrime1 + kPrime4;
+}
+
+void consumeStripe(uint64_t* lanes, const unsigned char* p) {
+    lanes[0] = round(lanes[0], read64(p));
+    lanes[1] = round(lanes[1], read64(p + 8));
+    lanes[2] = round(lanes[2], read64(p + 16));
+    lanes[3] = round(lanes[3], read64(p + 24));
+}
+
+} // namespace
+
+XxHash64::XxHash64(uint64_t seed)
+    : seed_(seed)
+    , total_(0)
+    , buffered_(0) {
+    lanes_[0] = seed + kPrime1 + kPrime2;
+    lanes_[1] = seed + kPrime2;
+    lanes_[2] = seed;
+    lanes_[3] = seed - kPrime1;
+}
+
+void XxHash64::update(const void* data, size_t size) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    total_ += size;
+
+    // Complete a stripe left over from the previous piece
+    if (buffered_ > 0) {
+        size_t take = kStripe - buffered_ < size ? kStripe - buffered_ : size;
+        std::memcpy(buffer_ + buffered_, p, take);
+        buffered_ += take;
+        p += take;
+        if (buffered_ < kStripe) {
+            return;
+        }
+        consumeStripe(lanes_, buffer_);
+        buffered_ = 0;
+    }
+
+    while (end - p >= static_cast<ptrdiff_t>(kStripe)) {
+        consumeStripe(lanes_, p);
+        p += kStripe;
+    }
+
+    buffered_ = static_cast<size_t>(end - p);
+    std::memcpy(buffer_, p, buffered_);
+}
+
+uint64_t XxHash64::digest() const {
+    uint64_t hash;
+    if (total_ >= kStripe) {
+        hash = rotl(lanes_[0], 1) + rotl(lanes_[1], 7) + rotl(lanes_[2], 12) + rotl(lanes_[3], 18);
+        for (uint64_t lane : lanes_) {
+            hash = mergeRound(hash, lane);
+        }
+    } else {
+        hash = seed_ + kPrime5;
+    }
+    hash += total_;
+
+    const unsigned char* p = buffer_;
+    const unsigned char* end = buffer_ + buffered_;
+    while (end - p >= 8) {
+        hash ^= round(0, read64(p));
+        hash = rotl(hash, 27) * kPrime1 + kPrime4;
+        p += 8;
+    }
+    if (end - p >= 4) {
+        hash ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+        hash = rotl(hash, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    while (p < end) {
+        hash ^= *p * kPrime5;
+        hash = rotl(hash, 11) * kPrime1;
+        ++p;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t XxHash64::hash(const void* data, size_t size, uint64_t seed) {
+    XxHash64 state(seed);
+    state.update(data, size);
+    return state.digest();
+}
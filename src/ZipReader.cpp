@@ -1,16 +1,132 @@
 #include "ZipReader.h"
+#include "Crc32.h"
+#include "SimdScan.h"
+#include <cstdio>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 #include <cstring>
 #include <zlib.h>
 
 // For minizip
 #include <minizip/unzip.h>
 
-ZipReader::ZipReader(const std::string& zipPath)
+namespace {
+
+// ZIP record signatures and fixed header sizes (APPNOTE 4.3)
+constexpr uint32_t kLocalHeaderSignature = 0x04034b50;
+constexpr uint32_t kCentralHeaderSignature = 0x02014b50;
+constexpr uint32_t kEndOfCentralDirSignature = 0x06054b50;
+constexpr uint32_t kZip64EndSignature = 0x06064b50;
+constexpr uint32_t kZip64LocatorSignature = 0x07064b50;
+constexpr uint32_t kDataDescriptorSignature = 0x08074b50;
+constexpr size_t kLocalHeaderSize = 30;
+constexpr size_t kCentralHeaderSize = 46;
+constexpr size_t kEndOfCentralDirSize = 22;
+constexpr size_t kZip64EndSize = 56;
+constexpr size_t kZip64LocatorSize = 20;
+constexpr size_t kMaxCommentSize = 0xFFFF;
+
+// Central directory fields set to this defer to the Zip64 extra field
+constexpr uint32_t kZip64Marker = 0xFFFFFFFF;
+constexpr uint16_t kZip64ExtraId = 0x0001;
+
+// General purpose flag: CRC and sizes are in a data descriptor after the data
+constexpr uint16_t kFlagDataDescriptor = 0x0008;
+
+constexpr uint16_t kMethodStored = 0;
+constexpr uint16_t kMethodDeflated = 8;
+
+// Largest single read handed to unzReadCurrentFile, which returns an int
+constexpr size_t kMaxReadRequest = 1u << 30;
+
+// Deflate can't expand data by more than about 1032:1, so a larger
+// declared size is forged or corrupt
+constexpr uint64_t kMaxDeflateRatio = 1032;
+
+// First buffer for minizip reads; it doubles as data arrives
+constexpr size_t kInitialReadBuffer = 1u << 20;
+
+uint16_t readLE16(const char* p) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+uint32_t readLE32(const char* p) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(p);
+    return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) |
+           (static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+uint64_t readLE64(const char* p) {
+    return static_cast<uint64_t>(readLE32(p)) | (static_cast<uint64_t>(readLE32(p + 4)) << 32);
+}
+
+/**
+ * Find an extra field block by id; returns its data if it is at least
+ * minSize bytes long, nullptr otherwise.
+ */
+const char* findExtraField(const char* extra, size_t length, uint16_t id, size_t minSize) {
+    size_t pos = 0;
+    while (pos + 4 <= length) {
+        uint16_t fieldId = readLE16(extra + pos);
+        uint16_t size = readLE16(extra + pos + 2);
+        if (pos + 4 + size > length) {
+            return nullptr;
+        }
+        if (fieldId == id) {
+            return size >= minSize ? extra + pos + 4 : nullptr;
+        }
+        pos += 4 + size;
+    }
+    return nullptr;
+}
+
+/**
+ * Replace the 32-bit fields of a central directory record that hold
+ * kZip64Marker with their values from the Zip64 extra field. The extra
+ * field lists only the replaced fields, in this fixed order.
+ */
+bool applyZip64Extra(const char* extra, size_t length, ZipEntry& entry) {
+    size_t pos = 0;
+    while (pos + 4 <= length) {
+        uint16_t id = readLE16(extra + pos);
+        uint16_t size = readLE16(extra + pos + 2);
+        if (pos + 4 + size > length) {
+            return false;
+        }
+        if (id != kZip64ExtraId) {
+            pos += 4 + size;
+            continue;
+        }
+
+        const char* field = extra + pos + 4;
+        const char* end = field + size;
+        for (uint64_t* value : { &entry.uncompressedSize, &entry.compressedSize, &entry.localHeaderOffset }) {
+            if (*value != kZip64Marker) {
+                continue;
+            }
+            if (end - field < 8) {
+                return false;
+            }
+            *value = readLE64(field);
+            field += 8;
+        }
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+ZipReader::ZipReader(const std::string& zipPath, Backend backend)
     : zipPath_(zipPath)
+    , backend_(backend)
     , zipHandle_(nullptr)
-    , isOpen_(false) {
+    , isOpen_(false)
+    , privateCopy_(false)
+    , stats_(nullptr)
+    , inflateBackend_(Inflater::getDefault()) {
 }
 
 ZipReader::~ZipReader() {
@@ -22,9 +138,32 @@ bool ZipReader::open() {
         return true;
     }
 
-    zipHandle_ = unzOpen(zipPath_.c_str());
+    InspectStats::Timer timer(stats_, InspectStats::Phase::Open);
+
+    if (backend_ == Backend::Mapped) {
+        if (!(privateCopy_ ? mapping_.openCopy(zipPath_) : mapping_.open(zipPath_))) {
+            setError("Failed to open ZIP file: " + zipPath_);
+            return false;
+        }
+
+        if (!buildMappedIndex()) {
+            mapping_.close();
+            return false;
+        }
+
+        isOpen_ = true;
+        return true;
+    }
+
+    zipHandle_ = unzOpen64(zipPath_.c_str());
     if (zipHandle_ == nullptr) {
-        lastError_ = "Failed to open ZIP file: " + zipPath_;
+        setError("Failed to open ZIP file: " + zipPath_);
+        return false;
+    }
+
+    if (!buildIndex()) {
+        unzClose(static_cast<unzFile>(zipHandle_));
+        zipHandle_ = nullptr;
         return false;
     }
 
@@ -36,8 +175,186 @@ void ZipReader::close() {
     if (zipHandle_ != nullptr) {
         unzClose(static_cast<unzFile>(zipHandle_));
         zipHandle_ = nullptr;
-        isOpen_ = false;
     }
+    mapping_.close();
+    isOpen_ = false;
+    entries_.clear();
+    entryIndex_.clear();
+}
+
+bool ZipReader::buildIndex() {
+    // Walk the central directory once; every later lookup goes through the
+    // hash index and jumps straight to the record with unzGoToFilePos.
+    InspectStats::Timer timer(stats_, InspectStats::Phase::Directory);
+    unzFile uf = static_cast<unzFile>(zipHandle_);
+    entries_.clear();
+    entryIndex_.clear();
+
+    int status = unzGoToFirstFile(uf);
+    if (status == UNZ_END_OF_LIST_OF_FILE) {
+        return true;
+    }
+
+    // Names can be up to 64 KiB; the buffer grows when one doesn't fit
+    std::vector<char> filename(256);
+
+    while (status == UNZ_OK) {
+        unz_file_info64 fileInfo;
+        unz64_file_pos filePos;
+
+        bool ok = unzGetCurrentFileInfo64(uf, &fileInfo, filename.data(), static_cast<uLong>(filename.size()),
+                                          nullptr, 0, nullptr, 0) == UNZ_OK;
+        if (ok && fileInfo.size_filename > filename.size()) {
+            filename.resize(fileInfo.size_filename);
+            ok = unzGetCurrentFileInfo64(uf, &fileInfo, filename.data(), static_cast<uLong>(filename.size()),
+                                         nullptr, 0, nullptr, 0) == UNZ_OK;
+        }
+        if (!ok || unzGetFilePos64(uf, &filePos) != UNZ_OK) {
+            setError("Failed to read central directory: " + zipPath_);
+            return false;
+        }
+
+        ZipEntry entry;
+        entry.name.assign(filename.data(), fileInfo.size_filename);
+        entry.compressedSize = fileInfo.compressed_size;
+        entry.uncompressedSize = fileInfo.uncompressed_size;
+        entry.crc32 = fileInfo.crc;
+        entry.method = static_cast<uint16_t>(fileInfo.compression_method);
+        entry.dirOffset = filePos.pos_in_zip_directory;
+        entry.fileIndex = filePos.num_of_file;
+
+        // Keep the first record for duplicate names, as unzLocateFile would
+        entryIndex_.emplace(entry.name, entries_.size());
+        entries_.push_back(std::move(entry));
+
+        status = unzGoToNextFile(uf);
+    }
+
+    if (status != UNZ_END_OF_LIST_OF_FILE) {
+        setError("Failed to read central directory: " + zipPath_);
+        return false;
+    }
+
+    if (stats_ != nullptr) {
+        stats_->add(InspectStats::Counter::Entries, entries_.size());
+    }
+    return true;
+}
+
+bool ZipReader::buildMappedIndex() {
+    InspectStats::Timer timer(stats_, InspectStats::Phase::Directory);
+    entries_.clear();
+    entryIndex_.clear();
+
+    const char* base = mapping_.data();
+    size_t size = mapping_.size();
+
+    if (size < kEndOfCentralDirSize) {
+        setError("Not a ZIP archive: " + zipPath_);
+        return false;
+    }
+
+    // The end of central directory record sits in the last 22 bytes plus an
+    // optional archive comment. Almost no archive has a comment, so check
+    // the end first; otherwise take the last signature in the window.
+    size_t eocd = size - kEndOfCentralDirSize;
+    if (readLE32(base + eocd) != kEndOfCentralDirSignature) {
+        size_t minPos = size > kEndOfCentralDirSize + kMaxCommentSize
+            ? size - kEndOfCentralDirSize - kMaxCommentSize : 0;
+        const char* last = base + eocd;     // Last possible record start
+        const char* found = nullptr;
+        for (const char* p = base + minPos; (p = SimdScan::findByte(p, last, 'P')) != last; ++p) {
+            if (readLE32(p) == kEndOfCentralDirSignature) {
+                found = p;
+            }
+        }
+        if (found == nullptr) {
+            setError("Not a ZIP archive: " + zipPath_);
+            return false;
+        }
+        eocd = static_cast<size_t>(found - base);
+    }
+
+    uint64_t entryCount = readLE16(base + eocd + 10);
+    uint64_t dirSize = readLE32(base + eocd + 12);
+    uint64_t dirOffset = readLE32(base + eocd + 16);
+    size_t dirLimit = eocd;
+
+    // Zip64 archives keep the real counts and offsets in a Zip64 end
+    // record, found through the locator right before the classic one
+    if (eocd >= kZip64LocatorSize &&
+        readLE32(base + eocd - kZip64LocatorSize) == kZip64LocatorSignature) {
+        uint64_t recordOffset = readLE64(base + eocd - kZip64LocatorSize + 8);
+        dirLimit = eocd - kZip64LocatorSize;
+        if (dirLimit < kZip64EndSize || recordOffset > dirLimit - kZip64EndSize ||
+            readLE32(base + recordOffset) != kZip64EndSignature) {
+            setError("Corrupt Zip64 end of central directory: " + zipPath_);
+            return false;
+        }
+        const char* record = base + recordOffset;
+        entryCount = readLE64(record + 32);
+        dirSize = readLE64(record + 40);
+        dirOffset = readLE64(record + 48);
+        dirLimit = static_cast<size_t>(recordOffset);
+    }
+
+    if (dirOffset > dirLimit || dirSize > dirLimit - dirOffset) {
+        setError("Corrupt central directory: " + zipPath_);
+        return false;
+    }
+
+    // The count is untrusted; no record is shorter than its fixed header
+    entries_.reserve(static_cast<size_t>(std::min<uint64_t>(entryCount, dirSize / kCentralHeaderSize)));
+    size_t pos = static_cast<size_t>(dirOffset);
+    size_t dirEnd = static_cast<size_t>(dirOffset + dirSize);
+
+    for (uint64_t i = 0; i < entryCount; ++i) {
+        if (pos + kCentralHeaderSize > dirEnd ||
+            readLE32(base + pos) != kCentralHeaderSignature) {
+            setError("Corrupt central directory: " + zipPath_);
+            return false;
+        }
+
+        const char* record = base + pos;
+        uint16_t nameLength = readLE16(record + 28);
+        uint16_t extraLength = readLE16(record + 30);
+        uint16_t commentLength = readLE16(record + 32);
+        size_t recordSize = kCentralHeaderSize + nameLength + extraLength + commentLength;
+
+        if (pos + recordSize > dirEnd) {
+            setError("Corrupt central directory: " + zipPath_);
+            return false;
+        }
+
+        ZipEntry entry;
+        entry.name.assign(record + kCentralHeaderSize, nameLength);
+        entry.method = readLE16(record + 10);
+        entry.crc32 = readLE32(record + 16);
+        entry.compressedSize = readLE32(record + 20);
+        entry.uncompressedSize = readLE32(record + 24);
+        entry.localHeaderOffset = readLE32(record + 42);
+        entry.dirOffset = pos - dirOffset;
+        entry.fileIndex = i;
+
+        bool needsZip64 = entry.compressedSize == kZip64Marker ||
+                          entry.uncompressedSize == kZip64Marker ||
+                          entry.localHeaderOffset == kZip64Marker;
+        if (needsZip64 &&
+            !applyZip64Extra(record + kCentralHeaderSize + nameLength, extraLength, entry)) {
+            setError("Corrupt Zip64 extra field: " + entry.name);
+            return false;
+        }
+
+        entryIndex_.emplace(entry.name, entries_.size());
+        entries_.push_back(std::move(entry));
+
+        pos += recordSize;
+    }
+
+    if (stats_ != nullptr) {
+        stats_->add(InspectStats::Counter::Entries, entries_.size());
+    }
+    return true;
 }
 
 bool ZipReader::isOpen() const {
@@ -46,94 +363,655 @@ bool ZipReader::isOpen() const {
 
 std::vector<std::string> ZipReader::listFiles() const {
     std::vector<std::string> files;
-    
+    files.reserve(entries_.size());
+
+    for (const auto& entry : entries_) {
+        files.push_back(entry.name);
+    }
+
+    return files;
+}
+
+std::string ZipReader::extractFile(const std::string& filename) const {
+    std::string content;
+    if (!extractFileTo(filename, content)) {
+        return "";
+    }
+    return content;
+}
+
+bool ZipReader::extractFileTo(const std::string& filename, std::string& out) const {
+    out.clear();
+
     if (!isOpen_) {
-        return files;
+        setError("ZIP file is not open");
+        return false;
+    }
+
+    const ZipEntry* entry = findEntry(filename);
+    if (entry == nullptr) {
+        setError("File not found in archive: " + filename);
+        return false;
+    }
+
+    if (entry->uncompressedSize > out.max_size()) {
+        setError("File too large to extract into memory: " + filename);
+        return false;
+    }
+
+    // The sizes come from the archive; check that the compressed data could
+    // produce the declared size before allocating for it
+    if (entry->method == kMethodStored ? entry->uncompressedSize != entry->compressedSize
+                                       : entry->uncompressedSize / kMaxDeflateRatio > entry->compressedSize) {
+        setError("Declared size doesn't match the compressed data: " + filename);
+        return false;
+    }
+
+    // Mapped data is bounds-checked against the archive before allocating
+    const char* data = nullptr;
+    if (backend_ == Backend::Mapped && !locateMappedData(*entry, data)) {
+        return false;
+    }
+
+    if (stats_ != nullptr) {
+        if (out.capacity() < entry->uncompressedSize) {
+            countBuffer(entry->uncompressedSize);
+        }
+        stats_->add(entry->method == kMethodStored ? InspectStats::Counter::BytesCopied
+                                                   : InspectStats::Counter::BytesInflated,
+                    entry->uncompressedSize);
+    }
+    InspectStats::Timer timer(stats_, InspectStats::Phase::Inflate);
+
+    if (backend_ == Backend::Mapped) {
+        out.resize(static_cast<size_t>(entry->uncompressedSize));
+        if (!readMappedEntry(*entry, data, &out[0])) {
+            out.clear();
+            return false;
+        }
+        return true;
+    }
+
+    // minizip keeps a single cursor per handle
+    std::lock_guard<std::mutex> cursorLock(cursorMutex_);
+
+    if (!openMinizipEntry(*entry)) {
+        out.clear();
+        return false;
     }
 
+    // unzReadCurrentFile returns an int, so read large entries in pieces.
+    // The compressed size isn't checked against the file here, so the
+    // buffer grows with the data rather than to the declared size at once.
     unzFile uf = static_cast<unzFile>(zipHandle_);
-    
-    if (unzGoToFirstFile(uf) != UNZ_OK) {
-        return files;
+    size_t expected = static_cast<size_t>(entry->uncompressedSize);
+    size_t total = 0;
+    out.resize(std::min(expected, kInitialReadBuffer));
+    while (total < expected) {
+        if (total == out.size()) {
+            out.resize(std::min(expected, out.size() * 2));
+        }
+        unsigned request = static_cast<unsigned>(std::min<size_t>(out.size() - total, kMaxReadRequest));
+        int bytesRead = unzReadCurrentFile(uf, &out[total], request);
+        if (bytesRead <= 0) {
+            break;
+        }
+        total += static_cast<size_t>(bytesRead);
+    }
+    unzCloseCurrentFile(uf);
+
+    if (total != expected) {
+        setError("Failed to read file: " + filename);
+        out.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool ZipReader::extractRange(const std::string& filename, uint64_t offset, size_t length,
+                             std::string& out) const {
+    out.clear();
+
+    if (!isOpen_) {
+        setError("ZIP file is not open");
+        return false;
     }
 
-    do {
-        char filename[256];
-        unz_file_info fileInfo;
-        
-        if (unzGetCurrentFileInfo(uf, &fileInfo, filename, sizeof(filename),
-                                   nullptr, 0, nullptr, 0) == UNZ_OK) {
-            files.push_back(filename);
+    const ZipEntry* entry = findEntry(filename);
+    if (entry == nullptr) {
+        setError("File not found in archive: " + filename);
+        return false;
+    }
+    if (offset > entry->uncompressedSize) {
+        setError("Range starts past the end of the file: " + filename);
+        return false;
+    }
+
+    uint64_t end = offset + std::min<uint64_t>(length, entry->uncompressedSize - offset);
+    size_t wanted = static_cast<size_t>(end - offset);
+    if (wanted == 0) {
+        return true;
+    }
+    if (out.capacity() < wanted) {
+        countBuffer(wanted);
+    }
+    out.reserve(wanted);
+
+    // Stored entries in a mapping can be cut out directly
+    if (backend_ == Backend::Mapped && entry->method == kMethodStored) {
+        // The range was clamped to uncompressedSize, but only
+        // compressedSize is bounds-checked against the mapping
+        if (entry->compressedSize != entry->uncompressedSize) {
+            setError("Stored entry size mismatch: " + filename);
+            return false;
         }
-    } while (unzGoToNextFile(uf) == UNZ_OK);
 
-    return files;
+        const char* data = nullptr;
+        if (!locateMappedData(*entry, data)) {
+            return false;
+        }
+        if (stats_ != nullptr) {
+            stats_->add(InspectStats::Counter::BytesCopied, wanted);
+        }
+        out.assign(data + offset, wanted);
+        return true;
+    }
+
+    // Everything before the range has to be inflated too, but nothing
+    // after it: chunks are no larger than the range end, and the stream
+    // stops as soon as the last byte of the range has been produced
+    uint64_t position = 0;
+    bool ok = streamFile(filename, [&](const char* data, size_t size) {
+        uint64_t chunkEnd = position + size;
+        if (chunkEnd > offset) {
+            uint64_t first = std::max(position, offset);
+            out.append(data + (first - position), static_cast<size_t>(std::min(chunkEnd, end) - first));
+        }
+        position = chunkEnd;
+        return position < end;
+    }, static_cast<size_t>(std::min<uint64_t>(end, kDefaultChunkSize)));
+
+    if (!ok) {
+        out.clear();
+    }
+    return ok;
 }
 
-std::string ZipReader::extractFile(const std::string& filename) const {
+bool ZipReader::extractPrefix(const std::string& filename, size_t maxBytes, std::string& out) const {
+    return extractRange(filename, 0, maxBytes, out);
+}
+
+bool ZipReader::streamFile(const std::string& filename, const ChunkCallback& onChunk,
+                           size_t chunkSize) const {
     if (!isOpen_) {
-        lastError_ = "ZIP file is not open";
-        return "";
+        setError("ZIP file is not open");
+        return false;
+    }
+
+    const ZipEntry* entry = findEntry(filename);
+    if (entry == nullptr) {
+        setError("File not found in archive: " + filename);
+        return false;
+    }
+
+    chunkSize = std::max<size_t>(1, std::min(chunkSize, kMaxReadRequest));
+    if (stats_ == nullptr) {
+        return backend_ == Backend::Mapped ? streamMappedEntry(*entry, onChunk, chunkSize)
+                                           : streamMinizipEntry(*entry, onChunk, chunkSize);
+    }
+
+    // Count what was delivered; readers may stop well before the end
+    uint64_t delivered = 0;
+    ChunkCallback counted = [&delivered, &onChunk](const char* data, size_t size) {
+        delivered += size;
+        return onChunk(data, size);
+    };
+    bool ok = backend_ == Backend::Mapped ? streamMappedEntry(*entry, counted, chunkSize)
+                                          : streamMinizipEntry(*entry, counted, chunkSize);
+    stats_->add(entry->method == kMethodStored ? InspectStats::Counter::BytesCopied
+                                               : InspectStats::Counter::BytesInflated,
+                delivered);
+    return ok;
+}
+
+bool ZipReader::streamMinizipEntry(const ZipEntry& entry, const ChunkCallback& onChunk,
+                                   size_t chunkSize) const {
+    std::lock_guard<std::mutex> cursorLock(cursorMutex_);
+
+    if (!openMinizipEntry(entry)) {
+        return false;
     }
 
     unzFile uf = static_cast<unzFile>(zipHandle_);
-    
-    if (unzLocateFile(uf, filename.c_str(), 0) != UNZ_OK) {
-        lastError_ = "File not found in archive: " + filename;
-        return "";
+    std::vector<char> buffer(chunkSize);
+    countBuffer(chunkSize);
+    uint64_t total = 0;
+    bool stopped = false;
+
+    for (;;) {
+        int bytesRead;
+        {
+            // Time the reads only, not the consumer
+            InspectStats::Timer timer(stats_, InspectStats::Phase::Inflate);
+            bytesRead = unzReadCurrentFile(uf, buffer.data(), static_cast<unsigned>(buffer.size()));
+        }
+        if (bytesRead < 0) {
+            unzCloseCurrentFile(uf);
+            setError("Failed to read file: " + entry.name);
+            return false;
+        }
+        if (bytesRead == 0) {
+            break;
+        }
+        total += static_cast<size_t>(bytesRead);
+        if (!onChunk(buffer.data(), static_cast<size_t>(bytesRead))) {
+            stopped = true;
+            break;
+        }
     }
+    unzCloseCurrentFile(uf);
 
-    unz_file_info fileInfo;
-    if (unzGetCurrentFileInfo(uf, &fileInfo, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK) {
-        lastError_ = "Failed to get file info: " + filename;
-        return "";
+    if (!stopped && total != entry.uncompressedSize) {
+        setError("Failed to read file: " + entry.name);
+        return false;
+    }
+
+    return true;
+}
+
+bool ZipReader::openMinizipEntry(const ZipEntry& entry) const {
+    InspectStats::Timer timer(stats_, InspectStats::Phase::Locate);
+    if (stats_ != nullptr) {
+        stats_->add(InspectStats::Counter::Seeks);
+    }
+    unzFile uf = static_cast<unzFile>(zipHandle_);
+
+    unz64_file_pos filePos;
+    filePos.pos_in_zip_directory = entry.dirOffset;
+    filePos.num_of_file = entry.fileIndex;
+    if (unzGoToFilePos64(uf, &filePos) != UNZ_OK) {
+        setError("Failed to get file info: " + entry.name);
+        return false;
     }
 
     if (unzOpenCurrentFile(uf) != UNZ_OK) {
-        lastError_ = "Failed to open file: " + filename;
-        return "";
+        setError("Failed to open file: " + entry.name);
+        return false;
     }
 
-    std::vector<char> buffer(fileInfo.uncompressed_size);
-    int bytesRead = unzReadCurrentFile(uf, buffer.data(), buffer.size());
-    unzCloseCurrentFile(uf);
+    return true;
+}
 
-    if (bytesRead < 0) {
-        lastError_ = "Failed to read file: " + filename;
-        return "";
+bool ZipReader::viewFile(const std::string& filename, std::string_view& view) const {
+    if (!isOpen_ || backend_ != Backend::Mapped) {
+        setError("Zero-copy views need an open mapped archive");
+        return false;
+    }
+
+    const ZipEntry* entry = findEntry(filename);
+    if (entry == nullptr) {
+        setError("File not found in archive: " + filename);
+        return false;
+    }
+
+    if (entry->method != kMethodStored) {
+        setError("Entry is compressed, cannot view in place: " + filename);
+        return false;
+    }
+
+    // Only compressedSize is bounds-checked against the mapping
+    if (entry->compressedSize != entry->uncompressedSize) {
+        setError("Stored entry size mismatch: " + filename);
+        return false;
+    }
+
+    const char* data = nullptr;
+    if (!locateMappedData(*entry, data)) {
+        return false;
     }
 
-    return std::string(buffer.begin(), buffer.end());
+    view = std::string_view(data, static_cast<size_t>(entry->uncompressedSize));
+    return true;
 }
 
-bool ZipReader::fileExists(const std::string& filename) const {
-    if (!isOpen_) {
+bool ZipReader::locateMappedData(const ZipEntry& entry, const char*& data) const {
+    InspectStats::Timer timer(stats_, InspectStats::Phase::Locate);
+    if (stats_ != nullptr) {
+        stats_->add(InspectStats::Counter::Seeks);
+    }
+    const char* base = mapping_.data();
+    uint64_t size = mapping_.size();
+    uint64_t header = entry.localHeaderOffset;
+
+    if (header > size || size - header < kLocalHeaderSize ||
+        readLE32(base + header) != kLocalHeaderSignature) {
+        setError("Corrupt local header: " + entry.name);
         return false;
     }
 
-    unzFile uf = static_cast<unzFile>(zipHandle_);
-    return unzLocateFile(uf, filename.c_str(), 0) == UNZ_OK;
+    // The local extra field may differ from the central one, so the data
+    // offset has to come from the local header itself.
+    uint64_t dataOffset = header + kLocalHeaderSize +
+                          readLE16(base + header + 26) + readLE16(base + header + 28);
+    if (dataOffset > size || entry.compressedSize > size - dataOffset) {
+        setError("Entry data out of bounds: " + entry.name);
+        return false;
+    }
+
+    data = base + dataOffset;
+    return true;
 }
 
-size_t ZipReader::getFileSize(const std::string& filename) const {
-    if (!isOpen_) {
-        return 0;
+bool ZipReader::readMappedEntry(const ZipEntry& entry, const char* data, char* dest) const {
+    if (entry.method == kMethodStored) {
+        if (entry.compressedSize != entry.uncompressedSize) {
+            setError("Stored entry size mismatch: " + entry.name);
+            return false;
+        }
+        std::memcpy(dest, data, static_cast<size_t>(entry.uncompressedSize));
+        return true;
     }
 
-    unzFile uf = static_cast<unzFile>(zipHandle_);
-    
-    if (unzLocateFile(uf, filename.c_str(), 0) != UNZ_OK) {
-        return 0;
+    if (entry.method != kMethodDeflated) {
+        setError("Unsupported compression method: " + entry.name);
+        return false;
     }
 
-    unz_file_info fileInfo;
-    if (unzGetCurrentFileInfo(uf, &fileInfo, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK) {
-        return 0;
+    // Inflate the raw deflate stream straight from the mapping into dest
+    Inflater& inflater = Inflater::forThread(inflateBackend_);
+    if (!inflater.inflate(data, static_cast<size_t>(entry.compressedSize), dest,
+                          static_cast<size_t>(entry.uncompressedSize))) {
+        setError("Failed to inflate file: " + entry.name);
+        return false;
     }
 
-    return fileInfo.uncompressed_size;
+    return true;
+}
+
+bool ZipReader::streamMappedEntry(const ZipEntry& entry, const ChunkCallback& onChunk,
+                                  size_t chunkSize) const {
+    const char* data = nullptr;
+    if (!locateMappedData(entry, data)) {
+        return false;
+    }
+
+    if (const char* failure = streamMappedData(entry, data, onChunk, chunkSize)) {
+        setError(std::string(failure) + ": " + entry.name);
+        return false;
+    }
+    return true;
+}
+
+const char* ZipReader::streamMappedData(const ZipEntry& entry, const char* data,
+                                        const ChunkCallback& onChunk, size_t chunkSize) const {
+    if (entry.method == kMethodStored) {
+        if (entry.compressedSize != entry.uncompressedSize) {
+            return "Stored entry size mismatch";
+        }
+
+        // Stored data is handed out in place, no buffer needed
+        uint64_t remaining = entry.uncompressedSize;
+        while (remaining > 0) {
+            size_t size = static_cast<size_t>(std::min<uint64_t>(remaining, chunkSize));
+            if (!onChunk(data, size)) {
+                return nullptr;
+            }
+            data += size;
+            remaining -= size;
+        }
+        return nullptr;
+    }
+
+    if (entry.method != kMethodDeflated) {
+        return "Unsupported compression method";
+    }
+
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        return "Failed to initialise inflate";
+    }
+
+    std::vector<char> buffer(chunkSize);
+    countBuffer(chunkSize);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+
+    // avail_in and total_out may be 32-bit, so feed and count in 64 bits
+    uint64_t inLeft = entry.compressedSize;
+    uint64_t total = 0;
+    int status = Z_OK;
+    while (status != Z_STREAM_END) {
+        if (stream.avail_in == 0 && inLeft > 0) {
+            uInt slice = static_cast<uInt>(std::min<uint64_t>(inLeft, kMaxReadRequest));
+            stream.avail_in = slice;
+            inLeft -= slice;
+        }
+        stream.next_out = reinterpret_cast<Bytef*>(buffer.data());
+        stream.avail_out = static_cast<uInt>(buffer.size());
+
+        {
+            InspectStats::Timer timer(stats_, InspectStats::Phase::Inflate);
+            status = inflate(&stream, Z_NO_FLUSH);
+        }
+        if (status != Z_OK && status != Z_STREAM_END) {
+            inflateEnd(&stream);
+            return "Failed to inflate file";
+        }
+
+        // A truncated stream surfaces as Z_BUF_ERROR above
+        size_t produced = buffer.size() - stream.avail_out;
+        total += produced;
+        if (produced > 0 && !onChunk(buffer.data(), produced)) {
+            inflateEnd(&stream);
+            return nullptr;
+        }
+    }
+
+    inflateEnd(&stream);
+
+    if (total != entry.uncompressedSize) {
+        return "Inflated size differs from the central directory";
+    }
+
+    return nullptr;
+}
+
+bool ZipReader::verifyEntry(const ZipEntry& entry, std::string& problem) const {
+    problem.clear();
+    if (!isOpen_ || backend_ != Backend::Mapped) {
+        problem = "Verification needs an open mapped archive";
+        return false;
+    }
+
+    const char* data = nullptr;
+    if (!checkLocalHeader(entry, data, problem)) {
+        return false;
+    }
+    if (entry.method == kMethodStored && entry.compressedSize != entry.uncompressedSize) {
+        problem = "Stored entry size mismatch";
+        return false;
+    }
+
+    uint32_t crc = 0;
+    const char* failure = streamMappedData(entry, data, [&crc](const char* chunk, size_t size) {
+        crc = Crc32::update(crc, chunk, size);
+        return true;
+    }, kDefaultChunkSize);
+    if (failure != nullptr) {
+        problem = failure;
+        return false;
+    }
+
+    if (crc != entry.crc32) {
+        char message[64];
+        std::snprintf(message, sizeof(message), "CRC-32 mismatch: stored %08x, computed %08x",
+                      static_cast<unsigned>(entry.crc32), static_cast<unsigned>(crc));
+        problem = message;
+        return false;
+    }
+    return true;
+}
+
+bool ZipReader::checkLocalHeader(const ZipEntry& entry, const char*& data, std::string& problem) const {
+    const char* base = mapping_.data();
+    uint64_t size = mapping_.size();
+    uint64_t header = entry.localHeaderOffset;
+
+    if (header > size || size - header < kLocalHeaderSize ||
+        readLE32(base + header) != kLocalHeaderSignature) {
+        problem = "No local header at offset " + std::to_string(header);
+        return false;
+    }
+
+    const char* local = base + header;
+    uint16_t flags = readLE16(local + 6);
+    uint16_t method = readLE16(local + 8);
+    uint32_t crc = readLE32(local + 14);
+    uint64_t compressedSize = readLE32(local + 18);
+    uint64_t uncompressedSize = readLE32(local + 22);
+    uint16_t nameLength = readLE16(local + 26);
+    uint16_t extraLength = readLE16(local + 28);
+
+    uint64_t dataOffset = header + kLocalHeaderSize + nameLength + extraLength;
+    if (dataOffset > size || entry.compressedSize > size - dataOffset) {
+        problem = "Entry data runs past the end of the archive";
+        return false;
+    }
+    if (std::string_view(local + kLocalHeaderSize, nameLength) != entry.name) {
+        problem = "Local header names \"" + std::string(local + kLocalHeaderSize, nameLength) + "\"";
+        return false;
+    }
+    if (method != entry.method) {
+        problem = "Local header method " + std::to_string(method) + ", central directory " +
+                  std::to_string(entry.method);
+        return false;
+    }
+
+    // A local Zip64 extra field always holds both sizes, uncompressed first
+    const char* zip64 = findExtraField(local + kLocalHeaderSize + nameLength, extraLength, kZip64ExtraId, 16);
+    if (zip64 != nullptr && (compressedSize == kZip64Marker || uncompressedSize == kZip64Marker)) {
+        uncompressedSize = readLE64(zip64);
+        compressedSize = readLE64(zip64 + 8);
+    }
+
+    if ((flags & kFlagDataDescriptor) != 0) {
+        // CRC and sizes follow the data, optionally behind a signature
+        const char* descriptor = base + dataOffset + entry.compressedSize;
+        uint64_t available = size - dataOffset - entry.compressedSize;
+        if (available >= 4 && readLE32(descriptor) == kDataDescriptorSignature) {
+            descriptor += 4;
+            available -= 4;
+        }
+        if (available < (zip64 != nullptr ? 20u : 12u)) {
+            problem = "Data descriptor missing";
+            return false;
+        }
+        crc = readLE32(descriptor);
+        compressedSize = zip64 != nullptr ? readLE64(descriptor + 4) : readLE32(descriptor + 4);
+        uncompressedSize = zip64 != nullptr ? readLE64(descriptor + 12) : readLE32(descriptor + 8);
+    }
+
+    if (crc != entry.crc32 || compressedSize != entry.compressedSize ||
+        uncompressedSize != entry.uncompressedSize) {
+        problem = "Local header disagrees with the central directory (CRC-32 or sizes)";
+        return false;
+    }
+
+    data = base + dataOffset;
+    return true;
+}
+
+bool ZipReader::fileExists(const std::string& filename) const {
+    return findEntry(filename) != nullptr;
+}
+
+uint64_t ZipReader::getFileSize(const std::string& filename) const {
+    const ZipEntry* entry = findEntry(filename);
+    return entry != nullptr ? entry->uncompressedSize : 0;
+}
+
+const ZipEntry* ZipReader::findEntry(const std::string& filename) const {
+    if (stats_ != nullptr) {
+        stats_->add(InspectStats::Counter::Lookups);
+    }
+    auto it = entryIndex_.find(filename);
+    if (it == entryIndex_.end()) {
+        return nullptr;
+    }
+    return &entries_[it->second];
+}
+
+const std::vector<ZipEntry>& ZipReader::entries() const {
+    return entries_;
+}
+
+uint32_t ZipReader::directoryChecksum() const {
+    uLong crc = ::crc32(0L, Z_NULL, 0);
+
+    for (const auto& entry : entries_) {
+        unsigned char fields[22];
+        const uint64_t values[] = { entry.compressedSize, entry.uncompressedSize };
+        for (size_t i = 0; i < 2; ++i) {
+            for (size_t b = 0; b < 8; ++b) {
+                fields[i * 8 + b] = static_cast<unsigned char>(values[i] >> (8 * b));
+            }
+        }
+        for (size_t b = 0; b < 4; ++b) {
+            fields[16 + b] = static_cast<unsigned char>(entry.crc32 >> (8 * b));
+        }
+        fields[20] = static_cast<unsigned char>(entry.method);
+        fields[21] = static_cast<unsigned char>(entry.method >> 8);
+
+        crc = ::crc32(crc, reinterpret_cast<const Bytef*>(entry.name.data()),
+                      static_cast<uInt>(entry.name.size()));
+        crc = ::crc32(crc, fields, sizeof(fields));
+    }
+
+    return static_cast<uint32_t>(crc);
 }
 
 std::string ZipReader::getLastError() const {
+    std::lock_guard<std::mutex> lock(errorMutex_);
     return lastError_;
 }
+
+void ZipReader::setError(const std::string& message) const {
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    lastError_ = message;
+}
+
+void ZipReader::setStats(InspectStats* stats) {
+    stats_ = stats;
+}
+
+void ZipReader::countBuffer(size_t size) const {
+    if (stats_ != nullptr) {
+        stats_->add(InspectStats::Counter::Allocations);
+        stats_->add(InspectStats::Counter::AllocatedBytes, size);
+    }
+}
+
+bool ZipReader::setInflateBackend(Inflater::Backend backend) {
+    if (!Inflater::isAvailable(backend)) {
+        return false;
+    }
+    inflateBackend_ = backend;
+    return true;
+}
+
+Inflater::Backend ZipReader::getInflateBackend() const {
+    return inflateBackend_;
+}
+
+void ZipReader::setPrivateCopy(bool copy) {
+    privateCopy_ = copy;
+}
+
+bool ZipReader::supportsConcurrentReads() const {
+    return backend_ == Backend::Mapped;
+}
+
+ZipReader::Backend ZipReader::getBackend() const {
+    return backend_;
+}
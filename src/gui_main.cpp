@@ -24,11 +24,9 @@ std::string currentFilePath;
 std::unique_ptr<ODFInspector> inspector;
 
 // Capture output to string
-std::string captureInspectorOutput(std::function<void()> func) {
-    std::stringstream buffer;
-    std::streambuf* old = std::cout.rdbuf(buffer.rdbuf());
-    func();
-    std::cout.rdbuf(old);
+std::string captureInspectorOutput(const std::function<void(std::ostream&)>& func) {
+    std::ostringstream buffer;
+    func(buffer);
     return buffer.str();
 }
 
@@ -42,19 +40,19 @@ void UpdateDisplay(int tabIndex) {
     
     switch (tabIndex) {
         case TAB_SUMMARY:
-            output = captureInspectorOutput([&]() { inspector->displaySummary(); });
+            output = captureInspectorOutput([&](std::ostream& out) { inspector->displaySummary(out); });
             break;
         case TAB_STRUCTURE:
-            output = captureInspectorOutput([&]() { inspector->displayStructure(); });
+            output = captureInspectorOutput([&](std::ostream& out) { inspector->displayStructure(out); });
             break;
         case TAB_METADATA:
-            output = captureInspectorOutput([&]() { inspector->displayMetadata(); });
+            output = captureInspectorOutput([&](std::ostream& out) { inspector->displayMetadata(out); });
             break;
         case TAB_CONTENT:
-            output = captureInspectorOutput([&]() { inspector->displayContent(); });
+            output = captureInspectorOutput([&](std::ostream& out) { inspector->displayContent(out); });
             break;
         case TAB_STYLES:
-            output = captureInspectorOutput([&]() { inspector->displayStyles(); });
+            output = captureInspectorOutput([&](std::ostream& out) { inspector->displayStyles(out); });
             break;
     }
     
@@ -70,7 +68,7 @@ void OpenODFFile() {
     ofn.hwndOwner = hMainWindow;
     ofn.lpstrFile = szFile;
     ofn.nMaxFile = sizeof(szFile);
-    ofn.lpstrFilter = "ODF Files\0*.ODT;*.ODS;*.ODP;*.ODG\0All Files\0*.*\0";
+    ofn.lpstrFilter = "ODF Files\0*.ODT;*.ODS;*.ODP;*.ODG;*.FODT;*.FODS;*.FODP;*.FODG\0All Files\0*.*\0";
     ofn.nFilterIndex = 1;
     ofn.lpstrFileTitle = NULL;
     ofn.nMaxFileTitle = 0;
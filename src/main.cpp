@@ -1,76 +1,598 @@
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
 #include <string>
 #include <memory>
+#include <vector>
 #include "ODFInspector.h"
+#include "ArchiveVerifier.h"
+#include "BatchRunner.h"
+#include "Crc32.h"
+#include "DocumentDiff.h"
+#include "Inflater.h"
+#include "InspectionServer.h"
+#include "JsonSink.h"
+#include "MediaDedup.h"
+#include "StatsAggregate.h"
+#include "TextSink.h"
+
+/**
+ * @brief Which views to print for each document
+ */
+struct InspectOptions {
+    bool showSummary = true;
+    bool showStructure = false;
+    bool showMetadata = false;
+    bool showContent = false;
+    bool showText = false;
+    bool showOutline = false;
+    bool showTables = false;
+    bool showStyles = false;
+    bool showManifest = false;
+    bool showImages = false;
+    bool showAll = false;
+    bool json = false;
+    bool stats = false;
+    std::string specificFile;
+    std::string extractDir;
+    std::string cacheFile;
+    std::string inflateBackend;
+};
 
 void printUsage(const char* programName) {
     std::cout << "\nODF Inspector - Inspect Open Document Format files\n";
     std::cout << "===================================================\n\n";
-    std::cout << "Usage: " << programName << " <odf-file> [options]\n\n";
+    std::cout << "Usage: " << programName << " <odf-file> [options]\n";
+    std::cout << "       " << programName << " --batch [options] <file|dir|pattern|->...\n";
+    std::cout << "       " << programName << " --diff <old-file> <new-file> [--inflate <backend>]\n\n";
     std::cout << "Options:\n";
     std::cout << "  --summary      Display document summary (default)\n";
-    std::cout << "  --structure    List all files in the archive\n";
+    std::cout << "  --structure    List all files in the archive (sections of flat ODF)\n";
     std::cout << "  --metadata     Show document metadata\n";
     std::cout << "  --content      Display content.xml preview\n";
+    std::cout << "  --text         Stream the plain text of the document body\n";
+    std::cout << "  --outline      List headings, slides and sheets\n";
+    std::cout << "  --tables       Show size, used range and cell types of each table\n";
     std::cout << "  --styles       Display styles.xml preview\n";
     std::cout << "  --manifest     Display manifest file\n";
     std::cout << "  --images       List embedded images\n";
-    std::cout << "  --all          Display everything\n";
+    std::cout << "  --all          Display everything except --text\n";
     std::cout << "  --file <name>  Extract and display specific file\n";
+    std::cout << "  --extract-all <dir>  Extract every entry into a directory\n";
+    std::cout << "  --cache <file> Reuse inspection results of unchanged documents\n";
+    std::cout << "  --json         Write summary, structure, metadata, images and tables as\n";
+    std::cout << "                 one JSON object per document (NDJSON)\n";
+    std::cout << "  --stats        Print per-phase timings and counters for each document;\n";
+    std::cout << "                 batch mode adds latency histograms for the whole run\n";
+    std::cout << "  --inflate <backend>  Decompressor for whole entries: zlib, zlib-ng or\n";
+    std::cout << "                 libdeflate, if built in (default: " << Inflater::name(Inflater::getDefault()) << ")\n";
     std::cout << "  --help         Show this help message\n\n";
+    std::cout << "Batch mode:\n";
+    std::cout << "  --batch        Inspect many documents in parallel. Inputs may be files,\n";
+    std::cout << "                 directories (searched recursively), wildcard patterns\n";
+    std::cout << "                 or '-' to read one path per line from stdin\n";
+    std::cout << "  --jobs <n>     Number of worker threads (default: all cores)\n";
+    std::cout << "  --dedup-media  Instead of per-document views, report images that are\n";
+    std::cout << "                 embedded more than once across all inputs and the bytes\n";
+    std::cout << "                 a single copy would save\n\n";
+    std::cout << "Diff mode:\n";
+    std::cout << "  --diff         Compare two revisions of a document. Entries are compared\n";
+    std::cout << "                 by CRC-32 and size; only changed XML entries are inflated\n";
+    std::cout << "                 and diffed element by element. Exits with 0 if the\n";
+    std::cout << "                 documents are identical, 1 if they differ, 2 on errors\n\n";
+    std::cout << "Verify mode:\n";
+    std::cout << "  --verify       Check every entry of every input archive against its\n";
+    std::cout << "                 CRC-32 and cross-check local headers with the central\n";
+    std::cout << "                 directory. Takes the same inputs and --jobs as --batch;\n";
+    std::cout << "                 exits with 1 if any archive is damaged\n\n";
+    std::cout << "Server mode:\n";
+    std::cout << "  --serve <socket>  Answer requests on a Unix domain socket, keeping\n";
+    std::cout << "                 recently used documents open between requests. One\n";
+    std::cout << "                 request per line, tab-separated: summary, structure,\n";
+    std::cout << "                 metadata or json and a path; file, a path and an entry;\n";
+    std::cout << "                 or stats. Responses are 'OK <length>' and the payload,\n";
+    std::cout << "                 or 'ERROR <message>'\n";
+    std::cout << "  --jobs <n>     Number of worker threads (default: all cores)\n";
+    std::cout << "  --cache-size <n>  Documents kept open (default: 256)\n";
+    std::cout << "  --cache-memory <MiB>  Total size of the documents kept open; each\n";
+    std::cout << "                 is held as an in-memory copy (default: 1024)\n\n";
     std::cout << "Examples:\n";
     std::cout << "  " << programName << " document.odt\n";
     std::cout << "  " << programName << " spreadsheet.ods --all\n";
     std::cout << "  " << programName << " presentation.odp --metadata --content\n";
-    std::cout << "  " << programName << " document.odt --file content.xml\n\n";
+    std::cout << "  " << programName << " document.odt --file content.xml\n";
+    std::cout << "  " << programName << " document.odt --text\n";
+    std::cout << "  " << programName << " spreadsheet.ods --tables\n";
+    std::cout << "  " << programName << " report.fodt --file office:body\n";
+    std::cout << "  " << programName << " --diff report-v1.odt report-v2.odt\n";
+    std::cout << "  " << programName << " --batch --metadata /srv/documents\n";
+    std::cout << "  " << programName << " --batch --cache audit.cache --metadata /srv/documents\n";
+    std::cout << "  find . -name '*.odt' | " << programName << " --batch --structure -\n";
+    std::cout << "  " << programName << " --batch --dedup-media /srv/documents\n";
+    std::cout << "  " << programName << " --verify --jobs 16 /srv/documents\n";
+    std::cout << "  " << programName << " --serve /run/odf-inspector.sock --cache-size 1024\n";
+    std::cout << "  " << programName << " --batch --json --metadata /srv/documents > meta.ndjson\n\n";
 }
 
-int main(int argc, char* argv[]) {
-    if (argc < 2) {
+/**
+ * @brief Parse one display option
+ * @return true if the argument was a display option
+ */
+bool parseInspectOption(int& i, int argc, char* argv[], InspectOptions& options) {
+    std::string arg = argv[i];
+
+    if (arg == "--summary") {
+        options.showSummary = true;
+    } else if (arg == "--structure") {
+        options.showStructure = true;
+    } else if (arg == "--metadata") {
+        options.showMetadata = true;
+    } else if (arg == "--content") {
+        options.showContent = true;
+    } else if (arg == "--text") {
+        options.showText = true;
+    } else if (arg == "--outline") {
+        options.showOutline = true;
+    } else if (arg == "--tables") {
+        options.showTables = true;
+    } else if (arg == "--styles") {
+        options.showStyles = true;
+    } else if (arg == "--manifest") {
+        options.showManifest = true;
+    } else if (arg == "--images") {
+        options.showImages = true;
+    } else if (arg == "--all") {
+        options.showAll = true;
+    } else if (arg == "--json") {
+        options.json = true;
+    } else if (arg == "--stats") {
+        options.stats = true;
+    } else if (arg == "--file" && i + 1 < argc) {
+        options.specificFile = argv[++i];
+    } else if (arg == "--extract-all" && i + 1 < argc) {
+        options.extractDir = argv[++i];
+    } else if (arg == "--cache" && i + 1 < argc) {
+        options.cacheFile = argv[++i];
+    } else if (arg == "--inflate" && i + 1 < argc) {
+        options.inflateBackend = argv[++i];
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool finalizeOptions(InspectOptions& options) {
+    if (!options.inflateBackend.empty()) {
+        Inflater::Backend backend;
+        if (!Inflater::fromName(options.inflateBackend, backend) || !Inflater::setDefault(backend)) {
+            std::cerr << "Inflate backend not available: " << options.inflateBackend << "\n";
+            return false;
+        }
+    }
+
+    if (options.json) {
+        if (options.showContent || options.showText || options.showOutline || options.showStyles || options.showManifest ||
+            !options.specificFile.empty() || !options.extractDir.empty()) {
+            std::cerr << "--json supports --summary, --structure, --metadata, --images and --tables\n";
+            return false;
+        }
+        // --all means every structured view
+        if (options.showAll) {
+            options.showSummary = true;
+            options.showStructure = true;
+            options.showMetadata = true;
+            options.showImages = true;
+            options.showTables = true;
+        }
+        return true;
+    }
+
+    // If --all is specified, enable everything
+    if (options.showAll) {
+        options.showSummary = true;
+        options.showStructure = true;
+        options.showMetadata = true;
+        options.showContent = true;
+        options.showOutline = true;
+        options.showTables = true;
+        options.showStyles = true;
+        options.showManifest = true;
+        options.showImages = true;
+    }
+    return true;
+}
+
+/**
+ * @brief Load the cache file named by --cache, if any
+ * @return The cache, or nullptr when no cache was requested
+ */
+std::unique_ptr<InspectionCache> openCache(const InspectOptions& options) {
+    if (options.cacheFile.empty()) {
+        return nullptr;
+    }
+
+    auto cache = std::make_unique<InspectionCache>(options.cacheFile);
+    if (!cache->load()) {
+        // A damaged cache is rebuilt rather than treated as fatal
+        std::cerr << "Warning: " << cache->getLastError() << "\n";
+    }
+    return cache;
+}
+
+void saveCache(InspectionCache* cache) {
+    if (cache != nullptr && !cache->save()) {
+        std::cerr << "Warning: " << cache->getLastError() << "\n";
+    }
+}
+
+void displayRequested(const ODFInspector& inspector, const InspectOptions& options, std::ostream& out,
+                      InspectStats* stats) {
+    // Inflate the parts the views will need whole side by side. The
+    // content and styles previews only read the start of their part.
+    std::vector<ODFInspector::Part> parts;
+    if (options.showMetadata) {
+        parts.push_back(ODFInspector::Part::Meta);
+    }
+    if (options.showOutline) {
+        parts.push_back(ODFInspector::Part::Content);
+    }
+    if (options.showManifest) {
+        parts.push_back(ODFInspector::Part::Manifest);
+    }
+    inspector.prefetchParts(parts);
+
+    InspectStats::Timer timer(stats, InspectStats::Phase::Output);
+
+    if (options.showSummary) {
+        inspector.displaySummary(out);
+    }
+
+    if (options.showStructure) {
+        inspector.displayStructure(out);
+    }
+
+    if (options.showMetadata) {
+        inspector.displayMetadata(out);
+    }
+
+    if (options.showContent) {
+        inspector.displayContent(out);
+    }
+
+    if (options.showText) {
+        inspector.displayText(out);
+    }
+
+    if (options.showOutline) {
+        inspector.displayOutline(out);
+    }
+
+    if (options.showTables) {
+        inspector.displayTables(out);
+    }
+
+    if (options.showStyles) {
+        inspector.displayStyles(out);
+    }
+
+    if (options.showManifest) {
+        inspector.displayManifest(out);
+    }
+
+    if (options.showImages) {
+        inspector.listImages(out);
+    }
+
+    if (!options.specificFile.empty()) {
+        inspector.displayFile(options.specificFile, out);
+    }
+
+    if (!options.extractDir.empty()) {
+        inspector.extractAll(options.extractDir, out);
+    }
+}
+
+/**
+ * @brief Write the requested views of one document as structured records
+ * @return false if the document could not be loaded
+ */
+bool writeRecords(ODFInspector& inspector, const std::string& path,
+                  const InspectOptions& options, OutputSink& sink, InspectStats* stats) {
+    sink.beginDocument(path);
+    inspector.setStats(stats);
+
+    bool loaded;
+    {
+        InspectStats::Timer total(stats, InspectStats::Phase::Total);
+        loaded = inspector.load();
+        if (!loaded) {
+            sink.error(inspector.getLastError());
+        } else {
+            if (options.showMetadata) {
+                inspector.prefetchParts({ ODFInspector::Part::Meta });
+            }
+
+            InspectStats::Timer output(stats, InspectStats::Phase::Output);
+            if (options.showSummary) {
+                inspector.writeSummary(sink);
+            }
+            if (options.showStructure) {
+                inspector.writeStructure(sink);
+            }
+            if (options.showMetadata) {
+                inspector.writeMetadata(sink);
+            }
+            if (options.showImages) {
+                inspector.writeImages(sink);
+            }
+            if (options.showTables) {
+                inspector.writeTables(sink);
+            }
+        }
+    }
+
+    if (stats != nullptr) {
+        sink.stats(*stats);
+    }
+    sink.endDocument();
+    return loaded;
+}
+
+int runBatch(int argc, char* argv[]) {
+    InspectOptions options;
+    std::vector<std::string> inputs;
+    size_t jobs = 0;
+    bool dedupMedia = false;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (parseInspectOption(i, argc, argv, options)) {
+            continue;
+        }
+
+        if (arg == "--jobs" && i + 1 < argc) {
+            jobs = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--dedup-media") {
+            dedupMedia = true;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    if (inputs.empty()) {
+        std::cerr << "No input files given\n";
         printUsage(argv[0]);
         return 1;
     }
 
-    std::string odfPath = argv[1];
+    if (!options.extractDir.empty()) {
+        std::cerr << "--extract-all is not available in batch mode\n";
+        return 1;
+    }
 
-    // Check for help flag
-    if (odfPath == "--help" || odfPath == "-h") {
+    if (dedupMedia && options.json) {
+        std::cerr << "--dedup-media writes a text report and can't be combined with --json\n";
+        return 1;
+    }
+
+    if (!finalizeOptions(options)) {
+        return 1;
+    }
+    auto cache = openCache(options);
+    StatsAggregate aggregate;
+    MediaDedup dedup;
+
+    BatchRunner runner(jobs);
+    if (options.json) {
+        // Failed documents are records too
+        runner.setFailureStream(std::cout);
+    }
+    auto result = runner.run(inputs, [&](const std::string& path, std::ostream& out) {
+        ODFInspector inspector(path);
+        inspector.setCache(cache.get());
+
+        InspectStats stats;
+        InspectStats* statsPtr = options.stats ? &stats : nullptr;
+
+        bool ok;
+        if (dedupMedia) {
+            // Only the directory is needed up front; images are read only
+            // when their CRC and size turn out not to be unique
+            inspector.setStats(statsPtr);
+            {
+                InspectStats::Timer total(statsPtr, InspectStats::Phase::Total);
+                ok = inspector.load() && dedup.add(path, inspector);
+            }
+            if (!ok) {
+                std::string error = inspector.getLastError();
+                out << "Error: " << path << ": " << (error.empty() ? dedup.getLastError() : error) << "\n";
+            }
+        } else if (options.json) {
+            // Each worker keeps one grown buffer for all of its documents
+            thread_local std::string buffer;
+            JsonSink sink(out, buffer);
+            try {
+                ok = writeRecords(inspector, path, options, sink, statsPtr);
+            } catch (const std::exception& e) {
+                // Replace the unfinished record with an error record
+                sink.discard();
+                sink.beginDocument(path);
+                sink.error(e.what());
+                sink.endDocument();
+                ok = false;
+            }
+        } else {
+            out << "Loading ODF file: " << path << "\n";
+            inspector.setStats(statsPtr);
+            {
+                InspectStats::Timer total(statsPtr, InspectStats::Phase::Total);
+                ok = inspector.load();
+                if (ok) {
+                    displayRequested(inspector, options, out, statsPtr);
+                }
+            }
+            if (!ok) {
+                out << "Error: " << inspector.getLastError() << "\n";
+            }
+            if (statsPtr != nullptr) {
+                TextSink(out).stats(stats);
+            }
+        }
+
+        if (statsPtr != nullptr) {
+            aggregate.add(stats);
+        }
+        return ok;
+    });
+
+    saveCache(cache.get());
+
+    if (dedupMedia) {
+        dedup.write(std::cout);
+    }
+
+    // Keep stdout pure NDJSON in JSON mode
+    std::ostream& report = options.json ? std::cerr : std::cout;
+    if (options.stats) {
+        aggregate.write(report);
+    }
+    report << "\nBatch complete: " << result.processed << " documents, "
+           << result.failed << " failed\n";
+    return result.failed == 0 ? 0 : 1;
+}
+
+int runDiff(int argc, char* argv[]) {
+    InspectOptions options;
+    std::vector<std::string> paths;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--inflate" && i + 1 < argc) {
+            options.inflateBackend = argv[++i];
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printUsage(argv[0]);
+            return 2;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+
+    if (paths.size() != 2) {
+        std::cerr << "--diff needs exactly two documents\n";
         printUsage(argv[0]);
-        return 0;
+        return 2;
+    }
+    if (!finalizeOptions(options)) {
+        return 2;
     }
 
-    // Parse options
-    bool showSummary = true;
-    bool showStructure = false;
-    bool showMetadata = false;
-    bool showContent = false;
-    bool showStyles = false;
-    bool showManifest = false;
-    bool showImages = false;
-    bool showAll = false;
-    std::string specificFile;
+    ODFInspector before(paths[0]);
+    ODFInspector after(paths[1]);
+    for (ODFInspector* inspector : { &before, &after }) {
+        if (!inspector->load()) {
+            std::cerr << "Error: " << inspector->getLastError() << "\n";
+            return 2;
+        }
+    }
+
+    DocumentDiff diff(before, after);
+    if (!diff.compareEntries()) {
+        std::cerr << "Error: " << diff.getLastError() << "\n";
+        return 2;
+    }
+    if (!diff.write(std::cout)) {
+        return 2;
+    }
+    return diff.hasChanges() ? 1 : 0;
+}
+
+int runVerify(int argc, char* argv[]) {
+    std::vector<std::string> inputs;
+    size_t jobs = 0;
 
     for (int i = 2; i < argc; ++i) {
         std::string arg = argv[i];
-        
-        if (arg == "--summary") {
-            showSummary = true;
-        } else if (arg == "--structure") {
-            showStructure = true;
-        } else if (arg == "--metadata") {
-            showMetadata = true;
-        } else if (arg == "--content") {
-            showContent = true;
-        } else if (arg == "--styles") {
-            showStyles = true;
-        } else if (arg == "--manifest") {
-            showManifest = true;
-        } else if (arg == "--images") {
-            showImages = true;
-        } else if (arg == "--all") {
-            showAll = true;
-        } else if (arg == "--file" && i + 1 < argc) {
-            specificFile = argv[++i];
+        if (arg == "--jobs" && i + 1 < argc) {
+            jobs = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    if (inputs.empty()) {
+        std::cerr << "No inputs given for --verify\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    size_t documents = 0;
+    size_t skipped = 0;
+    size_t failed = 0;
+    uint64_t entries = 0;
+    uint64_t bytes = 0;
+    uint64_t storedBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    ArchiveVerifier verifier(jobs);
+    verifier.run(inputs, [&](const ArchiveVerifier::Report& report) {
+        ArchiveVerifier::write(report, std::cout);
+        ++documents;
+        skipped += report.skipped ? 1 : 0;
+        failed += report.ok() ? 0 : 1;
+        entries += report.entries;
+        bytes += report.bytes;
+        storedBytes += report.storedBytes;
+    });
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "\nVerify complete: " << documents << " documents (" << skipped << " skipped), "
+              << failed << " failed\n";
+    std::cout << "  " << entries << " entries, " << storedBytes << " bytes read, " << bytes
+              << " bytes checked in " << std::fixed << std::setprecision(3) << seconds << " s ("
+              << Crc32::instructionSet() << " CRC-32)\n";
+    return failed == 0 ? 0 : 1;
+}
+
+// Server stopped by SIGINT and SIGTERM
+InspectionServer* activeServer = nullptr;
+
+void stopServer(int) {
+    if (activeServer != nullptr) {
+        activeServer->stop();
+    }
+}
+
+int runServe(int argc, char* argv[]) {
+    if (argc < 3 || argv[2][0] == '-') {
+        std::cerr << "--serve needs a socket path\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::string socketPath = argv[2];
+    size_t jobs = 0;
+    size_t cacheSize = 256;
+    uint64_t cacheMemory = 1024;   // MiB
+
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--jobs" && i + 1 < argc) {
+            jobs = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--cache-size" && i + 1 < argc) {
+            cacheSize = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--cache-memory" && i + 1 < argc) {
+            cacheMemory = std::strtoull(argv[++i], nullptr, 10);
         } else {
             std::cerr << "Unknown option: " << arg << "\n";
             printUsage(argv[0]);
@@ -78,60 +600,116 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    // If --all is specified, enable everything
-    if (showAll) {
-        showSummary = true;
-        showStructure = true;
-        showMetadata = true;
-        showContent = true;
-        showStyles = true;
-        showManifest = true;
-        showImages = true;
+    InspectionServer server(socketPath, jobs, cacheSize, cacheMemory << 20);
+    if (!server.start()) {
+        std::cerr << "Error: " << server.getLastError() << "\n";
+        return 1;
     }
 
-    // Create inspector and load the file
-    std::cout << "Loading ODF file: " << odfPath << "\n";
-    
-    auto inspector = std::make_unique<ODFInspector>(odfPath);
-    
-    if (!inspector->load()) {
-        std::cerr << "Error: " << inspector->getLastError() << "\n";
+    activeServer = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+#ifndef _WIN32
+    // A client that hangs up early must not take the server down
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+
+    std::cerr << "Listening on " << socketPath << "\n";
+    server.run();
+    activeServer = nullptr;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
         return 1;
     }
 
-    std::cout << "Successfully loaded ODF file!\n";
+    std::string odfPath = argv[1];
 
-    // Display requested information
-    if (showSummary) {
-        inspector->displaySummary();
+    // Check for help flag
+    if (odfPath == "--help" || odfPath == "-h") {
+        printUsage(argv[0]);
+        return 0;
     }
 
-    if (showStructure) {
-        inspector->displayStructure();
+    if (odfPath == "--batch") {
+        return runBatch(argc, argv);
     }
 
-    if (showMetadata) {
-        inspector->displayMetadata();
+    if (odfPath == "--serve") {
+        return runServe(argc, argv);
     }
 
-    if (showContent) {
-        inspector->displayContent();
+    if (odfPath == "--verify") {
+        return runVerify(argc, argv);
     }
 
-    if (showStyles) {
-        inspector->displayStyles();
+    if (odfPath == "--diff") {
+        return runDiff(argc, argv);
     }
 
-    if (showManifest) {
-        inspector->displayManifest();
+    // Parse options
+    InspectOptions options;
+
+    for (int i = 2; i < argc; ++i) {
+        if (!parseInspectOption(i, argc, argv, options)) {
+            std::cerr << "Unknown option: " << argv[i] << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!finalizeOptions(options)) {
+        return 1;
     }
 
-    if (showImages) {
-        inspector->listImages();
+    if (options.json) {
+        ODFInspector inspector(odfPath);
+        inspector.setThreadCount(0);
+        auto cache = openCache(options);
+        inspector.setCache(cache.get());
+
+        InspectStats stats;
+        JsonSink sink(std::cout);
+        bool ok = writeRecords(inspector, odfPath, options, sink, options.stats ? &stats : nullptr);
+        sink.flush();
+        saveCache(cache.get());
+        return ok ? 0 : 1;
+    }
+
+    // Create inspector and load the file
+    std::cout << "Loading ODF file: " << odfPath << "\n";
+
+    auto inspector = std::make_unique<ODFInspector>(odfPath);
+    // A single document may use every core; batch mode parallelises across
+    // documents instead
+    inspector->setThreadCount(0);
+
+    auto cache = openCache(options);
+    inspector->setCache(cache.get());
+
+    InspectStats stats;
+    InspectStats* statsPtr = options.stats ? &stats : nullptr;
+    inspector->setStats(statsPtr);
+
+    {
+        InspectStats::Timer total(statsPtr, InspectStats::Phase::Total);
+        if (!inspector->load()) {
+            std::cerr << "Error: " << inspector->getLastError() << "\n";
+            return 1;
+        }
+
+        std::cout << "Successfully loaded ODF file!\n";
+
+        // Display requested information
+        displayRequested(*inspector, options, std::cout, statsPtr);
     }
+    saveCache(cache.get());
 
-    if (!specificFile.empty()) {
-        inspector->displayFile(specificFile);
+    if (statsPtr != nullptr) {
+        TextSink(std::cout).stats(stats);
     }
 
     std::cout << "\nInspection complete!\n";
@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "Crc32.h"
+#include "TestHarness.h"
+
+namespace {
+
+uint32_t zlibCrc(const unsigned char* data, size_t size) {
+    return static_cast<uint32_t>(crc32(0, data, static_cast<uInt>(size)));
+}
+
+} // namespace
+
+TEST(Crc32, knownValues) {
+    CHECK_EQ(Crc32::update(0, "", 0), uint32_t(0));
+    CHECK_EQ(Crc32::update(0, "123456789", 9), uint32_t(0xCBF43926));
+}
+
+TEST(Crc32, matchesZlib) {
+    // Every length and alignment around the 16- and 64-byte blocks the
+    // folding loops work in, then sizes well past them
+    std::vector<unsigned char> data(1 << 20);
+    uint32_t seed = 1;
+    for (unsigned char& byte : data) {
+        seed = seed * 1103515245 + 12345;
+        byte = static_cast<unsigned char>(seed >> 24);
+    }
+
+    std::string failures;
+    for (size_t offset = 0; offset < 16; ++offset) {
+        for (size_t size = 0; size <= 300; ++size) {
+            if (Crc32::update(0, &data[offset], size) != zlibCrc(&data[offset], size)) {
+                failures += " " + std::to_string(offset) + "+" + std::to_string(size);
+            }
+        }
+    }
+    for (size_t size : { size_t(4095), size_t(4096), size_t(65537), data.size() - 3 }) {
+        if (Crc32::update(0, &data[3], size) != zlibCrc(&data[3], size)) {
+            failures += " 3+" + std::to_string(size);
+        }
+    }
+    if (!failures.empty()) {
+        TestHarness::fail(__FILE__, __LINE__, std::string(Crc32::instructionSet()) +
+                                              " differs from zlib at offset+size" + failures);
+    }
+}
+
+TEST(Crc32, pieces) {
+    std::vector<unsigned char> data(100000);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<unsigned char>(i * 7 + i / 251);
+    }
+    uint32_t whole = zlibCrc(data.data(), data.size());
+
+    for (size_t piece : { size_t(1), size_t(7), size_t(64), size_t(1000), size_t(65536) }) {
+        uint32_t crc = 0;
+        for (size_t at = 0; at < data.size(); at += piece) {
+            crc = Crc32::update(crc, &data[at], std::min(piece, data.size() - at));
+        }
+        CHECK_EQ(crc, whole);
+    }
+}
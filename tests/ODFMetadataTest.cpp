@@ -0,0 +1,85 @@
+#include <cstdint>
+#include <string>
+#include "ODFMetadata.h"
+#include "TestHarness.h"
+
+namespace {
+
+bool duration(const char* text, uint64_t& seconds) {
+    seconds = 0;
+    return ODFMetadata::parseDuration(text, seconds);
+}
+
+} // namespace
+
+TEST(ODFMetadata, duration) {
+    uint64_t seconds = 0;
+    CHECK(duration("PT1H30M", seconds));
+    CHECK_EQ(seconds, uint64_t(5400));
+    CHECK(duration("P1DT2H3M4.5S", seconds));
+    CHECK_EQ(seconds, uint64_t(93784));
+    CHECK(duration("P2W", seconds));
+    CHECK_EQ(seconds, uint64_t(1209600));
+    CHECK(duration("P1Y1M", seconds));
+    CHECK_EQ(seconds, uint64_t(365 + 30) * 86400);
+    CHECK(duration(" PT5S ", seconds));
+    CHECK_EQ(seconds, uint64_t(5));
+
+    for (const char* invalid : { "", "P", "PT", "1H", "PT1", "P1H", "P1.5D", "PTT1H", "PT1X" }) {
+        if (duration(invalid, seconds)) {
+            TestHarness::fail(__FILE__, __LINE__, std::string("accepted \"") + invalid + "\"");
+        }
+    }
+}
+
+TEST(ODFMetadata, durationOverflow) {
+    uint64_t seconds = 0;
+
+    // Just below 2^64 - 1 seconds
+    CHECK(duration("P584000000000Y", seconds));
+    CHECK_EQ(seconds, uint64_t(18417024000000000000ULL));
+
+    // One component, or the sum of several, past it
+    CHECK(!duration("P999999999999Y", seconds));
+    CHECK(!duration("P584000000000Y1000000000000W", seconds));
+    CHECK(!duration("P500000000000Y500000000000Y", seconds));
+
+    // Components are capped at 10^12 before they are multiplied
+    CHECK(!duration("P1000000000001D", seconds));
+    CHECK(!duration("PT99999999999999999999999S", seconds));
+}
+
+TEST(ODFMetadata, parse) {
+    const char* xml =
+        "<?xml version=\"1.0\"?>"
+        "<office:document-meta><office:meta>"
+        "<dc:title xml:lang=\"en\">Fish &amp; Chips</dc:title>"
+        "<meta:keyword>one</meta:keyword><meta:keyword>two</meta:keyword>"
+        "<meta:editing-cycles>12</meta:editing-cycles>"
+        "<meta:editing-duration>PT2H</meta:editing-duration>"
+        "<meta:document-statistic meta:page-count=\"3\" meta:word-count=\"1234\"/>"
+        "<meta:user-defined meta:name=\"Client\" meta:value-type=\"string\">ACME</meta:user-defined>"
+        "</office:meta></office:document-meta>";
+
+    ODFMetadata metadata;
+    CHECK(ODFMetadata::parse(xml, metadata));
+    CHECK_EQ(metadata.title, std::string("Fish & Chips"));
+    CHECK_EQ(metadata.keywords.size(), size_t(2));
+    CHECK(metadata.editingCycles == uint64_t(12));
+    CHECK_EQ(metadata.editingDuration, std::string("PT2H"));
+    CHECK(metadata.editingSeconds == uint64_t(7200));
+    CHECK(metadata.statistics.pageCount == uint64_t(3));
+    CHECK(metadata.statistics.wordCount == uint64_t(1234));
+    CHECK(!metadata.statistics.tableCount);
+    CHECK_EQ(metadata.userDefined.size(), size_t(1));
+    if (metadata.userDefined.size() == 1) {
+        CHECK_EQ(metadata.userDefined[0].name, std::string("Client"));
+        CHECK_EQ(metadata.userDefined[0].value, std::string("ACME"));
+    }
+
+    // An overflowing duration is kept as text but has no seconds
+    CHECK(ODFMetadata::parse("<office:meta><meta:editing-duration>P999999999999Y"
+                             "</meta:editing-duration></office:meta>", metadata));
+    CHECK_EQ(metadata.editingDuration, std::string("P999999999999Y"));
+    CHECK(!metadata.editingSeconds);
+}
@@ -0,0 +1,159 @@
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "TableScanner.h"
+#include "TestHarness.h"
+
+namespace {
+
+using CellType = TableScanner::CellType;
+
+// A sheet that is over a billion cells once expanded, and an empty one
+const char* const kContent =
+    "<office:document-content><office:body><office:spreadsheet>"
+    "<table:table table:name=\"Data &amp; more\">"
+    "<table:table-column table:number-columns-repeated=\"3\"/><table:table-column/>"
+    "<table:table-row>"
+    "<table:table-cell office:value-type=\"float\" office:value=\"1\" table:formula=\"of:=1\"/>"
+    "<table:table-cell table:number-columns-repeated=\"2\"><text:p>x</text:p></table:table-cell>"
+    "<table:table-cell table:number-columns-repeated=\"1000\"/>"
+    "</table:table-row>"
+    "<table:table-row table:number-rows-repeated=\"1048000\">"
+    "<table:table-cell table:number-columns-repeated=\"1024\"> </table:table-cell>"
+    "</table:table-row>"
+    "<table:table-row table:number-rows-repeated=\"3\">"
+    "<table:covered-table-cell table:number-columns-repeated=\"2\"/>"
+    "<table:table-cell table:number-columns-repeated=\"4\" office:value-type=\"percentage\"/>"
+    "<table:table-cell><table:table><table:table-row><table:table-cell>"
+    "<text:p>nested</text:p></table:table-cell></table:table-row></table:table></table:table-cell>"
+    "</table:table-row>"
+    "</table:table>"
+    "<table:table table:name=\"Empty\"><table:table-column/></table:table>"
+    "</office:spreadsheet></office:body></office:document-content>";
+
+std::string describe(const TableScanner::SheetStats& sheet) {
+    std::string text = sheet.name + ": " + std::to_string(sheet.rows) + "x" + std::to_string(sheet.columns) +
+                       " " + TableScanner::usedRange(sheet);
+    for (size_t type = 0; type < TableScanner::kCellTypeCount; ++type) {
+        text += " " + std::to_string(sheet.cells[type]);
+    }
+    return text + " f" + std::to_string(sheet.formulas) + " c" + std::to_string(sheet.coveredCells);
+}
+
+std::string scan(std::string_view first, std::string_view second) {
+    TableScanner scanner;
+    scanner.feed(first);
+    scanner.feed(second);
+    scanner.finish();
+    std::string text;
+    for (const auto& sheet : scanner.sheets()) {
+        text += describe(sheet) + "\n";
+    }
+    return text;
+}
+
+} // namespace
+
+TEST(TableScanner, repeatedRowsAndCells) {
+    struct RowSeen {
+        size_t sheet;
+        uint64_t row;
+        uint64_t repeat;
+        std::vector<TableScanner::CellRun> cells;
+    };
+    std::vector<RowSeen> rows;
+
+    TableScanner scanner;
+    scanner.setRowCallback([&rows](size_t sheet, const TableScanner::Row& row) {
+        rows.push_back({ sheet, row.row, row.repeat, { row.cells, row.cells + row.cellCount } });
+    });
+    scanner.feed(kContent);
+    scanner.finish();
+
+    const auto& sheets = scanner.sheets();
+    CHECK_EQ(sheets.size(), size_t(2));
+    if (sheets.size() != 2) {
+        return;
+    }
+
+    const TableScanner::SheetStats& data = sheets[0];
+    CHECK_EQ(data.name, std::string("Data & more"));
+    CHECK_EQ(data.rows, uint64_t(1048004));
+    CHECK_EQ(data.columns, uint64_t(1024));
+    CHECK(data.used);
+    CHECK_EQ(TableScanner::usedRange(data), std::string("A1:G1048004"));
+    CHECK_EQ(data.cells[static_cast<size_t>(CellType::Float)], uint64_t(1));
+    CHECK_EQ(data.cells[static_cast<size_t>(CellType::String)], uint64_t(2 + 3));
+    CHECK_EQ(data.cells[static_cast<size_t>(CellType::Percentage)], uint64_t(3 * 4));
+    CHECK_EQ(data.cells[static_cast<size_t>(CellType::Empty)], uint64_t(1000 + 1048000ull * 1024 + 3 * 2));
+    CHECK_EQ(data.formulas, uint64_t(1));
+    CHECK_EQ(data.coveredCells, uint64_t(6));
+
+    // Declared columns count for an otherwise empty sheet
+    CHECK_EQ(sheets[1].name, std::string("Empty"));
+    CHECK_EQ(sheets[1].rows, uint64_t(0));
+    CHECK_EQ(sheets[1].columns, uint64_t(1));
+    CHECK(!sheets[1].used);
+    CHECK_EQ(TableScanner::usedRange(sheets[1]), std::string());
+
+    // Rows arrive run-length encoded, never expanded; the nested table's
+    // row is part of its cell
+    CHECK_EQ(rows.size(), size_t(3));
+    if (rows.size() == 3) {
+        CHECK_EQ(rows[1].row, uint64_t(1));
+        CHECK_EQ(rows[1].repeat, uint64_t(1048000));
+        CHECK_EQ(rows[1].cells.size(), size_t(1));
+        CHECK_EQ(rows[1].cells[0].repeat, uint64_t(1024));
+
+        const RowSeen& last = rows[2];
+        CHECK_EQ(last.row, uint64_t(1048001));
+        CHECK_EQ(last.repeat, uint64_t(3));
+        CHECK_EQ(last.cells.size(), size_t(3));
+        if (last.cells.size() == 3) {
+            CHECK(last.cells[0].covered);
+            CHECK_EQ(last.cells[1].column, uint64_t(2));
+            CHECK(last.cells[1].type == CellType::Percentage);
+            CHECK_EQ(last.cells[2].column, uint64_t(6));
+            CHECK(last.cells[2].type == CellType::String);
+        }
+    }
+}
+
+TEST(TableScanner, repeatLimit) {
+    // Absurd counts are capped rather than trusted or wrapped
+    TableScanner scanner;
+    scanner.feed("<table:table><table:table-row table:number-rows-repeated=\"99999999999999999999999\">"
+                 "<table:table-cell table:number-columns-repeated=\"99999999999\" office:value-type=\"float\"/>"
+                 "</table:table-row></table:table>");
+    scanner.finish();
+    CHECK_EQ(scanner.sheets().size(), size_t(1));
+    if (scanner.sheets().size() == 1) {
+        const TableScanner::SheetStats& sheet = scanner.sheets()[0];
+        CHECK_EQ(sheet.rows, uint64_t(1) << 31);
+        CHECK_EQ(sheet.columns, uint64_t(1) << 31);
+        CHECK_EQ(sheet.cells[static_cast<size_t>(CellType::Float)], uint64_t(1) << 62);
+    }
+}
+
+TEST(TableScanner, everyChunkBoundary) {
+    std::string_view content(kContent);
+    std::string whole = scan(content, std::string_view());
+    for (size_t split = 0; split <= content.size(); ++split) {
+        std::string text = scan(content.substr(0, split), content.substr(split));
+        if (text != whole) {
+            CHECK_EQ(text, whole);
+            TestHarness::fail(__FILE__, __LINE__, "split at byte " + std::to_string(split));
+            break;
+        }
+    }
+}
+
+TEST(TableScanner, columnNames) {
+    CHECK_EQ(TableScanner::columnName(0), std::string("A"));
+    CHECK_EQ(TableScanner::columnName(25), std::string("Z"));
+    CHECK_EQ(TableScanner::columnName(26), std::string("AA"));
+    CHECK_EQ(TableScanner::columnName(701), std::string("ZZ"));
+    CHECK_EQ(TableScanner::columnName(702), std::string("AAA"));
+    CHECK_EQ(TableScanner::columnName(16383), std::string("XFD"));
+}
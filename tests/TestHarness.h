@@ -0,0 +1,58 @@
+#ifndef TESTHARNESS_H
+#define TESTHARNESS_H
+
+#include <sstream>
+#include <string>
+
+/**
+ * @brief Minimal test registry for odf-tests
+ *
+ * TEST(Suite, name) defines a test that registers itself at startup.
+ * CHECK and CHECK_EQ record a failure with its location and let the test
+ * carry on, so one run shows every broken expectation. odf-tests runs all
+ * tests, or only the suites named on its command line, and exits with 1
+ * if any check failed.
+ */
+namespace TestHarness {
+
+using TestFunction = void (*)();
+
+/**
+ * @brief Add a test to the registry
+ * @return true, so that registration can initialise a static
+ */
+bool registerTest(const char* suite, const char* name, TestFunction function);
+
+/**
+ * @brief Record a failed check in the running test
+ */
+void fail(const char* file, int line, const std::string& message);
+
+} // namespace TestHarness
+
+#define TEST(suite, name)                                                            \
+    static void suite##_##name();                                                    \
+    static const bool suite##_##name##_registered =                                  \
+        TestHarness::registerTest(#suite, #name, &suite##_##name);                   \
+    static void suite##_##name()
+
+#define CHECK(condition)                                                             \
+    do {                                                                             \
+        if (!(condition)) {                                                          \
+            TestHarness::fail(__FILE__, __LINE__, #condition);                       \
+        }                                                                            \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                   \
+    do {                                                                             \
+        const auto& actual_ = (actual);                                              \
+        const auto& expected_ = (expected);                                          \
+        if (!(actual_ == expected_)) {                                               \
+            std::ostringstream message_;                                             \
+            message_ << #actual " == " #expected " (got \"" << actual_               \
+                     << "\", expected \"" << expected_ << "\")";                     \
+            TestHarness::fail(__FILE__, __LINE__, message_.str());                   \
+        }                                                                            \
+    } while (0)
+
+#endif // TESTHARNESS_H
@@ -0,0 +1,147 @@
+#include <string>
+#include <string_view>
+#include "TestHarness.h"
+#include "TextExtractor.h"
+#include "XmlFormatter.h"
+#include "XmlTokenizer.h"
+
+namespace {
+
+// Body text with something to get wrong at every kind of boundary:
+// entities, text:s counts, CDATA, comments, tables, notes and long runs
+const char* const kDocument =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+    "<office:document-content xmlns:office=\"urn:oasis:names:tc:opendocument:xmlns:office:1.0\">"
+    "<office:body><office:text>"
+    "<text:h text:outline-level=\"1\">Fish &amp; Chips &#x263A;</text:h>"
+    "<text:p>one<text:s text:c=\"3\"/>two<text:tab/>three<text:line-break/>four</text:p>"
+    "<!-- a comment with <markup> in it -->"
+    "<text:p>  spaced \t\n  out  <![CDATA[<kept> & raw]]> &lt;tag&gt; &#65;&#x42;&unknown;</text:p>"
+    "<table:table table:name=\"T\"><table:table-row>"
+    "<table:table-cell><text:p>a1</text:p></table:table-cell>"
+    "<table:table-cell><text:p>b1</text:p></table:table-cell>"
+    "</table:table-row></table:table>"
+    "<text:p>cited<text:note><text:note-citation>1</text:note-citation>"
+    "<text:note-body><text:p>note</text:p></text:note-body></text:note></text:p>"
+    "<text:p>The quick brown fox jumps over the lazy dog, again and again and again.</text:p>"
+    "</office:text></office:body></office:document-content>";
+
+std::string extract(std::string_view first, std::string_view second) {
+    std::string text;
+    TextExtractor extractor([&text](std::string_view block) { text.append(block.data(), block.size()); });
+    extractor.feed(first);
+    extractor.feed(second);
+    extractor.finish();
+    return text;
+}
+
+std::string format(std::string_view first, std::string_view second) {
+    XmlFormatter formatter;
+    formatter.feed(first);
+    formatter.feed(second);
+    formatter.finish();
+    return formatter.output();
+}
+
+} // namespace
+
+TEST(XmlTokenizer, tokens) {
+    XmlTokenizer tokenizer(R"(<?xml version="1.0"?><!-- c --><a x="1" y='&amp;'>t&lt;<![CDATA[<raw>]]><b/></a>)");
+    XmlTokenizer::Token token;
+    using Type = XmlTokenizer::TokenType;
+
+    struct Expected {
+        Type type;
+        const char* name;
+        const char* value;
+        bool selfClosing;
+    };
+    const Expected expected[] = {
+        { Type::ProcessingInstruction, "xml", "version=\"1.0\"", false },
+        { Type::Comment, "", " c ", false },
+        { Type::StartElement, "a", "", false },
+        { Type::Attribute, "x", "1", false },
+        { Type::Attribute, "y", "&amp;", false },
+        { Type::Text, "", "t&lt;", false },
+        { Type::CData, "", "<raw>", false },
+        { Type::StartElement, "b", "", true },
+        { Type::EndElement, "b", "", true },
+        { Type::EndElement, "a", "", false },
+    };
+
+    for (const Expected& e : expected) {
+        CHECK(tokenizer.next(token));
+        CHECK(token.type == e.type);
+        CHECK_EQ(token.name, std::string_view(e.name));
+        CHECK_EQ(token.value, std::string_view(e.value));
+        CHECK_EQ(token.selfClosing, e.selfClosing);
+    }
+    CHECK(!tokenizer.next(token));
+    CHECK(!tokenizer.hasError());
+    CHECK_EQ(tokenizer.depth(), size_t(0));
+}
+
+TEST(XmlTokenizer, decodeEntities) {
+    std::string out = "x";
+    XmlTokenizer::decodeEntities("a&amp;b&lt;&gt;&quot;&apos;&#65;&#x42;", out);
+    CHECK_EQ(out, std::string("xa&b<>\"'AB"));
+
+    // Unknown entities and invalid character references stay as written
+    out.clear();
+    XmlTokenizer::decodeEntities("&unknown; &#xD800; & alone", out);
+    CHECK_EQ(out, std::string("&unknown; &#xD800; & alone"));
+}
+
+TEST(TextExtractor, everyChunkBoundary) {
+    std::string_view document(kDocument);
+    std::string whole = extract(document, std::string_view());
+    CHECK_EQ(whole, std::string("Fish & Chips \xE2\x98\xBA\n"
+                                "one   two\tthree\nfour\n"
+                                "spaced out <kept> & raw <tag> AB&unknown;\n"
+                                "a1\tb1\n"
+                                "cited\nnote\n"
+                                "The quick brown fox jumps over the lazy dog, again and again and again.\n"));
+
+    for (size_t split = 0; split <= document.size(); ++split) {
+        std::string text = extract(document.substr(0, split), document.substr(split));
+        if (text != whole) {
+            CHECK_EQ(text, whole);
+            TestHarness::fail(__FILE__, __LINE__, "split at byte " + std::to_string(split));
+            break;
+        }
+    }
+}
+
+TEST(TextExtractor, byteByByte) {
+    std::string text;
+    TextExtractor extractor([&text](std::string_view block) { text.append(block.data(), block.size()); });
+    for (const char* p = kDocument; *p != '\0'; ++p) {
+        extractor.feed(std::string_view(p, 1));
+    }
+    extractor.finish();
+    CHECK_EQ(text, extract(kDocument, std::string_view()));
+    CHECK_EQ(extractor.bytesConsumed(), std::string_view(kDocument).size());
+}
+
+TEST(XmlFormatter, everyChunkBoundary) {
+    std::string_view document(kDocument);
+    std::string whole = format(document, std::string_view());
+    CHECK(whole.find("\n  <office:body>") != std::string::npos);
+
+    for (size_t split = 0; split <= document.size(); ++split) {
+        std::string formatted = format(document.substr(0, split), document.substr(split));
+        if (formatted != whole) {
+            CHECK_EQ(formatted, whole);
+            TestHarness::fail(__FILE__, __LINE__, "split at byte " + std::to_string(split));
+            break;
+        }
+    }
+}
+
+TEST(XmlFormatter, outputLimit) {
+    XmlFormatter formatter(100);
+    CHECK(!formatter.feed(kDocument));
+    CHECK(formatter.isTruncated());
+    CHECK(formatter.output().size() <= 100);
+    CHECK(formatter.bytesConsumed() < std::string_view(kDocument).size());
+}
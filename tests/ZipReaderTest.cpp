@@ -0,0 +1,180 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <zlib.h>
+#include "TestHarness.h"
+#include "ZipReader.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint64_t kHugeSize = 16ull << 40;    // 16 TiB
+
+/**
+ * @brief An archive entry whose headers may lie about its size
+ */
+struct TestEntry {
+    std::string name;
+    std::string data;
+    bool deflate = false;
+    uint64_t declaredSize = UINT64_MAX;     // UINT64_MAX = the real size
+    bool zip64 = false;                     // Size in a Zip64 extra field
+};
+
+void put16(std::string& out, uint16_t value) {
+    out += static_cast<char>(value & 0xFF);
+    out += static_cast<char>(value >> 8);
+}
+
+void put32(std::string& out, uint32_t value) {
+    put16(out, static_cast<uint16_t>(value & 0xFFFF));
+    put16(out, static_cast<uint16_t>(value >> 16));
+}
+
+void put64(std::string& out, uint64_t value) {
+    put32(out, static_cast<uint32_t>(value & 0xFFFFFFFF));
+    put32(out, static_cast<uint32_t>(value >> 32));
+}
+
+std::string deflateRaw(const std::string& data) {
+    z_stream stream{};
+    deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+
+/**
+ * @brief Write a ZIP archive with the given entries
+ */
+bool writeArchive(const std::string& path, const std::vector<TestEntry>& entries) {
+    std::string archive;
+    std::string central;
+
+    for (const TestEntry& entry : entries) {
+        std::string compressed = entry.deflate ? deflateRaw(entry.data) : entry.data;
+        uint32_t crc = static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef*>(entry.data.data()),
+                                                   static_cast<uInt>(entry.data.size())));
+        uint64_t size = entry.declaredSize == UINT64_MAX ? entry.data.size() : entry.declaredSize;
+
+        std::string extra;
+        if (entry.zip64) {
+            put16(extra, 0x0001);
+            put16(extra, 8);
+            put64(extra, size);
+        }
+        uint32_t size32 = entry.zip64 ? 0xFFFFFFFF : static_cast<uint32_t>(size);
+
+        // Fields shared by the local header and the central directory
+        std::string common;
+        put16(common, 0);                           // Flags
+        put16(common, entry.deflate ? 8 : 0);       // Method
+        put32(common, 0);                           // Time and date
+        put32(common, crc);
+        put32(common, static_cast<uint32_t>(compressed.size()));
+        put32(common, size32);
+        put16(common, static_cast<uint16_t>(entry.name.size()));
+        put16(common, static_cast<uint16_t>(extra.size()));
+
+        put32(central, 0x02014b50);
+        put16(central, 45);                         // Version made by
+        put16(central, 45);                         // Version needed
+        central += common;
+        put16(central, 0);                          // Comment length
+        put16(central, 0);                          // Disk number
+        put16(central, 0);                          // Internal attributes
+        put32(central, 0);                          // External attributes
+        put32(central, static_cast<uint32_t>(archive.size()));
+        central += entry.name + extra;
+
+        put32(archive, 0x04034b50);
+        put16(archive, 45);
+        archive += common + entry.name + extra + compressed;
+    }
+
+    uint32_t centralOffset = static_cast<uint32_t>(archive.size());
+    archive += central;
+    put32(archive, 0x06054b50);
+    put16(archive, 0);                              // Disk numbers
+    put16(archive, 0);
+    put16(archive, static_cast<uint16_t>(entries.size()));
+    put16(archive, static_cast<uint16_t>(entries.size()));
+    put32(archive, static_cast<uint32_t>(central.size()));
+    put32(archive, centralOffset);
+    put16(archive, 0);                              // Comment length
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(archive.data(), static_cast<std::streamsize>(archive.size()));
+    return static_cast<bool>(file);
+}
+
+std::string backendName(ZipReader::Backend backend) {
+    return backend == ZipReader::Backend::Mapped ? "mapped" : "minizip";
+}
+
+} // namespace
+
+TEST(ZipReader, forgedSizes) {
+    std::string content(100000, 'x');
+    for (size_t i = 0; i < content.size(); i += 37) {
+        content[i] = static_cast<char>('a' + i % 26);
+    }
+
+    std::vector<TestEntry> entries(7);
+    entries[0] = { "mimetype", "application/vnd.oasis.opendocument.text" };
+    entries[1] = { "content.xml", content, true };
+    entries[2] = { "zip64.xml", content, true, UINT64_MAX, true };          // Honest Zip64 size
+    entries[3] = { "stored-huge.xml", "<a/>", false, kHugeSize, true };
+    entries[4] = { "deflated-huge.xml", content, true, kHugeSize, true };
+    entries[5] = { "deflated-4g.xml", content, true, 0xF0000000 };
+    entries[6] = { "deflated-short.xml", content, true, content.size() * 2 };
+
+    std::string path = (fs::temp_directory_path() / "odf-tests-forged-sizes.zip").string();
+    CHECK(writeArchive(path, entries));
+
+    for (auto backend : { ZipReader::Backend::Minizip, ZipReader::Backend::Mapped }) {
+        ZipReader zip(path, backend);
+        if (!zip.open()) {
+            TestHarness::fail(__FILE__, __LINE__, backendName(backend) + ": " + zip.getLastError());
+            continue;
+        }
+
+        // Sizes are reported as declared, in 64 bits
+        CHECK_EQ(zip.entries().size(), entries.size());
+        CHECK_EQ(zip.getFileSize("stored-huge.xml"), kHugeSize);
+        CHECK_EQ(zip.getFileSize("deflated-huge.xml"), kHugeSize);
+
+        std::string out;
+        CHECK(zip.extractFileTo("mimetype", out));
+        CHECK_EQ(out, entries[0].data);
+        CHECK(zip.extractFileTo("content.xml", out));
+        CHECK(out == content);
+        CHECK(zip.extractFileTo("zip64.xml", out));
+        CHECK(out == content);
+
+        // Rejected before anything is allocated for them
+        for (const char* name : { "stored-huge.xml", "deflated-huge.xml", "deflated-4g.xml" }) {
+            if (zip.extractFileTo(name, out)) {
+                TestHarness::fail(__FILE__, __LINE__, backendName(backend) + ": extracted " + name);
+            }
+            CHECK(zip.getLastError().find("Declared size doesn't match") != std::string::npos);
+            CHECK(out.empty());
+        }
+
+        // Plausible, but the data runs out before the declared size
+        CHECK(!zip.extractFileTo("deflated-short.xml", out));
+        CHECK(out.empty());
+    }
+
+    std::error_code ec;
+    fs::remove(path, ec);
+}
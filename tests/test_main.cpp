@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "TestHarness.h"
+
+namespace {
+
+struct Test {
+    const char* suite;
+    const char* name;
+    TestHarness::TestFunction function;
+};
+
+// Function-local so that registration from other files' statics is safe
+std::vector<Test>& registry() {
+    static std::vector<Test> tests;
+    return tests;
+}
+
+size_t failures = 0;
+
+} // namespace
+
+namespace TestHarness {
+
+bool registerTest(const char* suite, const char* name, TestFunction function) {
+    registry().push_back({ suite, name, function });
+    return true;
+}
+
+void fail(const char* file, int line, const std::string& message) {
+    ++failures;
+    std::cout << "  " << file << ":" << line << ": " << message << "\n";
+}
+
+} // namespace TestHarness
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> suites(argv + 1, argv + argc);
+
+    size_t run = 0;
+    size_t failed = 0;
+    for (const Test& test : registry()) {
+        if (!suites.empty() && std::find(suites.begin(), suites.end(), test.suite) == suites.end()) {
+            continue;
+        }
+
+        size_t before = failures;
+        try {
+            test.function();
+        } catch (const std::exception& e) {
+            TestHarness::fail(__FILE__, __LINE__, std::string("Uncaught exception: ") + e.what());
+        }
+        ++run;
+        if (failures != before) {
+            ++failed;
+        }
+        std::cout << (failures == before ? "[  OK  ] " : "[ FAIL ] ") << test.suite << "." << test.name << "\n";
+    }
+
+    if (run == 0) {
+        std::cerr << "Error: No tests matched\n";
+        return 1;
+    }
+    std::cout << "\n" << run << " tests, " << failed << " failed\n";
+    return failed == 0 ? 0 : 1;
+}